@@ -356,6 +356,21 @@ public:
      */
     void compile(const Program &program);
 
+    /**
+     * Ensures that all passes have been constructed, and then runs the passes
+     * on each of the given programs, compiling up to num_threads programs
+     * concurrently. 0 means that the number of hardware threads is used. The
+     * result for each program is the same as for compile().
+     *
+     * All programs must use the same platform. The output prefixes of the
+     * passes (see their output_prefix option) must differ between the
+     * programs, because otherwise programs compiled concurrently would
+     * overwrite each other's output. This is the case when they include the
+     * uniquified program name (`%N`), or when the programs have distinct
+     * names and the prefixes include the program name (`%n`).
+     */
+    void compile_batch(const std::vector<Program> &programs, size_t num_threads = 0);
+
     /**
      * Ensures that all passes have been constructed, and then runs the passes
      * without specification of an input program. The first pass should then act
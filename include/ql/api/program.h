@@ -175,16 +175,22 @@ public:
     void compile();
 
     /**
-     * Prints the interaction matrix for each kernel in the program.
+     * Prints the interaction matrix for each kernel in the program. Only the
+     * nonzero entries are listed, with one line per instruction type and
+     * qubit pair containing the number of two-qubit gates of that type
+     * between those qubits. format must be "text" or "csv"; the latter adds a
+     * header line and separates the fields with commas.
      */
-    void print_interaction_matrix() const;
+    void print_interaction_matrix(const std::string &format = "text") const;
 
     /**
-     * Writes the interaction matrix for each kernel in the program to a file.
-     * This is one of the few functions that still uses the global output_dir
-     * option.
+     * Writes the interaction matrix for each kernel in the program to a file,
+     * in the same form as print_interaction_matrix(). The files are named
+     * <kernel>InteractionMatrix.dat for the text format and
+     * <kernel>InteractionMatrix.csv for CSV. This is one of the few functions
+     * that still uses the global output_dir option.
      */
-    void write_interaction_matrix() const;
+    void write_interaction_matrix(const std::string &format = "text") const;
 
 };
 
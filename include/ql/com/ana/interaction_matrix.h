@@ -6,69 +6,103 @@
 
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
-#include "ql/utils/vec.h"
-#include "ql/ir/compat/compat.h"
+#include "ql/utils/pair.h"
+#include "ql/utils/map.h"
+#include "ql/ir/ir.h"
+#include "ql/com/ana/metrics.h"
 
 namespace ql {
 namespace com {
 namespace ana {
 
-// TODO JvS: this is really just an "advanced" metric, and should be written
-//  as such sometime.
+/**
+ * A pair of qubit indices, lowest index first.
+ */
+using QubitPair = utils::Pair<utils::UInt, utils::UInt>;
 
 /**
- * Utility for counting the number of two-qubit gates, grouped by their qubit
- * operands.
+ * Sparse interaction matrix, containing the number of two-qubit gates applied
+ * to each pair of qubits, keyed by the name of the (generalized) instruction
+ * type. Operand order is not respected, i.e. the matrix is symmetric, and only
+ * nonzero entries are stored.
  */
-class InteractionMatrix {
-private:
+using InteractionCounts = utils::Map<utils::Str, utils::Map<QubitPair, utils::UInt>>;
 
-    /**
-     * Shorthand for the matrix type.
-     */
-    using Matrix = utils::Vec<utils::Vec<utils::UInt>>;
+/**
+ * Metric that counts the number of two-qubit gates, grouped by instruction
+ * type and their qubit operands. Any instruction with exactly two qubit
+ * operands is counted. Memory usage is proportional to the number of distinct
+ * qubit pairs that actually interact, so this also works for platforms with
+ * many qubits.
+ */
+class InteractionMatrix : public SimpleClassMetric<InteractionCounts> {
+public:
 
     /**
-     * Size of the matrix, i.e. the number of qubits.
+     * Output formats supported by write().
      */
-    const utils::UInt size;
+    enum class Format {
 
-    /**
-     * Square matrix of unsigned integers, representing the number of two-qubit
-     * gates spanning the indexed qubits. Operand order is not respected; the
-     * matrix is symmetric.
-     */
-    Matrix matrix;
+        /**
+         * Human-readable format, with one line per nonzero entry containing
+         * the instruction name, the two qubits, and the count.
+         */
+        TEXT,
 
-public:
+        /**
+         * Comma-separated values with a header line, with one row per nonzero
+         * entry containing the instruction name, the two qubit indices, and
+         * the count.
+         */
+        CSV
+
+    };
 
     /**
-     * Computes the interaction matrix for the given kernel.
+     * Updates the interaction counts for the given instruction.
      */
-    InteractionMatrix(const ir::compat::KernelRef &kernel);
+    void process_instruction(
+        const ir::Ref &ir,
+        const ir::InstructionRef &instruction
+    ) override;
 
     /**
-     * Returns the embedded matrix.
+     * Returns the total number of two-qubit gates for each pair of qubits,
+     * regardless of instruction type.
      */
-    const Matrix &get_matrix() const;
+    static utils::Map<QubitPair, utils::UInt> get_totals(const InteractionCounts &counts);
 
     /**
-     * Returns the matrix as a string.
+     * Streams the nonzero entries of the given interaction matrix to the given
+     * output stream in the given format.
      */
-    utils::Str get_string() const;
+    static void write(
+        const InteractionCounts &counts,
+        std::ostream &os,
+        Format format = Format::TEXT
+    );
 
     /**
-     * Constructs interaction matrices for each kernel in the program, and
+     * Constructs interaction matrices for each block in the program, and
      * reports the results to the given output stream.
      */
-    static void dump_for_program(const ir::compat::ProgramRef &program, std::ostream &os=std::cout);
+    static void dump_for_program(
+        const ir::Ref &ir,
+        std::ostream &os = std::cout,
+        Format format = Format::TEXT
+    );
 
     /**
      * Same as dump_for_program(), but writes the result to files in the
      * current globally-configured output directory, using the names
-     * "<prefix><kernel>InteractionMatrix.dat".
+     * "<prefix><block>InteractionMatrix.dat" for the text format, or
+     * "<prefix><block>InteractionMatrix.csv" for CSV.
      */
-    static void write_for_program(const utils::Str &output_prefix, const ir::compat::ProgramRef &program);
+    static void write_for_program(
+        const utils::Str &output_prefix,
+        const ir::Ref &ir,
+        Format format = Format::TEXT
+    );
 
 };
 
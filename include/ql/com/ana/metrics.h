@@ -8,6 +8,7 @@
 #pragma once
 
 #include "ql/utils/num.h"
+#include "ql/utils/vec.h"
 #include "ql/utils/map.h"
 #include "ql/utils/exception.h"
 #include "ql/ir/ir.h"
@@ -266,6 +267,129 @@ public:
     ) override;
 };
 
+/**
+ * The values computed by the BasicMetrics metric. Values for metrics that were
+ * not selected are left at their initial value.
+ */
+struct BasicMetricValues {
+
+    /**
+     * Result of the Latency metric.
+     */
+    utils::UInt latency = 0;
+
+    /**
+     * Result of the QuantumGateCount metric.
+     */
+    utils::UInt quantum_gate_count = 0;
+
+    /**
+     * Result of the MultiQubitGateCount metric.
+     */
+    utils::UInt multi_qubit_gate_count = 0;
+
+    /**
+     * Result of the ClassicalOperationCount metric.
+     */
+    utils::UInt classical_operation_count = 0;
+
+    /**
+     * Result of the QubitUsageCount metric.
+     */
+    utils::SparseMap<utils::UInt, utils::UInt, 0> qubit_usage_count;
+
+    /**
+     * Result of the QubitUsedCycleCount metric.
+     */
+    utils::SparseMap<utils::UInt, utils::UInt, 0> qubit_used_cycle_count;
+
+    /**
+     * Merges the values computed for a subsequent top-level block into these
+     * values. Merging the values of all blocks of a program in program order
+     * yields the same result as computing the metrics for the whole program.
+     */
+    void merge(const BasicMetricValues &other);
+
+};
+
+/**
+ * A metric that computes any combination of the Latency, QuantumGateCount,
+ * MultiQubitGateCount, ClassicalOperationCount, QubitUsageCount, and
+ * QubitUsedCycleCount metrics in a single traversal of the IR, rather than in
+ * one traversal per metric. The results are identical to those of the
+ * individual metrics.
+ */
+class BasicMetrics : public Metric<BasicMetricValues> {
+public:
+
+    /**
+     * Flags for selecting which metrics are to be computed.
+     */
+    enum Selection : utils::UInt {
+        LATENCY = 1,
+        QUANTUM_GATE_COUNT = 2,
+        MULTI_QUBIT_GATE_COUNT = 4,
+        CLASSICAL_OPERATION_COUNT = 8,
+        QUBIT_USAGE_COUNT = 16,
+        QUBIT_USED_CYCLE_COUNT = 32,
+        ALL = 63
+    };
+
+private:
+
+    /**
+     * Bitwise or of the selected metrics.
+     */
+    utils::UInt selection;
+
+    /**
+     * Block nesting depth of the traversal. The latency is only computed for
+     * top-level blocks.
+     */
+    utils::UInt depth = 0;
+
+    /**
+     * The metrics as computed thus far.
+     */
+    BasicMetricValues value;
+
+public:
+
+    /**
+     * Constructs the metric, computing the given selection of metrics.
+     */
+    explicit BasicMetrics(utils::UInt selection = ALL);
+
+    void process_instruction(
+        const ir::Ref &ir,
+        const ir::InstructionRef &instruction
+    ) override;
+
+    void process_block(
+        const ir::Ref &ir,
+        const ir::BlockBaseRef &block
+    ) override;
+
+    /**
+     * Returns the results gathered thus far.
+     */
+    BasicMetricValues get_result() override;
+
+};
+
+/**
+ * Computes the BasicMetrics metric with the given selection independently for
+ * each top-level block of the program, returning the values in program order.
+ * Up to num_threads blocks are processed concurrently; 0 means one thread per
+ * hardware thread. The program-wide values can be obtained by merging the
+ * returned values in order.
+ */
+utils::Vec<BasicMetricValues> compute_basic_metrics_per_block(
+    const ir::Ref &ir,
+    utils::UInt selection = BasicMetrics::ALL,
+    utils::UInt num_threads = 1
+);
+
 } // namespace ana
 } // namespace com
 } // namespace ql
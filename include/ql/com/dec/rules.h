@@ -25,14 +25,29 @@ using RulePredicate = std::function<utils::Bool(const ir::DecompositionRef&)>;
  * the original statement. If ignore_schedule is not set, the schedule is copied
  * from the decomposition rule, possibly resulting in instructions being
  * reordered.
+ *
+ * Temporary objects needed by the expansions are normally added to the program
+ * directly. When temporaries is non-null, they are instead added to the given
+ * list, and it is up to the caller to move them into the program afterwards.
+ * Together with prepare_decomposition_rules(), this allows different blocks to
+ * be processed concurrently.
  */
 utils::UInt apply_decomposition_rules(
     const ir::Ref &ir,
     const ir::BlockBaseRef &block,
     utils::Bool ignore_schedule = true,
-    const RulePredicate &predicate = [](const ir::DecompositionRef&){ return true; }
+    const RulePredicate &predicate = [](const ir::DecompositionRef&){ return true; },
+    utils::Any<ir::VirtualObject> *temporaries = nullptr
 );
 
+/**
+ * Precompiles all decomposition rules in the platform. This is otherwise done
+ * lazily by apply_decomposition_rules() the first time a rule is applied,
+ * which is not thread-safe. Therefore, this must be called before
+ * apply_decomposition_rules() is called for different blocks concurrently.
+ */
+void prepare_decomposition_rules(const ir::Ref &ir);
+
 } // namespace dec
 } // namespace com
 } // namespace ql
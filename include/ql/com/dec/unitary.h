@@ -71,6 +71,12 @@ public:
      */
     static utils::Bool is_decompose_support_enabled();
 
+    /**
+     * Removes all finished decompositions from the process-wide decomposition
+     * cache, releasing the memory they use.
+     */
+    static void clear_decomposition_cache();
+
     /**
      * Returns the decomposed circuit.
      */
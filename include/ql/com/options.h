@@ -22,8 +22,58 @@ utils::Options make_ql_options();
 QL_GLOBAL extern utils::Options global;
 
 /**
- * Convenience function for getting an option value as a string from the global
- * options record.
+ * Returns the options record that applies to the calling thread. This is the
+ * record made current by the innermost Scope on this thread (or on the thread
+ * that spawned it through utils::parallel_for()), or global if there is none.
+ * Code that reads global options while compiling should use this rather than
+ * global, such that multiple programs can be compiled concurrently with
+ * different options.
+ */
+const utils::Options &current();
+
+/**
+ * RAII object that makes the given options record current for the calling
+ * thread (see current()) while in scope, including the log level it
+ * specifies. This allows a thread to compile a program with its own options
+ * and log level without touching the process-wide state. The record must be
+ * constructed using make_ql_options() and must outlive the scope. Scopes may
+ * be nested.
+ */
+class Scope {
+private:
+
+    /**
+     * The options record that was current before this scope, if any.
+     */
+    const utils::Options *previous_options;
+
+    /**
+     * The thread-local log level override before this scope, if any.
+     */
+    utils::Int previous_log_level;
+
+public:
+
+    /**
+     * Makes the given options record current for the calling thread while in
+     * scope, including the log level it specifies.
+     */
+    explicit Scope(const utils::Options &options);
+
+    /**
+     * Restores the options record and log level that were current before
+     * this scope was constructed.
+     */
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+};
+
+/**
+ * Convenience function for getting an option value as a string from the
+ * options record that applies to the calling thread, see current().
  */
 const utils::Str &get(const utils::Str &key);
 
@@ -141,6 +141,17 @@ public: // FIXME: should be private
      */
     utils::Vec<utils::UInt> cond_operands;
 
+    /**
+     * The values of the use_default_gates and decompose_toffoli global
+     * options in the options record that was current (see
+     * com::options::current()) when the kernel was constructed. Gate
+     * insertion uses these rather than the options current at the time of
+     * the call. They are copied because the record may be local to a
+     * com::options::Scope that ends before the kernel does.
+     */
+    utils::Bool use_default_gates;
+    utils::Str decompose_toffoli;
+
 public:
 
     Kernel(
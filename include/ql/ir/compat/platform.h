@@ -205,6 +205,12 @@ public:
         const utils::Str &compiler_config = ""
     );
 
+    /**
+     * Returns a copy of this platform, including copies of the gates in the
+     * instruction map, that can be used independently of the original.
+     */
+    PlatformRef copy() const;
+
     /**
      * Dumps some basic info about the platform to the given stream.
      */
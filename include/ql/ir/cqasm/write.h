@@ -101,8 +101,26 @@ struct WriteOptions {
      */
     utils::Bool include_timing = true;
 
+    /**
+     * The number of threads used to format the blocks of the program. When
+     * this is not 1, windows of consecutive blocks are formatted concurrently
+     * into separate buffers, which are then written to the output stream in
+     * program order, so memory usage remains bounded by the size of a window
+     * rather than the size of the program. 0 means one thread per hardware
+     * thread. Note that in this mode all block names are uniquified before any
+     * block is written, so (only) in the presence of name conflicts the
+     * generated names may differ from the single-threaded output.
+     */
+    utils::UInt num_threads = 1;
+
 };
 
+/**
+ * Buffer size used by write_file(). Large enough to make the number of write
+ * syscalls negligible, small enough to not matter for peak memory usage.
+ */
+const utils::UInt WRITE_BUFFER_SIZE = 4 * 1024 * 1024;
+
 /**
  * Writes a cQASM representation of the IR to the given stream with the given
  * line prefix.
@@ -126,6 +144,17 @@ void write(
     const utils::Str &line_prefix = ""
 );
 
+/**
+ * Writes a cQASM representation of the IR to the given file, using a large
+ * write buffer. The file is written incrementally, so memory usage does not
+ * depend on the size of the generated file.
+ */
+void write_file(
+    const Ref &ir,
+    const utils::Str &fname,
+    const WriteOptions &options = {}
+);
+
 /**
  * Shorthand for getting a cQASM string representation of the given node.
  */
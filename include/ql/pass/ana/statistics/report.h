@@ -37,12 +37,14 @@ void dump(
 
 /**
  * Dumps statistics for the given program and its top-level blocks to the given
- * output stream.
+ * output stream. The statistics of up to num_threads blocks are computed
+ * concurrently, where 0 means one thread per hardware thread.
  */
 void dump_all(
     const ir::Ref &ir,
     std::ostream &os = std::cout,
-    const utils::Str &line_prefix = ""
+    const utils::Str &line_prefix = "",
+    utils::UInt num_threads = 1
 );
 
 /**
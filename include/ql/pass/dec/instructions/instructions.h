@@ -47,13 +47,16 @@ public:
 private:
 
     /**
-     * Runs the instruction decomposer on the given block.
+     * Runs the instruction decomposer on the given block. If temporaries is
+     * non-null, temporary objects are added to it rather than to the program;
+     * see com::dec::apply_decomposition_rules().
      */
     static utils::UInt run_on_block(
         const ir::Ref &ir,
         const ir::BlockBaseRef &block,
         utils::Bool ignore_schedule,
-        const com::dec::RulePredicate &predicate
+        const com::dec::RulePredicate &predicate,
+        utils::Any<ir::VirtualObject> *temporaries
     );
 
 public:
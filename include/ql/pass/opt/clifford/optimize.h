@@ -12,20 +12,10 @@ namespace opt {
 namespace clifford {
 namespace optimize {
 
-/**
- * Clifford sequence optimizer.
- * FIXME JvS: remove; only used by old pass manager
- */
-void clifford_optimize(
-    const ir::compat::ProgramRef &programp,
-    const ir::compat::PlatformRef &platform,
-    const utils::Str &passname
-);
-
 /**
  * Clifford optimizer pass.
  */
-class CliffordOptimizePass : public pmgr::pass_types::KernelTransformation {
+class CliffordOptimizePass : public pmgr::pass_types::Transformation {
     static bool is_pass_registered;
 
 protected:
@@ -58,8 +48,7 @@ public:
      * Runs the Clifford optimizer.
      */
     utils::Int run(
-        const ir::compat::ProgramRef &program,
-        const ir::compat::KernelRef &kernel,
+        const ir::Ref &ir,
         const pmgr::pass_types::Context &context
     ) const override;
 
@@ -305,12 +305,44 @@ public:
      */
     void construct();
 
+    /**
+     * Returns a copy of this pass manager, using the same pass factory and a
+     * copy of the pass tree (see pass_types::Base::clone()). Since a manager
+     * can only be used by one thread at a time, this allows a single
+     * compilation strategy to be applied to multiple programs concurrently.
+     */
+    Manager clone() const;
+
+    /**
+     * Ensures that all passes have been constructed, and then returns the
+     * prefixes of all output files that compiling a program with the given
+     * name and unique name may write, i.e. the output_prefix options of all
+     * passes after substitution, and the prefix used for the profiling
+     * results. The names must be empty for a program without kernels.
+     */
+    utils::Set<utils::Str> get_output_prefixes(
+        const utils::Str &program_name,
+        const utils::Str &program_unique_name
+    );
+
     /**
      * Ensures that all passes have been constructed, and then runs the passes
      * on the given program.
      */
     void compile(const ir::Ref &ir);
 
+    /**
+     * Same as compile(const ir::Ref&), but uses the given options record
+     * instead of the global options for the duration of the compilation, on
+     * all threads involved in it. This includes the log level. The record must
+     * be constructed using com::options::make_ql_options(). This allows
+     * multiple programs to be compiled concurrently with different options;
+     * note however that the passes of a single manager are not constructed
+     * with these options, and that a manager can only be used by one thread
+     * at a time. Use clone() to get a manager for each thread.
+     */
+    void compile(const ir::Ref &ir, const utils::Options &options);
+
 };
 
 /**
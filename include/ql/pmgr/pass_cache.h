@@ -0,0 +1,239 @@
+/** \file
+ * Cache for the per-block results of deterministic transformation passes.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include "ql/utils/num.h"
+#include "ql/utils/str.h"
+#include "ql/utils/list.h"
+#include "ql/utils/map.h"
+#include "ql/utils/ptr.h"
+#include "ql/utils/options.h"
+#include "ql/ir/ir.h"
+
+namespace ql {
+namespace pmgr {
+
+/**
+ * Process-wide, in-memory cache for the results of deterministic transformation
+ * passes that operate on each block of the program independently. Results are
+ * keyed on the cQASM representation of the input block (which captures its
+ * structure, including scheduling and metadata), the pass type name, the
+ * complete pass options, the platform, and the data types and objects declared
+ * by the platform and the program. A hit can therefore only occur when
+ * running the pass again would produce the same result.
+ *
+ * The part of the key that does not depend on the block (see
+ * make_key_prefix()) can be large, since it includes the platform. It is
+ * therefore interned: the cache stores each distinct prefix once, and the
+ * keys of the entries only refer to it by a numeric ID.
+ *
+ * Cached blocks refer to the platform and program they were computed for.
+ * When a cached result is restored into a different program, these references
+ * are rebound to the equivalent instruction types, function types, data types,
+ * and objects of that program, identified by name and prototype. If any of
+ * them cannot be found, or if the block contains goto instructions (which
+ * refer to other blocks), the lookup is treated as a miss.
+ *
+ * The cache is thread-safe, and evicts the oldest entries first when it is
+ * full.
+ */
+class PassCache {
+private:
+
+    /**
+     * A cached pass result.
+     */
+    struct Entry {
+
+        /**
+         * Clone of the block after the pass was applied.
+         */
+        ir::BlockRef block;
+
+        /**
+         * The return value of the pass for this block.
+         */
+        utils::Int retval;
+
+        /**
+         * The ID of the interned key prefix the entry was stored with.
+         */
+        utils::UInt prefix_id;
+
+        /**
+         * The platform and the virtual objects of the program the result was
+         * computed for. These are kept alive such that the links in the cached
+         * block can still be resolved.
+         */
+        ir::PlatformRef platform;
+        utils::Any<ir::VirtualObject> objects;
+
+    };
+
+    /**
+     * An interned key prefix.
+     */
+    struct Prefix {
+
+        /**
+         * The text of the prefix, pointing into the key of its entry in
+         * prefix_ids.
+         */
+        const utils::Str *text;
+
+        /**
+         * The number of cache entries and running passes using the prefix.
+         * The prefix is forgotten when this drops to zero.
+         */
+        utils::UInt uses;
+
+    };
+
+    /**
+     * Mutex protecting all of the below.
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * The IDs of the interned key prefixes, by their text.
+     */
+    std::unordered_map<utils::Str, utils::UInt> prefix_ids;
+
+    /**
+     * The interned key prefixes, by their ID.
+     */
+    utils::Map<utils::UInt, Prefix> prefixes;
+
+    /**
+     * The ID for the next new prefix. IDs are never reused, such that a key
+     * built with a forgotten prefix can't match an entry for a different one.
+     */
+    utils::UInt next_prefix_id = 0;
+
+    /**
+     * The cached results.
+     */
+    utils::Map<utils::Str, utils::Ptr<Entry>> entries;
+
+    /**
+     * The keys of the cached results in order of insertion, for eviction.
+     */
+    utils::List<utils::Str> order;
+
+    /**
+     * Number of hits and misses since construction or the last clear().
+     */
+    utils::UInt hits = 0;
+    utils::UInt misses = 0;
+
+    /**
+     * Decrements the use count of the given prefix, and forgets about it when
+     * it is no longer used. The mutex must be held.
+     */
+    void release_prefix_locked(utils::UInt prefix_id);
+
+public:
+
+    /**
+     * Returns the process-wide pass cache.
+     */
+    static PassCache &get();
+
+    /**
+     * Returns the part of the cache key that is shared by all blocks processed
+     * by a single run of a pass, based on the pass type name, the pass
+     * options, the platform, and the data type and object declarations of the
+     * program.
+     */
+    static utils::Str make_key_prefix(
+        const ir::Ref &ir,
+        const utils::Str &type_name,
+        const utils::Options &options
+    );
+
+    /**
+     * Interns the given key prefix, as returned by make_key_prefix(), and
+     * returns its ID. Every call must be paired with a call to
+     * release_prefix() when the ID is no longer needed to build keys.
+     */
+    utils::UInt acquire_prefix(const utils::Str &prefix);
+
+    /**
+     * Releases a prefix ID returned by acquire_prefix().
+     */
+    void release_prefix(utils::UInt prefix_id);
+
+    /**
+     * Returns the cache key for the given block, using the ID of its key
+     * prefix as returned by acquire_prefix().
+     */
+    static utils::Str make_key(
+        const ir::Ref &ir,
+        utils::UInt prefix_id,
+        const ir::BlockRef &block
+    );
+
+    /**
+     * Looks up the cached result for the given key. If there is one and it
+     * can be rebound to the given IR, the statements and annotations of the
+     * given block are replaced with those of the cached result, retval is set
+     * to the cached return value, and true is returned. Otherwise, the block
+     * is left unchanged and false is returned.
+     */
+    utils::Bool restore(
+        const ir::Ref &ir,
+        const utils::Str &key,
+        const ir::BlockRef &block,
+        utils::Int &retval
+    );
+
+    /**
+     * Stores the result of a pass for the given key, built with the given
+     * prefix ID, evicting the oldest entries if this would make the cache
+     * exceed the given number of entries. Blocks that cannot be restored later
+     * are not stored.
+     */
+    void store(
+        const ir::Ref &ir,
+        utils::UInt prefix_id,
+        const utils::Str &key,
+        const ir::BlockRef &block,
+        utils::Int retval,
+        utils::UInt max_entries
+    );
+
+    /**
+     * Removes all entries from the cache and resets the statistics. Prefixes
+     * that are still acquired remain valid.
+     */
+    void clear();
+
+    /**
+     * Returns the number of entries in the cache.
+     */
+    utils::UInt size() const;
+
+    /**
+     * Returns the number of distinct key prefixes the cache currently holds.
+     */
+    utils::UInt get_num_prefixes() const;
+
+    /**
+     * Returns the number of cache hits since construction or the last clear().
+     */
+    utils::UInt get_hits() const;
+
+    /**
+     * Returns the number of cache misses since construction or the last
+     * clear().
+     */
+    utils::UInt get_misses() const;
+
+};
+
+} // namespace pmgr
+} // namespace ql
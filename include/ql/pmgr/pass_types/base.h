@@ -14,6 +14,7 @@
 #include "ql/ir/ir.h"
 #include "ql/pmgr/declarations.h"
 #include "ql/pmgr/condition.h"
+#include "ql/pmgr/profiler.h"
 
 namespace ql {
 namespace pmgr {
@@ -41,6 +42,12 @@ struct Context {
      */
     const utils::Options &options;
 
+    /**
+     * The profiler that the pass manager records resource usage with, or an
+     * empty reference if profiling is disabled.
+     */
+    ProfilerRef profiler;
+
 };
 
 // Forward declaration for the base type.
@@ -571,6 +578,13 @@ public:
      */
     condition::Ref get_condition();
 
+    /**
+     * Returns a copy of this pass and, recursively, its sub-passes, with the
+     * same options and in the same state of construction. The copy can be
+     * used independently of the original, for instance by another thread.
+     */
+    Ref clone() const;
+
 private:
 
     /**
@@ -604,11 +618,38 @@ private:
 public:
 
     /**
-     * Executes this pass or pass group on the given program.
+     * Returns the prefix for the output products of this pass, obtained by
+     * applying the substitution rules of the output_prefix option for the given
+     * fully-qualified pass name and program. The program names must be empty
+     * if there is no program.
+     */
+    utils::Str get_output_prefix(
+        const utils::Str &full_pass_name,
+        const utils::Str &program_name,
+        const utils::Str &program_unique_name
+    ) const;
+
+    /**
+     * Adds the output prefixes of this pass and, recursively, its sub-passes
+     * to prefixes, as they would be when compiling a program with the given
+     * names. See get_output_prefix().
+     */
+    void get_output_prefixes(
+        utils::Set<utils::Str> &prefixes,
+        const utils::Str &program_name,
+        const utils::Str &program_unique_name,
+        const utils::Str &pass_name_prefix = ""
+    ) const;
+
+    /**
+     * Executes this pass or pass group on the given program. If a profiler is
+     * specified, the resource usage of this pass and its sub-passes is
+     * recorded with it. The record is also ended when the pass throws.
      */
     void compile(
         const ir::Ref &ir,
-        const utils::Str &pass_name_prefix = ""
+        const utils::Str &pass_name_prefix = "",
+        const ProfilerRef &profiler = {}
     );
 
 };
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <functional>
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
 #include "ql/utils/ptr.h"
@@ -129,6 +130,23 @@ protected:
         const Context &context
     ) const = 0;
 
+    /**
+     * Helper for passes that transform each block of the program
+     * independently and deterministically, i.e. for which the result for a
+     * block only depends on the contents of that block, the platform, and the
+     * pass options. Calls fn for each block of the program, and returns the
+     * sum of the return values. When the pass_cache global option is set and
+     * cacheable is true, blocks for which a result is cached (see PassCache)
+     * are skipped, and the results of fn are added to the cache. cacheable
+     * should be set to false for configurations in which fn has side effects
+     * other than modifying the block, such as writing output files.
+     */
+    utils::Int run_on_blocks(
+        const ir::Ref &ir,
+        const std::function<utils::Int(const ir::BlockRef &block)> &fn,
+        utils::Bool cacheable = true
+    ) const;
+
 };
 
 /**
@@ -188,6 +206,16 @@ protected:
         const utils::Str &type_name
     );
 
+    /**
+     * Declares that this pass is kernel-independent, i.e. that run() only
+     * modifies the given kernel and only reads the program and platform, such
+     * that multiple kernels can safely be processed concurrently. This adds
+     * the `parallel_kernels` option to the pass, with which the user can
+     * select the number of threads. Must be called from the constructor of
+     * the derived pass.
+     */
+    void enable_parallel_kernels();
+
     /**
      * Implementation for on_compile() that calls run() appropriately.
      */
@@ -0,0 +1,213 @@
+/** \file
+ * Profiler for recording the resource usage of passes.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include "ql/utils/num.h"
+#include "ql/utils/str.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/ptr.h"
+#include "ql/ir/ir.h"
+
+namespace ql {
+namespace pmgr {
+
+/**
+ * Resource usage recorded for a single execution of a pass (or pass group).
+ * When a pass is executed more than once, for instance within a loop group,
+ * each execution gets its own record.
+ */
+struct PassProfile {
+
+    /**
+     * The fully-qualified pass name, using periods for hierarchy separation.
+     */
+    utils::Str full_pass_name;
+
+    /**
+     * The pass type name, or an empty string for generic pass groups.
+     */
+    utils::Str type_name;
+
+    /**
+     * Nesting depth in the pass tree, starting at 0 for the root group.
+     */
+    utils::UInt depth;
+
+    /**
+     * Wall-clock time in seconds at which the pass started, relative to the
+     * construction of the profiler.
+     */
+    utils::Real start_time;
+
+    /**
+     * Wall-clock time in seconds taken by the pass, including its sub-passes.
+     */
+    utils::Real wall_time;
+
+    /**
+     * Process CPU time in seconds taken by the pass, including its sub-passes.
+     * This is summed over all threads, so it may exceed the wall-clock time
+     * for passes that use multiple threads.
+     */
+    utils::Real cpu_time;
+
+    /**
+     * Time in seconds spent converting between the new and the legacy IR for
+     * the pass itself (but not its sub-passes). Only nonzero for legacy passes.
+     */
+    utils::Real conversion_time;
+
+    /**
+     * Resident set size of the process in bytes before and after the pass.
+     */
+    utils::UInt rss_before;
+    utils::UInt rss_after;
+
+    /**
+     * Peak resident set size of the process in bytes before and after the
+     * pass. If these differ, the process reached a new high-water mark during
+     * this pass.
+     */
+    utils::UInt peak_rss_before;
+    utils::UInt peak_rss_after;
+
+    /**
+     * Number of statements in the program before and after the pass,
+     * including those in structured control-flow sub-blocks.
+     */
+    utils::UInt statements_before;
+    utils::UInt statements_after;
+
+    /**
+     * Number of program nodes (blocks, statements, and expressions) before
+     * and after the pass.
+     */
+    utils::UInt nodes_before;
+    utils::UInt nodes_after;
+
+};
+
+/**
+ * Records the resource usage of passes as they are executed by the pass
+ * manager, for finding the bottlenecks of a compilation strategy. The results
+ * can be written as a JSON report and as a trace-event file that can be loaded
+ * into Chrome's about:tracing or Perfetto.
+ *
+ * Memory usage is only available where the host platform supports querying
+ * it; on other platforms it is reported as zero.
+ */
+class Profiler {
+private:
+
+    /**
+     * Wall-clock time at which the profiler was constructed.
+     */
+    std::chrono::steady_clock::time_point wall_epoch;
+
+    /**
+     * Process CPU time at which the profiler was constructed.
+     */
+    std::clock_t cpu_epoch;
+
+    /**
+     * The records for all pass executions, in the order in which they were
+     * started.
+     */
+    utils::Vec<PassProfile> profiles;
+
+    /**
+     * Stack of indices into profiles for the passes that are currently
+     * running.
+     */
+    utils::Vec<utils::UInt> running;
+
+    /**
+     * A legacy IR conversion, as recorded by record_conversion().
+     */
+    struct Conversion {
+        utils::Str name;
+        utils::Real start_time;
+        utils::Real duration;
+    };
+
+    /**
+     * All recorded IR conversions.
+     */
+    utils::Vec<Conversion> conversions;
+
+    /**
+     * Returns the process CPU time in seconds since the profiler was
+     * constructed.
+     */
+    utils::Real cpu_now() const;
+
+public:
+
+    /**
+     * Constructs a new profiler, with no records.
+     */
+    Profiler();
+
+    /**
+     * Returns the wall-clock time in seconds since the profiler was
+     * constructed.
+     */
+    utils::Real now() const;
+
+    /**
+     * Records the start of a pass, and returns a handle for pass_end().
+     */
+    utils::UInt pass_start(
+        const ir::Ref &ir,
+        const utils::Str &full_pass_name,
+        const utils::Str &type_name
+    );
+
+    /**
+     * Records the end of the pass started with the given handle. Passes must
+     * end in the reverse order in which they were started.
+     */
+    void pass_end(
+        utils::UInt handle,
+        const ir::Ref &ir
+    );
+
+    /**
+     * Records a conversion between the new and the legacy IR that started at
+     * the given time (as returned by now()) and ends now, attributing it to
+     * the innermost running pass.
+     */
+    void record_conversion(
+        const utils::Str &name,
+        utils::Real start_time
+    );
+
+    /**
+     * Returns the records for all passes executed so far.
+     */
+    const utils::Vec<PassProfile> &get_profiles() const;
+
+    /**
+     * Writes the recorded data as a JSON report to the given file.
+     */
+    void write_report(const utils::Str &filename) const;
+
+    /**
+     * Writes the recorded data as a trace-event JSON file, as understood by
+     * Chrome's about:tracing and Perfetto, to the given file.
+     */
+    void write_trace(const utils::Str &filename) const;
+
+};
+
+/**
+ * Optional reference to a profiler.
+ */
+using ProfilerRef = utils::Ptr<Profiler>;
+
+} // namespace pmgr
+} // namespace ql
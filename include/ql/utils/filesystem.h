@@ -5,6 +5,8 @@
 #pragma once
 
 #include <fstream>
+#include <memory>
+#include "ql/utils/num.h"
 #include "ql/utils/str.h"
 #include "ql/utils/exception.h"
 #include "ql/utils/compat.h"
@@ -102,14 +104,17 @@ void make_dirs(const Str &path);
  * will do it. But this automatic closing may throw an exception; if this
  * happens while another exception is being handled, abort() will be called.
  * Relative paths are treated as relative to the current OpenQL working
- * directory.
+ * directory. When buffer_size is nonzero, a write buffer of that many bytes
+ * is used instead of the (usually rather small) default buffer of the
+ * standard library, which speeds up writing large files considerably.
  */
 class OutFile {
 private:
+    std::unique_ptr<char[]> buffer;
     std::ofstream ofs;
     Str path;
 public:
-    explicit OutFile(const Str &path);
+    explicit OutFile(const Str &path, UInt buffer_size = 0);
     void write(const Str &content);
     void close();
     void check();
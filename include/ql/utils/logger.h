@@ -5,8 +5,10 @@
 #pragma once
 
 #include <iostream>
+#include "ql/config.h"
 #include "ql/utils/exception.h"
 #include "ql/utils/compat.h"
+#include "ql/utils/num.h"
 #include "ql/utils/str.h"
 
 // helper macro: stringstream to string
@@ -18,37 +20,53 @@
         std::cout << "[OPENQL] " << x << std::endl;                                                         \
     } while (false)
 
+// Whether messages of the given level are currently logged on the calling
+// thread. Always false for levels that are less severe than QL_MIN_LOG_LEVEL,
+// such that the compiler can remove the corresponding logging code entirely.
+#define QL_LOG_ENABLED(level) \
+    (QL_MIN_LOG_LEVEL >= (level) && ::ql::utils::logger::get_log_level() >= (level))
+
 #define QL_EOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_ERROR) {                   \
-            ::std::cerr << "[OPENQL] " __FILE__ ":" << __LINE__ << " Error: " << content << ::std::endl;    \
+        if (QL_LOG_ENABLED(::ql::utils::logger::LogLevel::LOG_ERROR)) {                                     \
+            ::ql::utils::StrStrm ql_log_ss{};                                                               \
+            ql_log_ss << "[OPENQL] " __FILE__ ":" << __LINE__ << " Error: " << content;                     \
+            ::ql::utils::logger::write(::ql::utils::logger::LogLevel::LOG_ERROR, ql_log_ss.str());          \
         }                                                                                                   \
     } while (false)
 
 #define QL_WOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_WARNING) {                 \
-            ::std::cerr << "[OPENQL] " __FILE__ ":" << __LINE__ << " Warning: " << content << ::std::endl;  \
+        if (QL_LOG_ENABLED(::ql::utils::logger::LogLevel::LOG_WARNING)) {                                   \
+            ::ql::utils::StrStrm ql_log_ss{};                                                               \
+            ql_log_ss << "[OPENQL] " __FILE__ ":" << __LINE__ << " Warning: " << content;                   \
+            ::ql::utils::logger::write(::ql::utils::logger::LogLevel::LOG_WARNING, ql_log_ss.str());        \
         }                                                                                                   \
     } while (false)
 
 #define QL_IOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_INFO) {                    \
-            ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " Info: "<< content << ::std::endl;      \
+        if (QL_LOG_ENABLED(::ql::utils::logger::LogLevel::LOG_INFO)) {                                      \
+            ::ql::utils::StrStrm ql_log_ss{};                                                               \
+            ql_log_ss << "[OPENQL] " __FILE__ ":" << __LINE__ << " Info: " << content;                      \
+            ::ql::utils::logger::write(::ql::utils::logger::LogLevel::LOG_INFO, ql_log_ss.str());           \
         }                                                                                                   \
     } while (false)
 
 #define QL_DOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_DEBUG) {                   \
-            ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " " << content << ::std::endl;           \
+        if (QL_LOG_ENABLED(::ql::utils::logger::LogLevel::LOG_DEBUG)) {                                     \
+            ::ql::utils::StrStrm ql_log_ss{};                                                               \
+            ql_log_ss << "[OPENQL] " __FILE__ ":" << __LINE__ << " " << content;                            \
+            ::ql::utils::logger::write(::ql::utils::logger::LogLevel::LOG_DEBUG, ql_log_ss.str());          \
         }                                                                                                   \
     } while (false)
 
 #define QL_COUT(content) \
     do {                                                                                                    \
-        ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " " << content << ::std::endl;               \
+        ::ql::utils::StrStrm ql_log_ss{};                                                                   \
+        ql_log_ss << "[OPENQL] " __FILE__ ":" << __LINE__ << " " << content;                                \
+        ::ql::utils::logger::write(::ql::utils::logger::LogLevel::LOG_INFO, ql_log_ss.str());               \
     } while (false)
 
 #define QL_FATAL(content) \
@@ -61,7 +79,7 @@
     } while (false)
 
 #define QL_IS_LOG_DEBUG \
-    (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_DEBUG)
+    QL_LOG_ENABLED(::ql::utils::logger::LogLevel::LOG_DEBUG)
 
 #define QL_IF_LOG_DEBUG \
     if QL_IS_LOG_DEBUG
@@ -79,11 +97,97 @@ enum LogLevel {
     LOG_DEBUG
 };
 
+/**
+ * The process-wide log level (verbosity). This applies to all threads that
+ * don't have a thread-local override, see set_thread_log_level().
+ */
 QL_GLOBAL extern LogLevel log_level;
 
+/**
+ * Value returned by get_thread_log_level() when the calling thread has no
+ * log level override.
+ */
+static const Int NO_THREAD_LOG_LEVEL = -1;
+
+/**
+ * Returns the log level that applies to the calling thread, i.e. its
+ * thread-local override if it has one, or the process-wide log level
+ * otherwise.
+ */
+LogLevel get_log_level();
+
+/**
+ * Returns the thread-local log level override for the calling thread, or
+ * NO_THREAD_LOG_LEVEL if it has none.
+ */
+Int get_thread_log_level();
+
+/**
+ * Sets the thread-local log level override for the calling thread. Passing
+ * NO_THREAD_LOG_LEVEL removes the override, such that the process-wide log
+ * level applies again. Threads spawned by parallel_for() inherit the override
+ * of the thread that calls it.
+ */
+void set_thread_log_level(Int level);
+
 LogLevel log_level_from_string(const Str &level);
 void set_log_level(const Str &level);
 
+/**
+ * How log messages are handed off to the sink.
+ */
+enum class BufferPolicy {
+
+    /**
+     * Messages are written to the sink by the thread that logs them. When
+     * logging to the console, each message is flushed immediately.
+     */
+    SYNCHRONOUS,
+
+    /**
+     * Messages are appended to a ring buffer owned by the logging thread, and
+     * written to the sink by a background thread. When the buffer of a thread
+     * is full, the thread waits until the writer has made room.
+     */
+    BLOCK,
+
+    /**
+     * Same as BLOCK, but when the buffer of a thread is full, new messages are
+     * dropped instead. The number of dropped messages is reported to the sink.
+     */
+    DROP
+
+};
+
+/**
+ * Writes a formatted log message (without trailing newline) to the sink. The
+ * level only selects the stream when logging to the console: errors and
+ * warnings go to stderr, everything else to stdout. This is normally only
+ * called via the QL_*OUT() macros.
+ */
+void write(LogLevel level, Str &&message);
+
+/**
+ * Sets the file that log messages are written to, or restores logging to
+ * stdout/stderr if filename is empty. Pending messages are written to the
+ * previous sink first.
+ */
+void set_sink(const Str &filename);
+
+/**
+ * Sets how messages are handed off to the sink, and the number of messages
+ * each thread can buffer for the asynchronous policies. Pending messages are
+ * written before the change takes effect. This should not be called while
+ * other threads are logging.
+ */
+void set_buffer_policy(BufferPolicy policy, UInt buffer_size);
+
+/**
+ * Writes all pending messages to the sink and flushes it. This is also done
+ * automatically when the process exits.
+ */
+void flush();
+
 } // namespace logger
 } // namespace utils
 } // namespace ql
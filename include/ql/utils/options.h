@@ -488,6 +488,22 @@ public:
         const utils::Str &line_prefix = ""
     ) const;
 
+    /**
+     * Returns the options record that was made current for the calling thread
+     * using set_thread_current(), or nullptr if there is none. This is used by
+     * com::options to select between the process-wide global options and a
+     * per-compilation options record.
+     */
+    static const Options *get_thread_current();
+
+    /**
+     * Makes the given options record current for the calling thread, or
+     * clears it if nullptr is passed. Threads spawned by parallel_for()
+     * inherit the current record of the thread that calls it. The record must
+     * outlive its use as the current record.
+     */
+    static void set_thread_current(const Options *options);
+
 };
 
 /**
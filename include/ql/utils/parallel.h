@@ -0,0 +1,44 @@
+/** \file
+ * Provides utilities for distributing independent work items over multiple
+ * threads.
+ */
+
+#pragma once
+
+#include <functional>
+#include "ql/utils/num.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Resolves a user-specified thread count to the number of threads that should
+ * actually be used. Zero is interpreted as the number of hardware threads
+ * supported by the system (or 1 if this cannot be determined).
+ */
+UInt get_num_threads(UInt requested);
+
+/**
+ * Calls fn(i) for every i in 0..count-1, distributing the calls over at most
+ * num_threads threads (where 0 means one thread per hardware thread, see
+ * get_num_threads()). The order in which the calls are made is undefined, so
+ * fn must only touch state that is either read-only or specific to index i.
+ * When num_threads resolves to 1 or count is less than 2, everything is done
+ * on the calling thread without spawning any threads.
+ *
+ * If any of the calls throws an exception, no new work items are started, and
+ * the first exception is rethrown on the calling thread once all threads have
+ * finished.
+ *
+ * The spawned threads inherit the thread-local log level override (see
+ * logger::set_thread_log_level()) and current options record (see
+ * Options::set_thread_current()) of the calling thread.
+ */
+void parallel_for(
+    UInt count,
+    UInt num_threads,
+    const std::function<void(UInt)> &fn
+);
+
+} // namespace utils
+} // namespace ql
@@ -11,6 +11,8 @@
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
 #include "ql/utils/map.h"
+#include "ql/utils/ptr.h"
+#include "ql/utils/filesystem.h"
 
 namespace ql {
 namespace utils {
@@ -21,12 +23,29 @@ public:
     enum class Scope { MODULE };
 
 public:
+    /*
+     * Start generating a VCD in memory, to be retrieved using getVcd() after finish().
+     */
     void start();
+
+    /*
+     * Start generating a VCD that is streamed to the given file. Value changes are kept in memory until they are
+     * flushed using flush() or finish(), so memory usage is bounded by the changes that are not yet flushed.
+     */
+    void start(const Str &filename);
+
     void scope(Scope type, const Str &name);
     int registerVar(const Str &name, VarType type, Scope scope=Scope::MODULE);
     void upscope();
     void change(Int var, Int timestamp, const Str &value);
     void change(Int var, Int timestamp, Int value);
+
+    /*
+     * Write all changes with a timestamp before the given timestamp. The caller guarantees that no such changes will
+     * be added afterwards.
+     */
+    void flush(Int timestamp);
+
     void finish();
     Str getVcd();
 
@@ -39,9 +58,17 @@ private:
     typedef Map<Int, VarChangeMap> TimestampMap; // map 'timestamp' to variables
 
 private:
-    Int lastId;
+    std::ostream &out();
+    void endDefinitions();
+
+private:
+    Int lastId = 0;
     TimestampMap timestampMap;
     StrStrm vcd;
+    Ptr<OutFile> file;                          // set when streaming to file
+    Bool definitionsDone = false;
+    Bool flushed = false;                       // whether flushedTimestamp is valid
+    Int flushedTimestamp = 0;                   // all changes before this timestamp have been written
 };
 
 } // namespace utils
@@ -4,6 +4,9 @@
 
 #include "ql/api/compiler.h"
 
+#include "ql/utils/map.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/parallel.h"
 #include "ql/ir/old_to_new.h"
 #include "ql/api/misc.h"
 #include "ql/api/platform.h"
@@ -405,6 +408,87 @@ void Compiler::compile(const Program &program) {
     pass_manager->compile(ir::convert_old_to_new(program.program));
 }
 
+/**
+ * Ensures that all passes have been constructed, and then runs the passes on
+ * each of the given programs, compiling up to num_threads programs
+ * concurrently. 0 means that the number of hardware threads is used. The
+ * result for each program is the same as for compile().
+ *
+ * All programs must use the same platform. The output prefixes of the passes
+ * (see their output_prefix option) must differ between the programs, because
+ * otherwise programs compiled concurrently would overwrite each other's
+ * output. This is the case when they include the uniquified program name
+ * (`%N`), or when the programs have distinct names and the prefixes include
+ * the program name (`%n`).
+ */
+void Compiler::compile_batch(const std::vector<Program> &programs, size_t num_threads) {
+    if (programs.empty()) {
+        return;
+    }
+
+    // Check the preconditions up front, such that we don't fail halfway
+    // through the batch.
+    for (const auto &program : programs) {
+        if (program.program->platform.get_ptr() != programs.front().program->platform.get_ptr()) {
+            throw ql::utils::Exception(
+                "all programs in a batch must use the same platform, but program \"" +
+                program.name + "\" does not use the platform of program \"" +
+                programs.front().name + "\""
+            );
+        }
+    }
+    ql::utils::Map<ql::utils::Str, ql::utils::UInt> prefix_owners;
+    for (ql::utils::UInt i = 0; i < programs.size(); i++) {
+        const auto &program = programs[i].program;
+
+        // Programs without kernels are converted without a program node, so
+        // the program name substitutions are empty for them.
+        ql::utils::Str name;
+        ql::utils::Str unique_name;
+        if (!program->kernels.empty()) {
+            name = program->name;
+            unique_name = program->unique_name;
+        }
+
+        for (const auto &prefix : pass_manager->get_output_prefixes(name, unique_name)) {
+            auto it = prefix_owners.find(prefix);
+            if (it == prefix_owners.end()) {
+                prefix_owners.set(prefix) = i;
+            } else {
+                throw ql::utils::Exception(
+                    "the programs in a batch must write their output to distinct "
+                    "files, but programs \"" + programs[it->second].name +
+                    "\" and \"" + programs[i].name + "\" both use output "
+                    "prefix \"" + prefix + "\"; use %N in the output_prefix "
+                    "pass option or give the programs distinct names"
+                );
+            }
+        }
+    }
+
+    // A manager can only be used by one thread at a time, so each program
+    // gets its own copy of it. Likewise, each program gets its own copy of the
+    // legacy platform that the legacy passes convert back to. The copies are
+    // made here, so the worker threads only ever read the originals, namely
+    // when converting the programs to the new IR.
+    ql::utils::Vec<ql::pmgr::Ref> managers;
+    ql::utils::Vec<ir::compat::PlatformRef> platforms;
+    for (ql::utils::UInt i = 0; i < programs.size(); i++) {
+        managers.emplace_back(pass_manager->clone());
+        platforms.push_back(programs.front().program->platform->copy());
+    }
+
+    QL_IOUT(
+        "compiling " << programs.size() << " program(s) using " <<
+        ql::utils::get_num_threads(num_threads) << " thread(s) ..."
+    );
+    ql::utils::parallel_for(programs.size(), num_threads, [&](ql::utils::UInt i) {
+        auto ir = ir::convert_old_to_new(programs[i].program);
+        ir->platform->set_annotation<ir::compat::PlatformRef>(platforms[i]);
+        managers[i]->compile(ir);
+    });
+}
+
 /**
  * Ensures that all passes have been constructed, and then runs the passes
  * without specification of an input program. The first pass should then act
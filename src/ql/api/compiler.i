@@ -674,6 +674,59 @@ None
 """
 
 
+%feature("docstring") ql::api::Compiler::compile_batch
+"""
+Ensures that all passes have been constructed, and then runs the passes on
+each of the given programs, compiling up to num_threads programs concurrently.
+0 means that the number of hardware threads is used. The result for each
+program is the same as for compile().
+
+All programs must use the same platform. The output prefixes of the passes
+(see their output_prefix option) must differ between the programs, because
+otherwise programs compiled concurrently would overwrite each other's output.
+This is the case when they include the uniquified program name (`%N`), or
+when the programs have distinct names and the prefixes include the program
+name (`%n`).
+
+Parameters
+----------
+programs : list[Program]
+    The programs to compile.
+num_threads : int
+    The maximum number of programs to compile concurrently, or 0 to use the
+    number of hardware threads.
+
+Returns
+-------
+None
+"""
+
+
+// Program is not assignable, so std::vector<Program> can't be wrapped as a
+// regular SWIG container; convert from any Python sequence of Programs instead.
+%typemap(in) const std::vector<ql::api::Program> & (std::vector<ql::api::Program> temp) {
+    if (!PySequence_Check($input)) {
+        SWIG_exception_fail(SWIG_TypeError, "expected a sequence of Program objects");
+    }
+    Py_ssize_t size = PySequence_Size($input);
+    for (Py_ssize_t i = 0; i < size; i++) {
+        PyObject *item = PySequence_GetItem($input, i);
+        void *ptr = nullptr;
+        int res = SWIG_ConvertPtr(item, &ptr, $descriptor(ql::api::Program *), 0);
+        Py_DECREF(item);
+        if (!SWIG_IsOK(res) || !ptr) {
+            SWIG_exception_fail(SWIG_TypeError, "expected a sequence of Program objects");
+        }
+        temp.push_back(*reinterpret_cast<ql::api::Program *>(ptr));
+    }
+    $1 = &temp;
+}
+
+%typemap(typecheck, precedence=SWIG_TYPECHECK_POINTER) const std::vector<ql::api::Program> & {
+    $1 = PySequence_Check($input) ? 1 : 0;
+}
+
+
 %feature("docstring") ql::api::Compiler::compile_with_frontend
 """
 Ensures that all passes have been constructed, and then runs the passes without
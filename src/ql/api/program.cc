@@ -174,23 +174,51 @@ void Program::compile() {
 }
 
 /**
- * Prints the interaction matrix for each kernel in the program.
+ * Converts the format argument of the interaction matrix functions.
+ */
+static ql::com::ana::InteractionMatrix::Format get_interaction_matrix_format(
+    const std::string &format
+) {
+    if (format == "text") {
+        return ql::com::ana::InteractionMatrix::Format::TEXT;
+    } else if (format == "csv") {
+        return ql::com::ana::InteractionMatrix::Format::CSV;
+    }
+    throw ql::utils::Exception(
+        "unknown interaction matrix format \"" + format + "\"; "
+        "must be \"text\" or \"csv\""
+    );
+}
+
+/**
+ * Prints the interaction matrix for each kernel in the program. Only the
+ * nonzero entries are listed, with one line per instruction type and qubit
+ * pair containing the number of two-qubit gates of that type between those
+ * qubits. format must be "text" or "csv"; the latter adds a header line and
+ * separates the fields with commas.
  */
-void Program::print_interaction_matrix() const {
+void Program::print_interaction_matrix(const std::string &format) const {
     QL_IOUT("printing interaction matrix...");
 
-    ql::com::ana::InteractionMatrix::dump_for_program(program);
+    ql::com::ana::InteractionMatrix::dump_for_program(
+        ir::convert_old_to_new(program),
+        std::cout,
+        get_interaction_matrix_format(format)
+    );
 }
 
 /**
- * Writes the interaction matrix for each kernel in the program to a file.
- * This is one of the few functions that still uses the global output_dir
- * option.
+ * Writes the interaction matrix for each kernel in the program to a file,
+ * in the same form as print_interaction_matrix(). The files are named
+ * <kernel>InteractionMatrix.dat for the text format and
+ * <kernel>InteractionMatrix.csv for CSV. This is one of the few functions
+ * that still uses the global output_dir option.
  */
-void Program::write_interaction_matrix() const {
+void Program::write_interaction_matrix(const std::string &format) const {
     ql::com::ana::InteractionMatrix::write_for_program(
         get_option("output_dir") + "/",
-        program
+        ir::convert_old_to_new(program),
+        get_interaction_matrix_format(format)
     );
 }
 
@@ -239,11 +239,16 @@ None
 
 %feature("docstring") ql::api::Program::print_interaction_matrix
 """
-Prints the interaction matrix for each kernel in the program.
+Prints the interaction matrix for each kernel in the program. Only the
+nonzero entries are listed, with one line per instruction type and qubit
+pair containing the number of two-qubit gates of that type between those
+qubits.
 
 Parameters
 ----------
-None
+format : str
+    The output format, either "text" (the default) or "csv". The latter adds
+    a header line and separates the fields with commas.
 
 Returns
 -------
@@ -253,13 +258,17 @@ None
 
 %feature("docstring") ql::api::Program::write_interaction_matrix
 """
-Writes the interaction matrix for each kernel in the program to a file.
-This is one of the few functions that still uses the global output_dir
-option.
+Writes the interaction matrix for each kernel in the program to a file, in
+the same form as print_interaction_matrix(). The files are named
+<kernel>InteractionMatrix.dat for the text format and
+<kernel>InteractionMatrix.csv for CSV. This is one of the few functions that
+still uses the global output_dir option.
 
 Parameters
 ----------
-None
+format : str
+    The output format, either "text" (the default) or "csv". The latter adds
+    a header line and separates the fields with commas.
 
 Returns
 -------
@@ -661,7 +661,7 @@ void Info::populate_backend_passes(pmgr::Manager &manager, const utils::Str &var
     // Remove prescheduler if enabled implicitly (pointless since we add our own scheduling).
     // FIXME: bit of a hack, and invalidates https://openql.readthedocs.io/en/latest/gen/reference_architectures.html#default-pass-list
     utils::Str ps_name = "prescheduler";
-    const auto &prescheduler = com::options::global[ps_name];
+    const auto &prescheduler = com::options::current()[ps_name];
     if (!prescheduler.is_set()) {               // prescheduler enabled implicitly
         if (manager.does_pass_exist(ps_name)) {
             manager.remove_pass(ps_name);
@@ -689,7 +689,7 @@ void Info::populate_backend_passes(pmgr::Manager &manager, const utils::Str &var
         "arch.cc.gen.VQ1Asm",
         "VQ1Asm",
         {
-            {"output_prefix", com::options::global["output_dir"].as_str() + "/%N"}
+            {"output_prefix", com::options::current()["output_dir"].as_str() + "/%N"}
         }
     );
 
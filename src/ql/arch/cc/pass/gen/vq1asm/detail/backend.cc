@@ -10,6 +10,7 @@
 
 #include "ql/utils/str.h"
 #include "ql/utils/filesystem.h"
+#include "ql/utils/parallel.h"
 #include "ql/ir/describe.h"
 #include "ql/ir/ops.h"
 #include "ql/com/options.h"
@@ -36,11 +37,47 @@ Backend::Backend(const ir::Ref &ir, const OptionsRef &options) : codegen(ir, opt
     // FIXME: Nodes of interest:
     //  - ir->program->entry_point.links_to
 
+    // optionally collect blocks without structured control flow concurrently. All state that depends on program
+    // order (labels, bundle numbers, codewords, datapath resources, VCD timing) is only touched when linking below,
+    // so the result is identical to the serial case
+    const auto &blocks = ir->program->blocks;
+    UInt num_threads = get_num_threads(options->num_threads);
+    Vec<Bool> is_collected(blocks.size(), false);
+    Vec<Vec<CollectedBundle>> collected(blocks.size());
+    if (num_threads > 1 && blocks.size() > 1) {
+        for (UInt i = 0; i < blocks.size(); i++) {
+            if (is_collectable_block(blocks[i])) {
+                try {
+                    prepare_block(blocks[i]);
+                } catch (utils::Exception &e) {
+                    e.add_context("in block '" + blocks[i]->name + "'");
+                    throw;
+                }
+                is_collected[i] = true;
+            }
+        }
+        parallel_for(blocks.size(), num_threads, [&](UInt i) {
+            if (is_collected[i]) {
+                try {
+                    collected[i] = collect_block(blocks[i]);
+                } catch (utils::Exception &e) {
+                    e.add_context("in block '" + blocks[i]->name + "'");
+                    throw;
+                }
+            }
+        });
+    }
+
     // generate code for all blocks
     // NB: based on NewToOldConverter::NewToOldConverter
-    for (const auto &block : ir->program->blocks) {
+    for (UInt i = 0; i < blocks.size(); i++) {
+        const auto &block = blocks[i];
         try {
-            codegen_block(block, block->name, 0);
+            if (is_collected[i]) {
+                link_block(block, collected[i]);
+            } else {
+                codegen_block(block, block->name, 0);
+            }
         } catch (utils::Exception &e) {
             e.add_context("in block '" + block->name + "'");
             throw;
@@ -49,16 +86,13 @@ Backend::Backend(const ir::Ref &ir, const OptionsRef &options) : codegen(ir, opt
 
     codegen.program_finish(ir->program->unique_name);
 
-    // write program to file
-    Str file_name(options->output_prefix + ".vq1asm");
-    QL_IOUT("Writing Central Controller program to " << file_name);
-    OutFile(file_name).write(codegen.get_program());
+    // NB: the program itself was written to file by codegen while generating code
 
     // write map to file (unless we were using input file. FIXME: that no longer makes sense)
     if (options->map_input_file.empty()) {
         Str file_name_map(options->output_prefix + ".map");
         QL_IOUT("Writing instrument map to " << file_name_map);
-        OutFile(file_name_map).write(codegen.get_map());
+        codegen.write_map(file_name_map);
     }
 
     QL_DOUT("Compiling Central Controller program [Done]");
@@ -320,6 +354,105 @@ void Backend::codegen_block(const ir::BlockBaseRef &block, const Str &name, Int
 
 }
 
+
+Bool Backend::is_collectable_block(const ir::BlockBaseRef &block) {
+    for (const auto &stmt : block->statements) {
+        if (stmt->as_custom_instruction() || stmt->as_wait_instruction()) {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+
+// decode the settings that collect_block() needs, since that may not modify Codegen
+void Backend::prepare_block(const ir::BlockBaseRef &block) {
+    for (const auto &stmt : block->statements) {
+        if (auto custom = stmt->as_custom_instruction()) {
+            try {
+                codegen.prepare_custom_instruction(*custom);
+            } catch (utils::Exception &e) {
+                e.add_context("in custom instruction '" + ir::describe(*custom) + "'", true);
+                throw;
+            }
+        }
+    }
+}
+
+
+// NB: only reads Backend and Codegen, so multiple blocks can be collected concurrently
+Vec<CollectedBundle> Backend::collect_block(const ir::BlockBaseRef &block) const {
+    Vec<CollectedBundle> bundles;
+    Int bundle_start_cycle = -1;
+    Int bundle_end_cycle = -1;
+
+    for (const auto &stmt : block->statements) {
+        auto insn = stmt->as_instruction();     // NB: guaranteed by is_collectable_block()
+        auto duration = ir::get_duration_of_statement(stmt);
+
+        // NB: bundle boundaries and durations are computed exactly as in codegen_block()
+        bundle_end_cycle = insn->cycle + duration;
+        if (insn->cycle != bundle_start_cycle) {
+            if (!bundles.empty()) {
+                bundles.back().durationInCycles = bundle_end_cycle - bundle_start_cycle;
+            }
+            bundles.emplace_back();
+            bundles.back().startCycle = insn->cycle;
+            bundles.back().bundleInfo = codegen.empty_bundle_info();
+            bundle_start_cycle = insn->cycle;
+        }
+
+        if (auto custom = stmt->as_custom_instruction()) {
+            CollectedInstruction ci;
+            try {
+                codegen.collect_custom_instruction(*custom, bundles.back().bundleInfo, ci);
+            } catch (utils::Exception &e) {
+                e.add_context("in custom instruction '" + ir::describe(*custom) + "'", true);
+                throw;
+            }
+            bundles.back().instructions.push_back(std::move(ci));
+        }
+    }
+    if (!bundles.empty()) {
+        bundles.back().durationInCycles = bundle_end_cycle - bundle_start_cycle;
+    }
+
+    return bundles;
+}
+
+
+// generate code for a block collected by collect_block(), see codegen_block() for the serial equivalent
+void Backend::link_block(const ir::BlockBaseRef &block, const Vec<CollectedBundle> &bundles) {
+    const Str &name = block->name;
+    Str label = QL_SS2S(name << "__" << block_number);
+
+    QL_IOUT("compiling block '" + label + "'");
+    codegen.block_start(name, 0);
+
+    for (UInt i = 0; i < bundles.size(); i++) {
+        const CollectedBundle &bundle = bundles[i];
+
+        bundleIdx++;
+        QL_DOUT("Bundle " << bundleIdx << ": start_cycle=" << bundle.startCycle);
+        codegen.bundle_start(
+            QL_SS2S(
+                "## Bundle " << bundleIdx
+                << ": start_cycle=" << bundle.startCycle
+                << ":"
+            )
+        );
+        codegen.bundle_link(bundle);
+
+        QL_DOUT("Finishing bundle " << bundleIdx << ": start_cycle=" << bundle.startCycle << ", duration=" << bundle.durationInCycles);
+        codegen.bundle_finish(bundle.startCycle, bundle.durationInCycles, i + 1 == bundles.size());
+    }
+
+    codegen.block_finish(name, ir::get_duration_of_block(block), 0);
+    QL_IOUT("finished compiling block '" + label + "'");
+    block_number++;
+}
+
 } // namespace detail
 } // namespace vq1asm
 } // namespace gen
@@ -42,6 +42,16 @@ private:
      */
     void codegen_block(const ir::BlockBaseRef &block, const Str &name, Int depth);
 
+    /*
+     * Support for parallel code generation. Blocks without structured control flow (i.e. basic blocks containing only
+     * custom and wait instructions) are collected concurrently into bundles by collect_block(), and the result is
+     * then linked in program order by link_block(), which generates the same code as codegen_block() would have.
+     */
+    static Bool is_collectable_block(const ir::BlockBaseRef &block);
+    void prepare_block(const ir::BlockBaseRef &block);
+    Vec<CollectedBundle> collect_block(const ir::BlockBaseRef &block) const;
+    void link_block(const ir::BlockBaseRef &block, const Vec<CollectedBundle> &bundles);
+
 private: // vars
     Codegen codegen;
     Int bundleIdx = -1;     // effectively, numbering starts at 0 because of pre-increment
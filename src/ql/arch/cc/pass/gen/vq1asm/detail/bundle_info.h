@@ -67,6 +67,27 @@ public: // vars
     // original instruction, for logging purposes
     Str describe;
 };
+
+
+// a custom instruction as collected by Codegen::collect_custom_instruction(), i.e. everything that can be determined
+// without touching the program-wide code generator state. The remaining work (comments, VCD) is done when linking
+struct CollectedInstruction {
+    Str iname;
+    Vec<UInt> qubits;
+    UInt cycle = 0;
+    UInt durationInCycles = 0;
+    Vec<Str> comments;      // comments generated for the instruction, in order
+};
+
+
+// a bundle as collected for parallel code generation, see Backend
+struct CollectedBundle {
+    UInt startCycle = 0;
+    UInt durationInCycles = 0;
+    Vec<CollectedInstruction> instructions;
+    Vec<Vec<BundleInfo>> bundleInfo;    // matrix[instrIdx][group]
+};
+
 } // namespace detail
 } // namespace vq1asm
 } // namespace gen
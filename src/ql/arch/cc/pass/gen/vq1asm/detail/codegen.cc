@@ -26,6 +26,9 @@ namespace detail {
 
 using namespace utils;
 
+// write buffer size used for the map file
+static const UInt MAP_WRITE_BUFFER_SIZE = 1024 * 1024;
+
 // helpers for label generation.
 static Str to_start(const Str &base) { return base + "_start"; };
 static Str to_end(const Str &base) { return base + "_end"; };
@@ -292,7 +295,7 @@ Codegen::Codegen(const ir::Ref &ir, const OptionsRef &options)
 
     // show instruments that can produce real-time measurement results
     for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
-        const Settings::InstrumentControl ic = settings.getInstrumentControl(instrIdx);
+        const Settings::InstrumentControl &ic = settings.getInstrumentControl(instrIdx);
         if (QL_JSON_EXISTS(ic.controlMode, "result_bits")) {  // this instrument mode produces results (i.e. it is a measurement device)
             QL_IOUT("instrument '" << ic.ii.instrumentName << "' (index " << instrIdx << ") can produce real-time measurement results");
         }
@@ -303,11 +306,8 @@ Codegen::Codegen(const ir::Ref &ir, const OptionsRef &options)
 | Generic
 \************************************************************************/
 
-Str Codegen::get_program() {
-    return cs.getCodeSection() + dp.getDatapathSection();
-}
-
-Str Codegen::get_map() {
+// NB: moves the tables into the map, so must be called only once, after program_finish()
+void Codegen::write_map(const Str &filename) {
     Json map;
 
     map["openql"]["version"] = OPENQL_VERSION_STRING;
@@ -315,17 +315,24 @@ Str Codegen::get_map() {
     map["openql"]["backend-version"] = CC_BACKEND_VERSION_STRING;
 
     map["codewords"]["version"] = 1;
-    map["codewords"]["data"] = codewordTable;
+    map["codewords"]["data"] = std::move(codewordTable);
 
     map["measurements"]["version"] = 2;
-    map["measurements"]["data"] = measTable;
-    map["measurements"]["nr-shots"] = shotsTable;
+    map["measurements"]["data"] = std::move(measTable);
+    map["measurements"]["nr-shots"] = std::move(shotsTable);
 
-    return QL_SS2S(std::setw(4) << map << std::endl);
+    OutFile file(filename, MAP_WRITE_BUFFER_SIZE);
+    file << std::setw(4) << map << '\n';
+    file.close();
 }
 
 
 void Codegen::program_start(const Str &progName) {
+    // stream program to file while generating code
+    Str file_name(options->output_prefix + ".vq1asm");
+    QL_IOUT("Writing Central Controller program to " << file_name);
+    cs.open(file_name);
+
     emitProgramStart(progName);
 
     dp.programStart();
@@ -345,7 +352,9 @@ void Codegen::program_start(const Str &progName) {
     QL_JSON_ASSERT(hardware_settings, "cycle_time", "hardware_settings/cycle_time");
     UInt cycle_time = hardware_settings["cycle_time"];
 
-    vcd.programStart(num_qubits, cycle_time, MAX_GROUPS, settings);
+    if (options->write_vcd) {
+        vcd.programStart(num_qubits, cycle_time, MAX_GROUPS, settings, options->output_prefix + ".vcd");
+    }
 }
 
 
@@ -354,7 +363,10 @@ void Codegen::program_finish(const Str &progName) {
 
     dp.programFinish();
 
-    vcd.programFinish(options->output_prefix + ".vcd");
+    // finish program file
+    cs.close(dp.getDatapathSection());
+
+    vcd.programFinish();
 }
 
 
@@ -377,20 +389,34 @@ void Codegen::block_finish(const Str &block_name, UInt durationInCycles, Int dep
 
 
 void Codegen::bundle_start(const Str &cmnt) {
+    bundleInfo = empty_bundle_info();
+
+    // generate source code comments
+    comment(cmnt);
+    dp.comment(cmnt, options->verbose);      // FIXME: comment is not fully appropriate, but at least allows matching with .CODE section
+}
+
+
+Vec<Vec<BundleInfo>> Codegen::empty_bundle_info() const {
     // create ragged 'matrix' of BundleInfo with proper vector size per instrument
-    bundleInfo.clear();
+    Vec<Vec<BundleInfo>> ret;
     BundleInfo empty;
     for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
-        const Settings::InstrumentControl ic = settings.getInstrumentControl(instrIdx);
-        bundleInfo.emplace_back(
+        const Settings::InstrumentControl &ic = settings.getInstrumentControl(instrIdx);
+        ret.emplace_back(
             ic.controlModeGroupCnt,     // one BundleInfo per group in the control mode selected for instrument
             empty                       // empty BundleInfo
         );
     }
+    return ret;
+}
 
-    // generate source code comments
-    comment(cmnt);
-    dp.comment(cmnt, options->verbose);      // FIXME: comment is not fully appropriate, but at least allows matching with .CODE section
+
+void Codegen::bundle_link(const CollectedBundle &bundle) {
+    for (const auto &ci : bundle.instructions) {
+        link_custom_instruction(ci);
+    }
+    bundleInfo = bundle.bundleInfo;
 }
 
 
@@ -403,7 +429,7 @@ Codegen::CodeGenMap Codegen::collectCodeGenInfo(
     // iterate over instruments
     for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
         // get control info from instrument settings
-        const Settings::InstrumentControl ic = settings.getInstrumentControl(instrIdx);
+        const Settings::InstrumentControl &ic = settings.getInstrumentControl(instrIdx);
         if (ic.ii.slot >= MAX_SLOTS) {
             QL_JSON_ERROR(
                 "illegal slot " << ic.ii.slot
@@ -616,6 +642,43 @@ void Codegen::bundle_finish(
 \************************************************************************/
 
 void Codegen::custom_instruction(const ir::CustomInstruction &custom) {
+    prepare_custom_instruction(custom);
+
+    CollectedInstruction ci;
+    try {
+        collect_custom_instruction(custom, bundleInfo, ci);
+    } catch (utils::Exception &e) {
+        for (const auto &c : ci.comments) {
+            comment(c);
+        }
+        showCodeSoFar();
+        throw;
+    }
+    link_custom_instruction(ci);
+}
+
+
+void Codegen::prepare_custom_instruction(const ir::CustomInstruction &custom) {
+    settings.getSignalDefinition(*custom.instruction_type);
+}
+
+
+void Codegen::link_custom_instruction(const CollectedInstruction &ci) {
+    // generate VCD
+    vcd.customGate(ci.iname, ci.qubits, ci.cycle, ci.durationInCycles);
+
+    // generate comments
+    for (const auto &c : ci.comments) {
+        comment(c);
+    }
+}
+
+
+void Codegen::collect_custom_instruction(
+    const ir::CustomInstruction &custom,
+    Vec<Vec<BundleInfo>> &bundleInfo,
+    CollectedInstruction &ci
+) const {
     Operands ops;
 
     // Handle the template operands for the instruction_type we got. Note that these are empty if that is a 'root'
@@ -696,23 +759,25 @@ void Codegen::custom_instruction(const ir::CustomInstruction &custom) {
     const Str iname = custom.instruction_type->name;
     UInt durationInCycles = custom.instruction_type->duration;
 
-    // generate VCD
-    vcd.customGate(iname, ops.qubits, custom.cycle, durationInCycles);
+    // remind what we need for VCD
+    ci.iname = iname;
+    ci.qubits = ops.qubits;
+    ci.cycle = custom.cycle;
+    ci.durationInCycles = durationInCycles;
 
     // generate comment
-    comment(Str(" # gate '") + ir::describe(custom) + "'");
+    ci.comments.push_back(Str(" # gate '") + ir::describe(custom) + "'");
 
-    // find signal vector definition for instruction
-    const Json &instruction = custom.instruction_type->data.data;
-    Settings::SignalDef sd = settings.findSignalDefinition(instruction, iname);
+    // find (decoded) signal vector definition for instruction
+    const Settings::ParsedSignalDef &psd = settings.getSignalDefinition(*custom.instruction_type);
 
     // turn signals defined for instruction into instruments & groups, and update matching BundleInfo records
-    for (UInt s = 0; s < sd.signal.size(); s++) {
-        Settings::CalcSignalValue csv = settings.calcSignalValue(sd, s, ops.qubits, iname);
+    for (UInt s = 0; s < psd.signals.size(); s++) {
+        Settings::CalcSignalValue csv = settings.calcSignalValue(psd, s, ops.qubits, iname);
 
-        comment(QL_SS2S(
-            "  # slot=" << csv.si.ic.ii.slot
-            << ", instrument='" << csv.si.ic.ii.instrumentName << "'"
+        ci.comments.push_back(QL_SS2S(
+            "  # slot=" << csv.si.ic->ii.slot
+            << ", instrument='" << csv.si.ic->ii.instrumentName << "'"
             << ", group=" << csv.si.group
             << "': signalValue='" << csv.signalValueString << "'"
         ));
@@ -725,14 +790,13 @@ void Codegen::custom_instruction(const ir::CustomInstruction &custom) {
 #if OPT_SUPPORT_STATIC_CODEWORDS
                 // FIXME: this does not only provide support, but findStaticCodewordOverride() currently actually requires static codewords
                 // NB: value NO_STATIC_CODEWORD_OVERRIDE (-1) means 'no override'
-                bi.staticCodewordOverride = Settings::findStaticCodewordOverride(instruction, csv.operandIdx, iname);
+                bi.staticCodewordOverride = psd.signals[s].staticCodewordOverride;
 #endif
             } else if (bi.signalValue == csv.signalValueString) {           // signal unchanged
                 // do nothing
             } else {
-                showCodeSoFar();
                 QL_USER_ERROR(
-                    "Signal conflict on instrument='" << csv.si.ic.ii.instrumentName
+                    "Signal conflict on instrument='" << csv.si.ic->ii.instrumentName
                     << "', group=" << csv.si.group
                     << ", between '" << bi.signalValue
                     << "' and '" << csv.signalValueString << "'"
@@ -752,7 +816,7 @@ void Codegen::custom_instruction(const ir::CustomInstruction &custom) {
         }
 
         // store operands used for real-time measurements, actual work is postponed to bundle_finish()
-        if (settings.isMeasRsltRealTime(*custom.instruction_type)) {
+        if (psd.isMeasRsltRealTime) {
             // FIXME: move the checks to collectCodeGenInfo?
             // FIXME: at the output side, similar checks are not performed
             /*
@@ -37,8 +37,8 @@ public: //  functions
     ~Codegen() = default;
 
     // Generic
-    Str get_program();                           // return the CC source code that was created
-    Str get_map();                               // return a map of codeword assignments, useful for configuring AWGs
+    // NB: the CC source code is streamed to '<output_prefix>.vq1asm' between program_start() and program_finish()
+    void write_map(const Str &filename);         // write a map of codeword assignments, useful for configuring AWGs
 
     // Compile support
 
@@ -84,6 +84,27 @@ public: //  functions
      */
     void custom_instruction(const ir::CustomInstruction &custom);
 
+    /*
+     * Support for parallel code generation, see Backend. custom_instruction() is split into three steps:
+     * - prepare_custom_instruction(): decodes the settings required for the instruction (serial)
+     * - collect_custom_instruction(): everything that only depends on the instruction and the settings, i.e. operand
+     *   decoding and mapping signals to instruments & groups. Only reads Codegen, so blocks can be collected
+     *   concurrently
+     * - link_custom_instruction(): the remaining side effects, performed in program order (serial)
+     * Collected bundles are linked using bundle_start(), bundle_link() and bundle_finish(), which performs all
+     * allocations (codewords, datapath resources) in program order, so the result does not depend on the number of
+     * threads
+     */
+    void prepare_custom_instruction(const ir::CustomInstruction &custom);
+    void collect_custom_instruction(
+        const ir::CustomInstruction &custom,
+        Vec<Vec<BundleInfo>> &bundleInfo,
+        CollectedInstruction &ci
+    ) const;
+    void link_custom_instruction(const CollectedInstruction &ci);
+    Vec<Vec<BundleInfo>> empty_bundle_info() const;
+    void bundle_link(const CollectedBundle &bundle);
+
     // Structured control flow
     void if_elif(const ir::ExpressionRef &condition, const Str &label, Int branch);
     void if_otherwise(const Str &label, Int branch);
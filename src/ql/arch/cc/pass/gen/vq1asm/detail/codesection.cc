@@ -19,19 +19,42 @@ CodeSection::CodeSection(OperandContext &operandContext)
     : operandContext(operandContext) {
 }
 
+// write buffer size used when streaming code to file
+static const UInt WRITE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+void CodeSection::open(const Str &filename) {
+    this->filename = filename;
+    file = Ptr<utils::OutFile>::make(filename, WRITE_BUFFER_SIZE);
+}
+
+void CodeSection::close(const Str &trailer) {
+    if (!file.has_value()) {
+        QL_ICE("CodeSection::close() called without open()");
+    }
+    *file << trailer;
+    file->close();
+    file.reset();
+}
+
 void CodeSection::showCodeSoFar() {
     // provide context to help finding reason. FIXME: limit # lines
-    QL_EOUT("Code so far:\n" << codeSection.str());
+    if (file.has_value()) {
+        file->unwrap().flush();
+        QL_EOUT("Code so far: see '" << filename << "'");
+    } else {
+        QL_EOUT("Code so far:\n" << codeSection.str());
+    }
 }
 
 void CodeSection::emitProgramHeader(const Str &progName) {
     // emit program header
-    codeSection << std::left;    // assumed by cs.emit()
-    codeSection << "# Program: '" << progName << "'" << std::endl;   // NB: put on top so it shows up in internal CC logging
-    codeSection << "# CC_BACKEND_VERSION " << CC_BACKEND_VERSION_STRING << std::endl;
-    codeSection << "# OPENQL_VERSION " << OPENQL_VERSION_STRING << std::endl;
-    codeSection << "# Note:    generated by OpenQL Central Controller backend" << std::endl;
-    codeSection << "#" << std::endl;
+    std::ostream &os = out();
+    os << std::left;    // assumed by cs.emit()
+    os << "# Program: '" << progName << "'\n";   // NB: put on top so it shows up in internal CC logging
+    os << "# CC_BACKEND_VERSION " << CC_BACKEND_VERSION_STRING << '\n';
+    os << "# OPENQL_VERSION " << OPENQL_VERSION_STRING << '\n';
+    os << "# Note:    generated by OpenQL Central Controller backend\n";
+    os << "#\n";
 }
 
 Int CodeSection::creg2reg(const ir::Reference &ref) {
@@ -55,15 +78,17 @@ UInt CodeSection::dest_reg(const ir::ExpressionRef &lhs) {
 // FIXME: make comment output depend on verboseCode
 
 // FIXME: merge with next function
+// NB: lines are terminated with '\n' rather than std::endl, to not flush the stream for every line
 void CodeSection::emit(const Str &labelOrComment, const Str &instr) {
+    std::ostream &os = out();
     if (labelOrComment.empty()) {                           // no label
-        codeSection << "                " << instr << std::endl;
+        os << "                " << instr << '\n';
     } else if (labelOrComment.length() < 16) {              // label fits before instr
-        codeSection << std::setw(16) << labelOrComment << std::setw(16) << instr << std::endl;
+        os << std::setw(16) << labelOrComment << std::setw(16) << instr << '\n';
     } else if (instr.empty()) {                             // no instr
-        codeSection << labelOrComment << std::endl;
+        os << labelOrComment << '\n';
     } else {
-        codeSection << labelOrComment << std::endl << "                " << instr << std::endl;
+        os << labelOrComment << '\n' << "                " << instr << '\n';
     }
 }
 
@@ -71,7 +96,7 @@ void CodeSection::emit(const Str &labelOrComment, const Str &instr) {
 // @param   labelOrSel      label must include trailing ":"
 // @param   comment         must include leading "#"
 void CodeSection::emit(const Str &labelOrSel, const Str &instr, const Str &ops, const Str &comment) {
-    codeSection << std::setw(16) << labelOrSel << std::setw(16) << instr << std::setw(36) << ops << comment << std::endl;
+    out() << std::setw(16) << labelOrSel << std::setw(16) << instr << std::setw(36) << ops << comment << '\n';
 }
 
 void CodeSection::emit(Int slot, const Str &instr, const Str &ops, const Str &comment) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ql/ir/ir.h"
+#include "ql/utils/filesystem.h"
 
 #include "types.h"
 #include "operands.h"
@@ -51,7 +52,18 @@ public:
     explicit CodeSection(OperandContext &operandContext);
     ~CodeSection() = default;
 
-    Str getCodeSection() { return codeSection.str(); };         // return the CC source code that was created
+    /*
+     * Stream the code to the given file while it is being generated, instead of collecting it in memory. Must be
+     * called before anything is emitted. The file is written through a large buffer, and is completed by close()
+     */
+    void open(const Str &filename);
+
+    /*
+     * Append the given trailer (i.e. the datapath section) to the file opened by open(), and close it
+     */
+    void close(const Str &trailer);
+
+    Str getCodeSection() { return codeSection.str(); };         // return the CC source code that was created (if not streaming to file)
     void showCodeSoFar();
     void emitProgramHeader(const Str &progName);
 
@@ -64,8 +76,13 @@ public:
     void emit(const Str &label, const Str &instr, const Str &ops, const Str &comment="");
     void emit(Int slot, const Str &instr, const Str &ops, const Str &comment="");
 
+private:    // functions
+    std::ostream &out() { return file.has_value() ? file->unwrap() : codeSection; }
+
 private:    // vars
-    StrStrm codeSection;                                        // the code generated
+    StrStrm codeSection;                                        // the code generated, if not streaming to file
+    Ptr<utils::OutFile> file;                                   // the file we stream to, see open()
+    Str filename;
 
     // Object instances needed
     OperandContext &operandContext;                             // context for Operand processing
@@ -66,14 +66,14 @@ public: // functions
     Str getDatapathSection() const { return datapathSection.str(); }
 
     void comment(const Str &cmnt, Bool verboseCode) {
-        if (verboseCode) datapathSection << cmnt << std::endl;
+        if (verboseCode) datapathSection << cmnt << '\n';
     }
 
 private:    // functions
     Str selString(Int sel) { return QL_SS2S("[" << sel << "]"); }
 
     void emit(const Str &sel, const Str &statement, const Str &comment="") {
-        datapathSection << std::setw(16) << sel << std::setw(16) << statement << std::setw(24) << comment << std::endl;
+        datapathSection << std::setw(16) << sel << std::setw(16) << statement << std::setw(24) << comment << '\n';
     }
     void emit(Int sel, const Str &statement, const Str &comment="") {
         emit(selString(sel), statement, comment);
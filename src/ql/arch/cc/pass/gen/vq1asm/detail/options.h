@@ -62,6 +62,17 @@ struct Options {
      */
     Bool run_once;
 
+    /**
+     * Whether a VCD file should be written.
+     */
+    Bool write_vcd;
+
+    /**
+     * Number of threads used to collect the information for blocks without
+     * structured control flow concurrently (0 means one per hardware thread).
+     */
+    UInt num_threads;
+
 };
 
 /**
@@ -99,6 +99,14 @@ void Settings::loadBackendSettings(const ir::PlatformRef &platform) {
     QL_JSON_ASSERT(hardwareSettings, "eqasm_backend_cc", "hardware_settings");  // NB: json_get<const json &> unavailable
     const Json &jsonBackendSettings = hardwareSettings["eqasm_backend_cc"];
     doLoadBackendSettings(jsonBackendSettings);
+
+    // build the tables used by the code generator, so it doesn't have to touch JSON for every gate/bundle
+    instrumentControls.clear();
+    for (UInt instrIdx = 0; instrIdx < jsonInstruments->size(); instrIdx++) {
+        instrumentControls.push_back(calcInstrumentControl(instrIdx));
+    }
+    buildSignalRoutingTables();
+    signalDefinitions.clear();
 }
 
 
@@ -152,69 +160,111 @@ Settings::SignalDef Settings::findSignalDefinition(const Json &instruction, cons
 }
 
 
+const Settings::ParsedSignalDef &Settings::getSignalDefinition(const ir::InstructionType &instrType) {
+    auto it = signalDefinitions.find(&instrType);
+    if (it == signalDefinitions.end()) {
+        it = signalDefinitions.emplace(&instrType, parseSignalDefinition(instrType.data.data, instrType.name)).first;
+    }
+    return it->second;
+}
+
+
+const Settings::ParsedSignalDef &Settings::getSignalDefinition(const ir::InstructionType &instrType) const {
+    auto it = signalDefinitions.find(&instrType);
+    if (it == signalDefinitions.end()) {
+        QL_ICE("signal definition for instruction '" << instrType.name << "' requested before it was decoded");
+    }
+    return it->second;
+}
+
+
+Settings::ParsedSignalDef Settings::parseSignalDefinition(const Json &instruction, const Str &iname) const {
+    ParsedSignalDef ret;
+    SignalDef sd = findSignalDefinition(instruction, iname);
+    ret.path = sd.path;
+    ret.isMeasRsltRealTime = false;
+
+    for (UInt s = 0; s < sd.signal.size(); s++) {
+        ParsedSignal ps;
+        Str signalSPath = QL_SS2S(sd.path<<"["<<s<<"]");                   // for JSON error reporting
+
+        // get the operand (i.e. qubit) index to work on
+        // NB: the key name "operand_idx" is a historical artifact: formerly all operands were qubits
+        // FIXME: replace array sd containing operand_idx with array (dimension: # operands) of arrays (dimension: # signals for operands, mostly 1, more for special cases like flux during measurement and phase corrections during CZ)
+        ps.operandIdx = json_get<UInt>(sd.signal[s], "operand_idx", signalSPath);
+
+        // get signal value
+        // FIXME: note that the actual contents of the signalValue only become important when we'll do automatic codeword assignment and provide codewordTable to downstream software to assign waveforms to the codewords
+        const Json &instructionSignalValue = json_get<const Json&>(sd.signal[s], "value", signalSPath);
+        // FIXME: also allow key "value" to be absent
+        if (instructionSignalValue.empty()) {    // allow empty signal
+            ps.valueString = "";
+        } else {
+            Str sv = QL_SS2S(instructionSignalValue);   // serialize/stream instructionSignalValue into std::string
+            sv = replace_all(sv, "\"", "");   // get rid of quotes
+            ps.valueString = sv;
+        }
+
+        // is this a measurement?
+        ps.isMeasure = isMeasureSignal(sd.signal[s], iname);
+        if (isMeasRsltSignalRealTime(sd.signal[s], iname)) {
+            ret.isMeasRsltRealTime = true;
+        }
+
+        // get instruction signal type (e.g. "mw", "flux", etc).
+        // NB: instructionSignalType is different from "instruction/type" provided by find_instruction_type, although some
+        // identical strings are used). NB: that key is no longer used by the 'core' of OpenQL
+        ps.type = json_get<Str>(sd.signal[s], "type", signalSPath);
+
+        // get the static codeword override, which is needed when the signal is actually output
+        ps.staticCodewordOverride = NO_STATIC_CODEWORD_OVERRIDE;
+#if OPT_SUPPORT_STATIC_CODEWORDS
+        if (!ps.valueString.empty()) {
+            ps.staticCodewordOverride = findStaticCodewordOverride(instruction, ps.operandIdx, iname);
+        }
+#endif
+
+        ret.signals.push_back(ps);
+    }
+    return ret;
+}
+
+
 Settings::CalcSignalValue Settings::calcSignalValue(
-    const Settings::SignalDef &sd,
+    const Settings::ParsedSignalDef &psd,
     UInt s,
     const Vec<UInt> &qubits,
     const Str &iname
-) {
+) const {
     CalcSignalValue ret;
-    Str signalSPath = QL_SS2S(sd.path<<"["<<s<<"]");                   // for JSON error reporting
+    const ParsedSignal &ps = psd.signals[s];
 
     /************************************************************************\
-    | decode sd.signal[s], and map operand index to qubit
+    | map operand index to qubit
     \************************************************************************/
 
-    // get the operand (i.e. qubit) index & qubit to work on
-    // NB: the key name "operand_idx" is a historical artifact: formerly all operands were qubits
-    // FIXME: replace array sd containing operand_idx with array (dimension: # operands) of arrays (dimension: # signals for operands, mostly 1, more for special cases like flux during measurement and phase corrections during CZ)
-    UInt operandIdx = json_get<UInt>(sd.signal[s], "operand_idx", signalSPath);
-    if (operandIdx >= qubits.size()) {
+    if (ps.operandIdx >= qubits.size()) {
         QL_JSON_ERROR(
             "instruction '" << iname
-            << "': JSON file defines operand_idx " << operandIdx
+            << "': JSON file defines operand_idx " << ps.operandIdx
             << ", but only " << qubits.size()
             << " qubit operands were provided (correct JSON, or provide enough operands)"
         );
     }
-    UInt qubit = qubits[operandIdx];
-
-    // get signal value
-    // FIXME: note that the actual contents of the signalValue only become important when we'll do automatic codeword assignment and provide codewordTable to downstream software to assign waveforms to the codewords
-    const Json instructionSignalValue = json_get<const Json>(sd.signal[s], "value", signalSPath);   // NB: json_get<const Json&> unavailable
-    // FIXME: also allow key "value" to be absent
-    if (instructionSignalValue.empty()) {    // allow empty signal
-        ret.signalValueString = "";
-    } else {
-        Str sv = QL_SS2S(instructionSignalValue);   // serialize/stream instructionSignalValue into std::string
-        sv = replace_all(sv, "\"", "");   // get rid of quotes
-#if 0   // FIXME: no longer useful? Maybe to disambiguate different signal_ref
-        // expand macros
-        sv = replace_all(sv, "{gateName}", iname);
-        sv = replace_all(sv, "{instrumentName}", FIXMEret.si.ic.ii.instrumentName);
-        sv = replace_all(sv, "{instrumentGroup}", to_string(ret.si.group));
-        sv = replace_all(sv, "{qubit}", to_string(qubit));
-#endif
-        ret.signalValueString = sv;
-    }
+    UInt qubit = qubits[ps.operandIdx];
 
-    // is this a measurement?
-    ret.isMeasure = isMeasureSignal(sd.signal[s], iname);
-
-    // get instruction signal type (e.g. "mw", "flux", etc).
-    // NB: instructionSignalType is different from "instruction/type" provided by find_instruction_type, although some
-    // identical strings are used). NB: that key is no longer used by the 'core' of OpenQL
-    Str instructionSignalType = json_get<Str>(sd.signal[s], "type", signalSPath);
+    ret.signalValueString = ps.valueString;
+    ret.isMeasure = ps.isMeasure;
 
     /************************************************************************\
     | map signal type for qubit to instrument & group
     \************************************************************************/
 
     // find signalInfo, i.e. perform the mapping of abstract signals to instruments
-    ret.si = findSignalInfoForQubit(instructionSignalType, qubit);
+    ret.si = findSignalInfoForQubit(ps.type, qubit);
 
 #if OPT_SUPPORT_STATIC_CODEWORDS
-    ret.operandIdx = operandIdx;
+    ret.operandIdx = ps.operandIdx;
 #endif
     return ret;
 }
@@ -245,7 +295,15 @@ Settings::InstrumentInfo Settings::getInstrumentInfo(UInt instrIdx) const {
 }
 
 
-Settings::InstrumentControl Settings::getInstrumentControl(UInt instrIdx) const {
+const Settings::InstrumentControl &Settings::getInstrumentControl(UInt instrIdx) const {
+    if (instrIdx >= instrumentControls.size()) {
+        QL_ICE("instrument control requested for instrument " << instrIdx << ", but table only has " << instrumentControls.size() << " entries");
+    }
+    return instrumentControls[instrIdx];
+}
+
+
+Settings::InstrumentControl Settings::calcInstrumentControl(UInt instrIdx) const {
     InstrumentControl ret;
 
     ret.ii = getInstrumentInfo(instrIdx);
@@ -301,58 +359,63 @@ Int Settings::getResultBit(const InstrumentControl &ic, Int group) {
 
 
 Settings::SignalInfo Settings::findSignalInfoForQubit(const Str &instructionSignalType, UInt qubit) const {
-    SignalInfo ret;
-    Bool signalTypeFound = false;
-    Bool qubitFound = false;
+    auto typeIt = signalRoutes.find(instructionSignalType);
+    if (typeIt == signalRoutes.end()) {
+        QL_JSON_ERROR("No instruments found providing signal type '" << instructionSignalType << "'");
+    }
+    auto qubitIt = typeIt->second.find(qubit);
+    if (qubitIt == typeIt->second.end()) {
+        QL_JSON_ERROR("No instruments found driving qubit " << qubit << " for signal type '" << instructionSignalType << "'");
+    }
+
+    // NB: pointer resolved here rather than stored in the table, so copies of Settings remain valid
+    SignalInfo ret = qubitIt->second;
+    ret.ic = &instrumentControls[ret.instrIdx];
+    return ret;
+}
+
+
+/*
+ * Build the table mapping (signal type, qubit) to instrument & group. If multiple instruments (or groups) drive the
+ * same qubit for the same signal type, the first one is used.
+ */
+void Settings::buildSignalRoutingTables() {
+    signalRoutes.clear();
 
     // iterate over instruments
-    for (UInt instrIdx = 0; instrIdx < jsonInstruments->size() && !qubitFound; instrIdx++) {
-        InstrumentControl ic = getInstrumentControl(instrIdx);
+    for (UInt instrIdx = 0; instrIdx < instrumentControls.size(); instrIdx++) {
+        const InstrumentControl &ic = instrumentControls[instrIdx];
         Str instrumentSignalType = json_get<Str>(*ic.ii.instrument, "signal_type", ic.ii.instrumentName);
-        if (instrumentSignalType == instructionSignalType) {
-            signalTypeFound = true;
-            const Json qubits = json_get<const Json>(*ic.ii.instrument, "qubits", ic.ii.instrumentName);   // NB: json_get<const json&> unavailable
-
-            // verify group size: qubits vs. control mode
-            UInt qubitGroupCnt = qubits.size();                                  // NB: JSON key qubits is a 'matrix' of [groups*qubits]
-            if (qubitGroupCnt != ic.controlModeGroupCnt) {
-                QL_JSON_ERROR(
-                    "instrument " << ic.ii.instrumentName
-                    << ": number of qubit groups " << qubitGroupCnt
-                    << " does not match number of control_bits groups " << ic.controlModeGroupCnt
-                    << " of selected control mode '" << ic.refControlMode << "'"
-                );
-            }
+        auto &routes = signalRoutes.set(instrumentSignalType);
+        const Json &qubits = json_get<const Json&>(*ic.ii.instrument, "qubits", ic.ii.instrumentName);
+
+        // verify group size: qubits vs. control mode
+        UInt qubitGroupCnt = qubits.size();                                  // NB: JSON key qubits is a 'matrix' of [groups*qubits]
+        if (qubitGroupCnt != ic.controlModeGroupCnt) {
+            QL_JSON_ERROR(
+                "instrument " << ic.ii.instrumentName
+                << ": number of qubit groups " << qubitGroupCnt
+                << " does not match number of control_bits groups " << ic.controlModeGroupCnt
+                << " of selected control mode '" << ic.refControlMode << "'"
+            );
+        }
 
-            // anyone connected to qubit?
-            for (UInt group = 0; group < qubitGroupCnt && !qubitFound; group++) {
-                for (UInt idx = 0; idx < qubits[group].size() && !qubitFound; idx++) {
-                    if (qubits[group][idx].get<UInt>() == qubit) {
-                        qubitFound = true;                                      // also: stop searching
-
-                        QL_DOUT(
-                            "qubit " << qubit
-                            << " signal type '" << instructionSignalType
-                            << "' driven by instrument '" << ic.ii.instrumentName
-                            << "' group " << group
-                        );
-
-                        ret.ic = ic;
-                        ret.instrIdx = instrIdx;
-                        ret.group = group;
-                    }
+        // anyone connected to qubit?
+        for (UInt group = 0; group < qubitGroupCnt; group++) {
+            for (UInt idx = 0; idx < qubits[group].size(); idx++) {
+                UInt qubit = qubits[group][idx].get<UInt>();
+                if (routes.find(qubit) == routes.end()) {
+                    QL_DOUT(
+                        "qubit " << qubit
+                        << " signal type '" << instrumentSignalType
+                        << "' driven by instrument '" << ic.ii.instrumentName
+                        << "' group " << group
+                    );
+                    routes.set(qubit) = SignalInfo{instrIdx, (Int)group, {}};
                 }
             }
         }
     }
-    if (!signalTypeFound) {
-        QL_JSON_ERROR("No instruments found providing signal type '" << instructionSignalType << "'");
-    }
-    if (!qubitFound) {
-        QL_JSON_ERROR("No instruments found driving qubit " << qubit << " for signal type '" << instructionSignalType << "'");
-    }
-
-    return ret;
 }
 
 /************************************************************************\
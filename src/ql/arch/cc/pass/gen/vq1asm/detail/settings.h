@@ -49,7 +49,23 @@ public: // types
     struct SignalInfo {
         UInt instrIdx;              // the index into JSON "eqasm_backend_cc/instruments" that provides the signal
         Int group;                  // the group of channels within the instrument that provides the signal
-        InstrumentControl ic;
+        RawPtr<const InstrumentControl> ic; // points into the instrument control table, set by findSignalInfoForQubit()
+    };
+
+    // a single signal of an instruction, i.e. sd.signal[s], decoded from JSON
+    struct ParsedSignal {
+        UInt operandIdx;            // key 'operand_idx'
+        Str type;                   // key 'type', the instruction signal type (e.g. "mw", "flux")
+        Str valueString;            // key 'value', serialized without quotes. Empty implies no signal
+        Bool isMeasure;
+        Int staticCodewordOverride; // NO_STATIC_CODEWORD_OVERRIDE if not applicable
+    };
+
+    // the signal definition of an instruction, decoded from JSON
+    struct ParsedSignalDef {
+        Str path;                   // path of the signal node, for reporting purposes
+        Vec<ParsedSignal> signals;
+        Bool isMeasRsltRealTime;    // see isMeasRsltRealTime()
     };
 
     // return type for calcSignalValue()
@@ -129,22 +145,38 @@ public: // functions
     SignalDef findSignalDefinition(const Json &instruction, const Str &iname) const;
 
     /*
-     * Compute signalValueString, and some meta information, for sd[s] (i.e. one of the signals in the JSON definition
-     * of an instruction)
+     * Get the decoded signal definition for an instruction type. The JSON definition is decoded on first use, and
+     * cached for subsequent uses, so the code generator does not need to touch JSON for every gate.
+     */
+    const ParsedSignalDef &getSignalDefinition(const ir::InstructionType &instrType);
+
+    /*
+     * Same as above, but the signal definition must already have been decoded by the non-const version. Does not
+     * modify Settings, and can thus be used concurrently from multiple threads.
+     */
+    const ParsedSignalDef &getSignalDefinition(const ir::InstructionType &instrType) const;
+
+    /*
+     * Compute signalValueString, and some meta information, for psd.signals[s] (i.e. one of the signals in the
+     * definition of an instruction)
      * NB: helper for codegen::custom_instruction, which is called with try/catch to add error context
      */
-    CalcSignalValue calcSignalValue(const Settings::SignalDef &sd, UInt s, const Vec<UInt> &qubits, const Str &iname);
+    CalcSignalValue calcSignalValue(const ParsedSignalDef &psd, UInt s, const Vec<UInt> &qubits, const Str &iname) const;
 
     /*
      * Collect some configuration info for an instrument.
      */
     InstrumentInfo getInstrumentInfo(UInt instrIdx) const;
 
-    InstrumentControl getInstrumentControl(UInt instrIdx) const;
+    /*
+     * Get the control info for an instrument from the table built by loadBackendSettings(const ir::PlatformRef &).
+     */
+    const InstrumentControl &getInstrumentControl(UInt instrIdx) const;
     static Int getResultBit(const InstrumentControl &ic, Int group) ;
 
     /*
-     * Find instrument&group given instructionSignalType for qubit.
+     * Find instrument&group given instructionSignalType for qubit, using the table built by
+     * loadBackendSettings(const ir::PlatformRef &).
      *
      * NB: we map signal *vectors* to groups, i.e. it is not possible to map individual channels.
      *
@@ -161,12 +193,22 @@ public: // functions
 
 private:    // functions
     void doLoadBackendSettings(const Json &jsonBackendSettings);
+    InstrumentControl calcInstrumentControl(UInt instrIdx) const;
+    void buildSignalRoutingTables();
+    ParsedSignalDef parseSignalDefinition(const Json &instruction, const Str &iname) const;
 
 private:    // vars
     RawPtr<const Json> jsonInstrumentDefinitions;
     RawPtr<const Json> jsonControlModes;
     RawPtr<const Json> jsonInstruments;
     RawPtr<const Json> jsonSignals;
+
+    // tables built at backend construction, see loadBackendSettings(const ir::PlatformRef &)
+    Vec<InstrumentControl> instrumentControls;                  // indexed by instrIdx
+    Map<Str, Map<UInt, SignalInfo>> signalRoutes;               // signal type -> qubit -> instrument & group
+
+    // signal definitions decoded on first use, see getSignalDefinition()
+    Map<const ir::InstructionType*, ParsedSignalDef> signalDefinitions;
 }; // class
 
 } // namespace detail
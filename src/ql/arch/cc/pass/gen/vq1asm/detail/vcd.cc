@@ -23,12 +23,14 @@ namespace detail {
 using namespace utils;
 
 // NB: parameters qubitNumber and cycleTime originate from OpenQL variable 'platform'
-void Vcd::programStart(UInt qubitNumber, Int cycleTime, Int maxGroups, const Settings &settings) {
+void Vcd::programStart(UInt qubitNumber, Int cycleTime, Int maxGroups, const Settings &settings, const Str &filename) {
+    enabled = true;
     this->cycleTime = cycleTime;
     kernelStartTime = 0;
 
-    // define header
-    start();
+    // define header, the VCD is streamed to file while generating code
+    QL_IOUT("Writing Value Change Dump to " << filename);
+    start(filename);
 
     // define kernel variable
     scope(Vcd::Scope::MODULE, "kernel");
@@ -73,22 +75,29 @@ void Vcd::programStart(UInt qubitNumber, Int cycleTime, Int maxGroups, const Set
 }
 
 
-void Vcd::programFinish(const Str &filename) {
-    // generate VCD
-    finish();
+void Vcd::programFinish() {
+    if (!enabled) {
+        return;
+    }
 
-    // write VCD to file
-    QL_IOUT("Writing Value Change Dump to " << filename);
-    OutFile(filename).write(getVcd());
+    // write remaining changes and close file
+    finish();
 }
 
 
 void Vcd::kernelFinish(const Str &kernelName, UInt durationInCycles) {
+    if (!enabled) {
+        return;
+    }
+
     // NB: timing starts anew for every kernel
     UInt durationInNs = durationInCycles * cycleTime;
     change(vcdVarKernel, kernelStartTime, kernelName);          // start of kernel
     change(vcdVarKernel, kernelStartTime + durationInNs, "");   // end of kernel
     kernelStartTime += durationInNs;
+
+    // subsequent kernels start at kernelStartTime, so everything before that can be written
+    flush(kernelStartTime);
 }
 
 
@@ -100,6 +109,10 @@ void Vcd::bundleFinishGroup(
         UInt instrIdx,
         Int group
 ) {
+    if (!enabled) {
+        return;
+    }
+
     // generate signal output for group
     UInt startTime = kernelStartTime + startCycle * cycleTime;
     UInt durationInNs = durationInCycles * cycleTime;
@@ -111,6 +124,10 @@ void Vcd::bundleFinishGroup(
 
 
 void Vcd::bundleFinish(UInt startCycle, tDigital digOut, UInt maxDurationInCycles, UInt instrIdx) {
+    if (!enabled) {
+        return;
+    }
+
     // generate codeword output for instrument
     UInt startTime = kernelStartTime + startCycle * cycleTime;
     UInt durationInNs = maxDurationInCycles * cycleTime;
@@ -122,6 +139,10 @@ void Vcd::bundleFinish(UInt startCycle, tDigital digOut, UInt maxDurationInCycle
 
 
 void Vcd::customGate(const Str &iname, const Vec<UInt> &qops, UInt startCycle, UInt durationInCycles) {
+    if (!enabled) {
+        return;
+    }
+
     // generate qubit VCD output
     UInt startTime = kernelStartTime + startCycle*cycleTime;
     UInt durationInNs = durationInCycles*cycleTime;
@@ -26,14 +26,16 @@ public:     // funcs
     Vcd() = default;
     ~Vcd() = default;
 
-    void programStart(UInt qubitNumber, Int cycleTime, Int maxGroups, const Settings &settings);
-    void programFinish(const Str &filename);
+    // NB: VCD generation is disabled unless programStart() is called, in which case all other functions do nothing
+    void programStart(UInt qubitNumber, Int cycleTime, Int maxGroups, const Settings &settings, const Str &filename);
+    void programFinish();
     void kernelFinish(const Str &kernelName, UInt durationInCycles);
     void bundleFinishGroup(UInt startCycle, UInt durationInCycles, tDigital groupDigOut, const Str &signalValue, UInt instrIdx, Int group);
     void bundleFinish(UInt startCycle, tDigital digOut, UInt maxDurationInCycles, UInt instrIdx);
     void customGate(const Str &iname, const Vec<UInt> &qops, UInt startCycle, UInt durationInCycles);
 
 private:    // vars
+    Bool enabled = false;
     UInt cycleTime = 1;
     UInt kernelStartTime = 0;
     Int vcdVarKernel = 0;
@@ -32,7 +32,9 @@ void GenerateVQ1AsmPass::dump_docs(
      - `<prefix>.vq1asm`: the assembly code output file;
      - `<prefix>.map`: the instrument configuration file; and
      - `<prefix>.vcd`: a VCD (value change dump) file for viewing the waveforms
-       that the program outputs.
+       that the program outputs, unless disabled using the `write_vcd` option.
+       This file is written while the code is being generated, such that only
+       the value changes of the current block are kept in memory.
 
     The pass is compile-time configured with the following options:
      - `OPT_CC_SCHEDULE_RC` = )"           + utils::to_string(OPT_CC_SCHEDULE_RC)           + R"(
@@ -40,6 +42,14 @@ void GenerateVQ1AsmPass::dump_docs(
      - `OPT_STATIC_CODEWORDS_ARRAYS` = )"  + utils::to_string(OPT_STATIC_CODEWORDS_ARRAYS)  + R"(
      - `OPT_VECTOR_MODE` = )"              + utils::to_string(OPT_VECTOR_MODE)              + R"(
      - `OPT_CC_USER_FUNCTIONS` = )"        + utils::to_string(OPT_CC_USER_FUNCTIONS)        + R"(
+
+    With `num_threads` set to anything other than 1, blocks without structured
+    control flow (i.e. containing only gates and waits) are processed
+    concurrently: operands are decoded and signals are mapped to instruments
+    for each block independently, after which the blocks are linked in program
+    order. Labels, bundle numbers, codewords and datapath resources are only
+    assigned while linking, so the output is identical to the single-threaded
+    output.
     )");
 }
 
@@ -77,6 +87,22 @@ GenerateVQ1AsmPass::GenerateVQ1AsmPass(
         "indefinitely."
     );
 
+    options.add_bool(
+        "write_vcd",
+        "When set, a VCD (value change dump) file is written alongside the "
+        ".vq1asm file, for viewing the waveforms that the program outputs. "
+        "Disabling this saves time and memory for large programs.",
+        true
+    );
+
+    options.add_int(
+        "num_threads",
+        "The number of threads used to process blocks without structured "
+        "control flow concurrently. 0 means that the number of hardware "
+        "threads is used.",
+        "1", 0, utils::MAX
+    );
+
 }
 
 /**
@@ -104,6 +130,8 @@ utils::Int GenerateVQ1AsmPass::run(
     parsed_options->map_input_file = options["map_input_file"].as_str();
     parsed_options->run_once = options["run_once"].as_bool();
     parsed_options->verbose = options["verbose"].as_bool();
+    parsed_options->write_vcd = options["write_vcd"].as_bool();
+    parsed_options->num_threads = options["num_threads"].as_uint();
 
     // Run the backend.
     QL_DOUT("Running Central Controller backend ... ");
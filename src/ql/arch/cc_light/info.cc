@@ -153,19 +153,19 @@ utils::Str Info::get_default_platform(const utils::Str &variant) const {
 void Info::populate_backend_passes(pmgr::Manager &manager, const utils::Str &variant) const {
 
     // Mapping.
-    if (com::options::global["clifford_premapper"].as_bool()) {
+    if (com::options::current()["clifford_premapper"].as_bool()) {
         manager.append_pass(
             "opt.clifford.Optimize",
             "clifford_premapper"
         );
     }
-    if (com::options::global["mapper"].as_str() != "no") {
+    if (com::options::current()["mapper"].as_str() != "no") {
         manager.append_pass(
             "map.qubits.Map",
             "mapper"
         );
     }
-    if (com::options::global["clifford_postmapper"].as_bool()) {
+    if (com::options::current()["clifford_postmapper"].as_bool()) {
         manager.append_pass(
             "opt.clifford.Optimize",
             "clifford_postmapper"
@@ -173,7 +173,7 @@ void Info::populate_backend_passes(pmgr::Manager &manager, const utils::Str &var
     }
 
     // Scheduling.
-    if (com::options::global["scheduler_heuristic"].is_set()) {
+    if (com::options::current()["scheduler_heuristic"].is_set()) {
         manager.append_pass(
             "sch.Schedule",
             "rcscheduler",
@@ -194,7 +194,7 @@ void Info::populate_backend_passes(pmgr::Manager &manager, const utils::Str &var
         "io.cqasm.Report",
         "lastqasmwriter",
         {
-            {"output_prefix", com::options::global["output_dir"].as_str() + "/%N"},
+            {"output_prefix", com::options::current()["output_dir"].as_str() + "/%N"},
             {"output_suffix", "_last.qasm"}
         }
     );
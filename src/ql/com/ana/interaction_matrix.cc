@@ -4,9 +4,8 @@
 
 #include "ql/com/ana/interaction_matrix.h"
 
-#include <iomanip>
 #include "ql/utils/filesystem.h"
-#include "ql/com/options.h"
+#include "ql/ir/ops.h"
 
 namespace ql {
 namespace com {
@@ -14,95 +13,147 @@ namespace ana {
 
 using namespace utils;
 
-InteractionMatrix::InteractionMatrix(
-    const ir::compat::KernelRef &kernel
-) : size(kernel->qubit_count) {
-    matrix.resize(size, Vec<UInt>(size, 0));
-    for (auto ins : kernel->gates) {
-        Str insName = ins->qasm();
-        if (insName.find("cnot") != Str::npos) {
-            // for now the interaction matrix only for cnot
-            auto operands = ins->operands;
-            if (operands.size() == 2) {
-                UInt operand0 = operands[0];
-                UInt operand1 = operands[1];
-                matrix[operand0][operand1] += 1;
-                matrix[operand1][operand0] += 1;
+/**
+ * Write buffer size used when writing interaction matrices to files.
+ */
+static const UInt WRITE_BUFFER_SIZE = 1024 * 1024;
+
+/**
+ * Updates the interaction counts for the given instruction.
+ */
+void InteractionMatrix::process_instruction(
+    const ir::Ref &ir,
+    const ir::InstructionRef &instruction
+) {
+    auto custom = instruction->as_custom_instruction();
+    if (!custom) {
+        return;
+    }
+
+    // Cheap check on the instruction type first, such that single-qubit
+    // gates, which are usually the majority, are skipped right away.
+    if (ir::get_number_of_qubits_involved(instruction) != 2) {
+        return;
+    }
+
+    UInt qubits[2];
+    UInt num_qubits = 0;
+    for (const auto &op : ir::get_operands(instruction)) {
+        if (auto ref = op->as_reference()) {
+            if (
+                ref->target == ir->platform->qubits &&
+                ref->data_type == ir->platform->qubits->data_type &&
+                ref->indices.size() == 1 &&
+                ref->indices[0]->as_int_literal()
+            ) {
+                if (num_qubits == 2) {
+                    return;
+                }
+                qubits[num_qubits++] = ref->indices[0]->as_int_literal()->value;
             }
         }
     }
+    if (num_qubits != 2) {
+        return;
+    }
+
+    QubitPair pair{min(qubits[0], qubits[1]), max(qubits[0], qubits[1])};
+    value.set(ir::get_generalization(custom->instruction_type)->name).set(pair)++;
 }
 
 /**
- * Returns the embedded matrix.
+ * Returns the total number of two-qubit gates for each pair of qubits,
+ * regardless of instruction type.
  */
-const InteractionMatrix::Matrix &InteractionMatrix::get_matrix() const {
-    return matrix;
+Map<QubitPair, UInt> InteractionMatrix::get_totals(const InteractionCounts &counts) {
+    Map<QubitPair, UInt> totals;
+    for (const auto &type_it : counts) {
+        for (const auto &pair_it : type_it.second) {
+            totals.set(pair_it.first) += pair_it.second;
+        }
+    }
+    return totals;
 }
 
 /**
- * Returns the matrix as a string.
+ * Streams the nonzero entries of the given interaction matrix to the given
+ * output stream in the given format.
  */
-Str InteractionMatrix::get_string() const {
-    StrStrm ss;
-
-    // Use the following for properly aligned matrix print for visual inspection
-    // This can be problematic of width not set properly to be processed by gnuplot script
-#define ALIGNMENT (std::setw(4))
-
-    // Use the following to print tabs which will not be visually appealing but it will
-    // generate the columns properly for further processing by other tools
-    // #define ALIGNMENT ("    ")
+void InteractionMatrix::write(
+    const InteractionCounts &counts,
+    std::ostream &os,
+    Format format
+) {
+    switch (format) {
+        case Format::TEXT:
+            for (const auto &type_it : counts) {
+                for (const auto &pair_it : type_it.second) {
+                    os << type_it.first;
+                    os << " q" << pair_it.first.first;
+                    os << " q" << pair_it.first.second;
+                    os << " " << pair_it.second << "\n";
+                }
+            }
+            break;
+
+        case Format::CSV:
+            os << "instruction,qubit0,qubit1,count\n";
+            for (const auto &type_it : counts) {
+                for (const auto &pair_it : type_it.second) {
+                    os << type_it.first;
+                    os << "," << pair_it.first.first;
+                    os << "," << pair_it.first.second;
+                    os << "," << pair_it.second << "\n";
+                }
+            }
+            break;
 
-    ss << ALIGNMENT << " ";
-    for (UInt c = 0; c < size; c++) {
-        ss << ALIGNMENT << "q" + to_string(c);
     }
-    ss << std::endl;
-
-    for (UInt p = 0; p < size; p++) {
-        ss << ALIGNMENT << "q" + to_string(p);
-        for (UInt c = 0; c < size; c++) {
-            ss << ALIGNMENT << matrix[p][c];
-        }
-        ss << std::endl;
-    }
-#undef ALIGNMENT
-
-    return ss.str();
 }
 
 /**
- * Constructs interaction matrices for each kernel in the program, and
+ * Constructs interaction matrices for each block in the program, and
  * reports the results to the given output stream.
  */
 void InteractionMatrix::dump_for_program(
-    const ir::compat::ProgramRef &program,
-    std::ostream &os
+    const ir::Ref &ir,
+    std::ostream &os,
+    Format format
 ) {
-    for (const auto &k : program->kernels) {
-        InteractionMatrix imat(k);
-        utils::Str mstr = imat.get_string();
-        os << mstr << std::endl;
+    if (ir->program.empty()) {
+        return;
+    }
+    for (const auto &block : ir->program->blocks) {
+        if (format == Format::TEXT) {
+            os << "# " << block->name << "\n";
+        }
+        write(compute_block<InteractionMatrix>(ir, block), os, format);
+        os << std::endl;
     }
 }
 
 /**
  * Same as dump_for_program(), but writes the result to files in the
  * current globally-configured output directory, using the names
- * "<kernel>InteractionMatrix.dat".
+ * "<prefix><block>InteractionMatrix.dat" for the text format, or
+ * "<prefix><block>InteractionMatrix.csv" for CSV.
  */
 void InteractionMatrix::write_for_program(
-    const utils::Str &output_prefix,
-    const ir::compat::ProgramRef &program
+    const Str &output_prefix,
+    const ir::Ref &ir,
+    Format format
 ) {
-    for (const auto &k : program->kernels) {
-        ql::com::ana::InteractionMatrix imat(k);
-        utils::Str mstr = imat.get_string();
-
-        utils::Str fname = output_prefix + "/" + k->get_name() + "InteractionMatrix.dat";
+    if (ir->program.empty()) {
+        return;
+    }
+    for (const auto &block : ir->program->blocks) {
+        Str fname = output_prefix + block->name + "InteractionMatrix";
+        fname += format == Format::CSV ? ".csv" : ".dat";
         QL_IOUT("writing interaction matrix to '" << fname << "' ...");
-        utils::OutFile(fname).write(mstr);
+        OutFile file{fname, WRITE_BUFFER_SIZE};
+        write(compute_block<InteractionMatrix>(ir, block), file.unwrap(), format);
+        file.check();
+        file.close();
     }
 }
 
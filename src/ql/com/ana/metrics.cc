@@ -5,6 +5,7 @@
 
 #include "ql/com/ana/metrics.h"
 
+#include "ql/utils/parallel.h"
 #include "ql/ir/ops.h"
 
 namespace ql {
@@ -99,6 +100,127 @@ void Latency::process_block(const ir::Ref &ir, const ir::BlockBaseRef &block) {
     value = ir::get_duration_of_block(block);
 }
 
+/**
+ * Merges the values computed for a subsequent top-level block into these
+ * values. The latency is that of the last block, consistent with what the
+ * Latency metric returns for a program.
+ */
+void BasicMetricValues::merge(const BasicMetricValues &other) {
+    latency = other.latency;
+    quantum_gate_count += other.quantum_gate_count;
+    multi_qubit_gate_count += other.multi_qubit_gate_count;
+    classical_operation_count += other.classical_operation_count;
+    for (const auto &it : other.qubit_usage_count) {
+        qubit_usage_count[it.first] += it.second;
+    }
+    for (const auto &it : other.qubit_used_cycle_count) {
+        qubit_used_cycle_count[it.first] += it.second;
+    }
+}
+
+/**
+ * Constructs the metric, computing the given selection of metrics.
+ */
+BasicMetrics::BasicMetrics(utils::UInt selection) : selection(selection) {
+}
+
+/**
+ * Updates all selected instruction-based metrics using the given instruction.
+ */
+void BasicMetrics::process_instruction(
+    const ir::Ref &ir,
+    const ir::InstructionRef &instruction
+) {
+    if (selection & CLASSICAL_OPERATION_COUNT) {
+        if (instruction->as_set_instruction() || instruction->as_goto_instruction()) {
+            value.classical_operation_count++;
+        }
+    }
+    if (selection & (QUANTUM_GATE_COUNT | MULTI_QUBIT_GATE_COUNT)) {
+        auto num_qubits = ir::get_number_of_qubits_involved(instruction);
+        if ((selection & QUANTUM_GATE_COUNT) && num_qubits) {
+            value.quantum_gate_count++;
+        }
+        if ((selection & MULTI_QUBIT_GATE_COUNT) && num_qubits > 1) {
+            value.multi_qubit_gate_count++;
+        }
+    }
+    if (selection & (QUBIT_USAGE_COUNT | QUBIT_USED_CYCLE_COUNT)) {
+        utils::UInt duration = 0;
+        if (selection & QUBIT_USED_CYCLE_COUNT) {
+            duration = ir::get_duration_of_instruction(instruction);
+        }
+        for (auto &op : ir::get_operands(instruction)) {
+            if (auto ref = op->as_reference()) {
+                if (
+                    ref->target == ir->platform->qubits &&
+                    ref->data_type == ir->platform->qubits->data_type &&
+                    ref->indices.size() == 1 &&
+                    ref->indices[0]->as_int_literal()
+                ) {
+                    auto qubit = ref->indices[0]->as_int_literal()->value;
+                    if (selection & QUBIT_USAGE_COUNT) {
+                        value.qubit_usage_count[qubit]++;
+                    }
+                    if (selection & QUBIT_USED_CYCLE_COUNT) {
+                        value.qubit_used_cycle_count[qubit] += duration;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Updates the latency for top-level blocks, and recurses into the block if
+ * any instruction-based metrics are selected.
+ */
+void BasicMetrics::process_block(
+    const ir::Ref &ir,
+    const ir::BlockBaseRef &block
+) {
+    if (depth == 0 && (selection & LATENCY)) {
+        value.latency = ir::get_duration_of_block(block);
+    }
+    if (selection & ~LATENCY) {
+        depth++;
+        Metric<BasicMetricValues>::process_block(ir, block);
+        depth--;
+    }
+}
+
+/**
+ * Returns the results gathered thus far.
+ */
+BasicMetricValues BasicMetrics::get_result() {
+    return value;
+}
+
+/**
+ * Computes the BasicMetrics metric with the given selection independently for
+ * each top-level block of the program, returning the values in program order.
+ * Up to num_threads blocks are processed concurrently; 0 means one thread per
+ * hardware thread. The program-wide values can be obtained by merging the
+ * returned values in order.
+ */
+utils::Vec<BasicMetricValues> compute_basic_metrics_per_block(
+    const ir::Ref &ir,
+    utils::UInt selection,
+    utils::UInt num_threads
+) {
+    if (ir->program.empty()) {
+        return {};
+    }
+    const auto &blocks = ir->program->blocks;
+    utils::Vec<BasicMetricValues> values(blocks.size());
+    utils::parallel_for(blocks.size(), num_threads, [&](utils::UInt i) {
+        BasicMetrics metric{selection};
+        metric.process_block(ir, blocks[i]);
+        values[i] = metric.get_result();
+    });
+    return values;
+}
+
 } // namespace ana
 } // namespace com
 } // namespace ql
@@ -96,6 +96,226 @@ public:
 
 };
 
+/**
+ * Precompiled form of an operand of a custom instruction in the expansion of a
+ * decomposition rule.
+ */
+struct TemplateOperand {
+
+    /**
+     * The kind of operand.
+     */
+    enum class Kind {
+
+        /**
+         * The operand is a plain reference to one of the parameters of the
+         * rule, and is to be replaced with a copy of the corresponding operand
+         * of the decomposed instruction.
+         */
+        PARAMETER,
+
+        /**
+         * The operand is a reference to one of the variables declared in the
+         * rule with only constant indices, and is to be retargeted to the
+         * corresponding temporary object made for the expansion.
+         */
+        TEMPORARY,
+
+        /**
+         * The operand does not depend on the parameters or variables of the
+         * rule, and is to be copied as is.
+         */
+        CONSTANT
+
+    };
+
+    /**
+     * The kind of operand.
+     */
+    Kind kind;
+
+    /**
+     * Index of the parameter or variable for PARAMETER and TEMPORARY operands.
+     */
+    utils::UInt index;
+
+    /**
+     * The expression to copy for TEMPORARY and CONSTANT operands.
+     */
+    ir::ExpressionRef expression;
+
+};
+
+/**
+ * Precompiled form of a statement in the expansion of a decomposition rule.
+ */
+struct TemplateStatement {
+
+    /**
+     * Whether this statement can be instantiated directly from the operand
+     * list. This is the case for custom instructions that only use operands
+     * that TemplateOperand can represent. Other statements are copied and then
+     * processed using a DecompositionRuleExpressionMapper.
+     */
+    utils::Bool direct;
+
+    /**
+     * The statement to copy. For direct statements, this is a copy of the
+     * statement in the expansion with its operand list cleared, such that
+     * copying it is cheap; otherwise it is the statement in the expansion.
+     */
+    ir::StatementRef statement;
+
+    /**
+     * The operands of direct statements.
+     */
+    utils::Vec<TemplateOperand> operands;
+
+};
+
+/**
+ * Precompiled form of a decomposition rule, attached to the
+ * InstructionDecomposition node as an annotation such that it only needs to
+ * be computed once per rule, rather than once per application.
+ */
+struct DecompositionTemplate {
+
+    /**
+     * The decomposition rule node that this template was compiled for. Used to
+     * detect stale templates when the annotation was copied along with a
+     * cloned platform tree.
+     */
+    const ir::InstructionDecomposition *rule;
+
+    /**
+     * The statements of the expansion.
+     */
+    utils::Vec<TemplateStatement> statements;
+
+    /**
+     * Whether any of the statements needs the expression mapper.
+     */
+    utils::Bool needs_mapper;
+
+};
+
+/**
+ * Returns whether the given expression refers to any of the given objects.
+ */
+static utils::Bool refers_to_any(
+    const ir::ExpressionRef &expr,
+    const utils::Map<const ir::Object*, utils::UInt> &objects
+) {
+    if (auto ref = expr->as_reference()) {
+        if (objects.find(ref->target.get_ptr().get()) != objects.end()) {
+            return true;
+        }
+        for (const auto &index : ref->indices) {
+            if (refers_to_any(index, objects)) {
+                return true;
+            }
+        }
+    } else if (auto fn = expr->as_function_call()) {
+        for (const auto &operand : fn->operands) {
+            if (refers_to_any(operand, objects)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Compiles the given decomposition rule into a template.
+ */
+static DecompositionTemplate compile_template(const ir::DecompositionRef &rule) {
+    DecompositionTemplate tmpl;
+    tmpl.rule = rule.get_ptr().get();
+    tmpl.needs_mapper = false;
+
+    // Index the parameters and variables of the rule.
+    utils::Map<const ir::Object*, utils::UInt> parameters;
+    for (utils::UInt i = 0; i < rule->parameters.size(); i++) {
+        parameters.insert({rule->parameters[i].get_ptr().get(), i});
+    }
+    utils::Map<const ir::Object*, utils::UInt> variables;
+    for (utils::UInt i = 0; i < rule->objects.size(); i++) {
+        variables.insert({rule->objects[i].get_ptr().get(), i});
+    }
+    utils::Map<const ir::Object*, utils::UInt> all = parameters;
+    all.insert(variables.begin(), variables.end());
+
+    for (const auto &stmt : rule->expansion) {
+        TemplateStatement tmpl_stmt;
+        tmpl_stmt.direct = false;
+        tmpl_stmt.statement = stmt;
+
+        // Try to express the operands of custom instructions as operand slots.
+        // Note that the condition need not be considered, because it is
+        // replaced with the condition of the decomposed instruction anyway.
+        if (auto custom = stmt->as_custom_instruction()) {
+            tmpl_stmt.direct = true;
+            for (const auto &operand : custom->operands) {
+                TemplateOperand tmpl_op;
+                tmpl_op.index = 0;
+                auto ref = operand->as_reference();
+                if (ref && ref->indices.empty() && parameters.count(ref->target.get_ptr().get())) {
+                    tmpl_op.kind = TemplateOperand::Kind::PARAMETER;
+                    tmpl_op.index = parameters.at(ref->target.get_ptr().get());
+                } else if (ref && variables.count(ref->target.get_ptr().get())) {
+                    for (const auto &index : ref->indices) {
+                        if (refers_to_any(index, all)) {
+                            tmpl_stmt.direct = false;
+                        }
+                    }
+                    tmpl_op.kind = TemplateOperand::Kind::TEMPORARY;
+                    tmpl_op.index = variables.at(ref->target.get_ptr().get());
+                    tmpl_op.expression = operand;
+                } else if (!refers_to_any(operand, all)) {
+                    tmpl_op.kind = TemplateOperand::Kind::CONSTANT;
+                    tmpl_op.expression = operand;
+                } else {
+                    tmpl_stmt.direct = false;
+                }
+                if (!tmpl_stmt.direct) {
+                    break;
+                }
+                tmpl_stmt.operands.push_back(tmpl_op);
+            }
+
+            // Make the cheap-to-copy skeleton for the instruction.
+            if (tmpl_stmt.direct) {
+                auto skeleton = stmt.clone();
+                skeleton.as<ir::CustomInstruction>()->operands.reset();
+                tmpl_stmt.statement = skeleton;
+            } else {
+                tmpl_stmt.operands.clear();
+            }
+
+        }
+
+        if (!tmpl_stmt.direct) {
+            tmpl.needs_mapper = true;
+        }
+        tmpl.statements.push_back(tmpl_stmt);
+    }
+
+    return tmpl;
+}
+
+/**
+ * Returns the template for the given decomposition rule, compiling it if this
+ * wasn't done yet.
+ */
+static const DecompositionTemplate &get_template(const ir::DecompositionRef &rule) {
+    auto tmpl = rule->get_annotation_ptr<DecompositionTemplate>();
+    if (!tmpl || tmpl->rule != rule.get_ptr().get()) {
+        rule->set_annotation<DecompositionTemplate>(compile_template(rule));
+        tmpl = rule->get_annotation_ptr<DecompositionTemplate>();
+    }
+    return *tmpl;
+}
+
 /**
  * Recursively applies all available decomposition rules (that match the
  * predicate, if given) to the given block. Sub-blocks are not considered; in
@@ -106,13 +326,20 @@ public:
  * the original statement. If ignore_schedule is not set, the schedule is copied
  * from the decomposition rule, possibly resulting in instructions being
  * reordered.
+ *
+ * Temporary objects needed by the expansions are normally added to the program
+ * directly. When temporaries is non-null, they are instead added to the given
+ * list, and it is up to the caller to move them into the program afterwards.
+ * Together with prepare_decomposition_rules(), this allows different blocks to
+ * be processed concurrently.
  * FIXME: Note that loops in decomposition rules are not handled gracefully.
  */
 utils::UInt apply_decomposition_rules(
     const ir::Ref &ir,
     const ir::BlockBaseRef &block,
     utils::Bool ignore_schedule,
-    const RulePredicate &predicate
+    const RulePredicate &predicate,
+    utils::Any<ir::VirtualObject> *temporaries
 ) {
     DEBUG("decomposing block");
 
@@ -141,35 +368,65 @@ utils::UInt apply_decomposition_rules(
                 }
 
                 DEBUG("   applying rule '" << rule->name << "'");
-                // Expression mapper for updating variable and parameter
-                // references in the expansion.
-                DecompositionRuleExpressionMapper mapper;
+                const auto &tmpl = get_template(rule);
+                QL_ASSERT(rule->parameters.size() == insn->operands.size());
 
                 // Add any variables declared in the decomposition rule as
-                // temporary objects, and remember that we have to remap them.
+                // temporary objects.
+                utils::Vec<ir::ObjectLink> rule_temporaries;
                 for (const auto &var : rule->objects) {
-                    mapper.variable_map.insert({
-                        var,
-                        make_temporary(ir, var->data_type, var->shape)
-                    });
+                    if (temporaries) {
+                        auto obj = utils::make<ir::TemporaryObject>("", var->data_type, var->shape);
+                        temporaries->add(obj);
+                        rule_temporaries.push_back(obj);
+                    } else {
+                        rule_temporaries.push_back(make_temporary(ir, var->data_type, var->shape));
+                    }
                 }
 
-                // Figure out how to map the operand placeholders.
-                QL_ASSERT(rule->parameters.size() == insn->operands.size());
-                for (utils::UInt i = 0; i < rule->parameters.size(); i++) {
-                    mapper.operand_map.insert({
-                        rule->parameters[i],
-                        insn->operands[i]
-                    });
+                // Expression mapper for updating variable and parameter
+                // references in statements of the expansion that can't be
+                // instantiated directly from the template.
+                DecompositionRuleExpressionMapper mapper;
+                if (tmpl.needs_mapper) {
+                    for (utils::UInt i = 0; i < rule->objects.size(); i++) {
+                        mapper.variable_map.insert({rule->objects[i], rule_temporaries[i]});
+                    }
+                    for (utils::UInt i = 0; i < rule->parameters.size(); i++) {
+                        mapper.operand_map.insert({
+                            rule->parameters[i],
+                            insn->operands[i]
+                        });
+                    }
                 }
 
                 // Perform the expansion.
                 auto it = remaining.begin();  // the insertion point for expanded instructions
-                for (const auto &orig_exp_stmt : rule->expansion) {
-                    auto exp_stmt = orig_exp_stmt.clone();
+                for (const auto &tmpl_stmt : tmpl.statements) {
+                    auto exp_stmt = tmpl_stmt.statement.clone();
                     DEBUG("   at insertion point: " << (it!=remaining.end() ? ir::describe(*it) : "<end>"));
-                    DEBUG("   from: '" << ir::describe(exp_stmt) << "'");
-                    mapper.process_statement(exp_stmt);
+                    if (tmpl_stmt.direct) {
+                        auto custom = exp_stmt.as<ir::CustomInstruction>();
+                        for (const auto &tmpl_op : tmpl_stmt.operands) {
+                            switch (tmpl_op.kind) {
+                                case TemplateOperand::Kind::PARAMETER:
+                                    custom->operands.add(insn->operands[tmpl_op.index].clone());
+                                    break;
+                                case TemplateOperand::Kind::TEMPORARY: {
+                                    auto operand = tmpl_op.expression.clone();
+                                    operand->as_reference()->target = rule_temporaries[tmpl_op.index];
+                                    custom->operands.add(operand);
+                                    break;
+                                }
+                                case TemplateOperand::Kind::CONSTANT:
+                                    custom->operands.add(tmpl_op.expression.clone());
+                                    break;
+                            }
+                        }
+                    } else {
+                        DEBUG("   from: '" << ir::describe(exp_stmt) << "'");
+                        mapper.process_statement(exp_stmt);
+                    }
                     if (ignore_schedule) {
                         exp_stmt->cycle = stmt->cycle;
                     } else {
@@ -213,6 +470,31 @@ utils::UInt apply_decomposition_rules(
     return number_of_applications;
 }
 
+/**
+ * Precompiles the decomposition rules of the given instruction type and its
+ * specializations.
+ */
+static void prepare_instruction_type(const utils::One<ir::InstructionType> &insn_type) {
+    for (const auto &rule : insn_type->decompositions) {
+        get_template(rule);
+    }
+    for (const auto &specialization : insn_type->specializations) {
+        prepare_instruction_type(specialization);
+    }
+}
+
+/**
+ * Precompiles all decomposition rules in the platform. This is otherwise done
+ * lazily by apply_decomposition_rules() the first time a rule is applied,
+ * which is not thread-safe. Therefore, this must be called before
+ * apply_decomposition_rules() is called for different blocks concurrently.
+ */
+void prepare_decomposition_rules(const ir::Ref &ir) {
+    for (const auto &insn_type : ir->platform->instructions) {
+        prepare_instruction_type(insn_type);
+    }
+}
+
 } // namespace dec
 } // namespace com
 } // namespace ql
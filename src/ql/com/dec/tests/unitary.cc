@@ -0,0 +1,263 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include <cmath>
+
+#include "ql/com/dec/unitary.h"
+
+namespace ql {
+namespace com {
+namespace dec {
+
+using namespace utils;
+
+/**
+ * Square matrix in row-major form, indexed as [row][column]. Qubit b of a
+ * circuit corresponds to bit b of the row and column indices.
+ */
+using Matrix = Vec<Vec<Complex>>;
+
+class UnitaryTest {
+protected:
+
+    static Matrix identity(UInt num_qubits) {
+        UInt size = 1ull << num_qubits;
+        Matrix m(size, Vec<Complex>(size, 0.0));
+        for (UInt i = 0; i < size; ++i) {
+            m[i][i] = 1.0;
+        }
+        return m;
+    }
+
+    static Matrix diagonal(const Vec<Complex> &diag) {
+        Matrix m(diag.size(), Vec<Complex>(diag.size(), 0.0));
+        for (UInt i = 0; i < diag.size(); ++i) {
+            m[i][i] = diag[i];
+        }
+        return m;
+    }
+
+    /**
+     * Applies the given single-qubit gate u = {u00, u01, u10, u11} to qubit
+     * q after the operation described by m.
+     */
+    static void applySingle(Matrix &m, UInt q, const Vec<Complex> &u) {
+        UInt bit = 1ull << q;
+        for (UInt i = 0; i < m.size(); ++i) {
+            if (i & bit) {
+                continue;
+            }
+            auto j = i | bit;
+            for (UInt col = 0; col < m.size(); ++col) {
+                auto a = m[i][col];
+                auto b = m[j][col];
+                m[i][col] = u[0] * a + u[1] * b;
+                m[j][col] = u[2] * a + u[3] * b;
+            }
+        }
+    }
+
+    static void applyRY(Matrix &m, UInt q, Real theta) {
+        Real c = std::cos(theta / 2);
+        Real s = std::sin(theta / 2);
+        applySingle(m, q, {c, -s, s, c});
+    }
+
+    static void applyRZ(Matrix &m, UInt q, Real theta) {
+        applySingle(m, q, {std::polar(1.0, -theta / 2), 0.0, 0.0, std::polar(1.0, theta / 2)});
+    }
+
+    static void applyX(Matrix &m, UInt q) {
+        applySingle(m, q, {0.0, 1.0, 1.0, 0.0});
+    }
+
+    static void applyCNot(Matrix &m, UInt control, UInt target) {
+        UInt cbit = 1ull << control;
+        UInt tbit = 1ull << target;
+        for (UInt i = 0; i < m.size(); ++i) {
+            if ((i & cbit) && !(i & tbit)) {
+                std::swap(m[i], m[i | tbit]);
+            }
+        }
+    }
+
+    /**
+     * Decomposes the given unitary, checks that the resulting circuit
+     * implements it up to global phase, and returns the circuit.
+     */
+    ir::compat::GateRefs decomposeAndCheck(const Matrix &matrix, UInt num_qubits) {
+        Vec<Complex> array;
+        for (const auto &row : matrix) {
+            array.insert(array.end(), row.begin(), row.end());
+        }
+        Vec<UInt> qubits;
+        for (UInt q = 0; q < num_qubits; ++q) {
+            qubits.push_back(q);
+        }
+        Unitary unitary{"u", array};
+        auto gates = unitary.get_decomposition(qubits);
+
+        // Rebuild the unitary from the circuit.
+        auto rebuilt = identity(num_qubits);
+        for (const auto &gate : gates) {
+            switch (gate->type()) {
+                case ir::compat::GateType::RY:
+                    applyRY(rebuilt, gate->operands[0], gate->angle);
+                    break;
+                case ir::compat::GateType::RZ:
+                    applyRZ(rebuilt, gate->operands[0], gate->angle);
+                    break;
+                case ir::compat::GateType::PAULI_X:
+                    applyX(rebuilt, gate->operands[0]);
+                    break;
+                case ir::compat::GateType::CNOT:
+                    applyCNot(rebuilt, gate->operands[0], gate->operands[1]);
+                    break;
+                default:
+                    FAIL("unexpected gate in decomposition: ", gate->name);
+            }
+        }
+
+        // Compare up to global phase, taken from the largest element.
+        UInt best_row = 0;
+        UInt best_col = 0;
+        for (UInt row = 0; row < matrix.size(); ++row) {
+            for (UInt col = 0; col < matrix.size(); ++col) {
+                if (std::abs(matrix[row][col]) > std::abs(matrix[best_row][best_col])) {
+                    best_row = row;
+                    best_col = col;
+                }
+            }
+        }
+        auto phase = rebuilt[best_row][best_col] / matrix[best_row][best_col];
+        CHECK(std::abs(std::abs(phase) - 1.0) < 1.0e-6);
+        for (UInt row = 0; row < matrix.size(); ++row) {
+            for (UInt col = 0; col < matrix.size(); ++col) {
+                INFO("Rebuilt unitary differs at row ", row, " column ", col, ".");
+                CHECK(std::abs(rebuilt[row][col] - phase * matrix[row][col]) < 1.0e-6);
+            }
+        }
+
+        return gates;
+    }
+
+    static UInt countGates(const ir::compat::GateRefs &gates, ir::compat::GateType type) {
+        UInt count = 0;
+        for (const auto &gate : gates) {
+            if (gate->type() == type) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+};
+
+TEST_CASE_FIXTURE(UnitaryTest, "Diagonal with a single phase flip") {
+
+    // Used to be mistaken for a unitary that does not affect the last qubit,
+    // and decomposed as the identity.
+    auto gates = decomposeAndCheck(diagonal({1.0, 1.0, 1.0, -1.0, 1.0, 1.0, 1.0, 1.0}), 3);
+
+    CHECK_EQ(countGates(gates, ir::compat::GateType::RY), 0);
+}
+
+TEST_CASE_FIXTURE(UnitaryTest, "Diagonal with arbitrary phases") {
+    Vec<Complex> diag;
+    for (UInt i = 0; i < 8; ++i) {
+        diag.push_back(std::polar(1.0, 0.3 + 0.7 * i * i));
+    }
+
+    auto gates = decomposeAndCheck(diagonal(diag), 3);
+
+    CHECK_EQ(countGates(gates, ir::compat::GateType::RY), 0);
+}
+
+TEST_CASE_FIXTURE(UnitaryTest, "Permutation with phases") {
+
+    // U|x> = e^(i*phi(x)) |A*x ^ m>, built from a CNOT network, X gates, and
+    // a diagonal.
+    Vec<Complex> diag;
+    for (UInt i = 0; i < 8; ++i) {
+        diag.push_back(std::polar(1.0, 1.1 * i));
+    }
+    auto matrix = diagonal(diag);
+    applyCNot(matrix, 0, 1);
+    applyCNot(matrix, 2, 0);
+    applyCNot(matrix, 1, 2);
+    applyX(matrix, 2);
+
+    auto gates = decomposeAndCheck(matrix, 3);
+
+    CHECK_EQ(countGates(gates, ir::compat::GateType::RY), 0);
+}
+
+TEST_CASE_FIXTURE(UnitaryTest, "SWAP") {
+    auto matrix = identity(2);
+    applyCNot(matrix, 0, 1);
+    applyCNot(matrix, 1, 0);
+    applyCNot(matrix, 0, 1);
+
+    auto gates = decomposeAndCheck(matrix, 2);
+
+    CHECK_EQ(countGates(gates, ir::compat::GateType::RY), 0);
+    CHECK_EQ(countGates(gates, ir::compat::GateType::RZ), 0);
+}
+
+TEST_CASE_FIXTURE(UnitaryTest, "Tensor product") {
+
+    // An entangling unitary on qubits 0 and 1, and a single-qubit unitary on
+    // qubit 2.
+    auto matrix = identity(3);
+    applyRY(matrix, 0, 0.4);
+    applyRZ(matrix, 1, 1.3);
+    applyCNot(matrix, 0, 1);
+    applyRY(matrix, 1, 2.1);
+    applyRZ(matrix, 0, -0.6);
+    applyCNot(matrix, 1, 0);
+    applyRY(matrix, 2, 0.9);
+    applyRZ(matrix, 2, 0.2);
+
+    auto gates = decomposeAndCheck(matrix, 3);
+
+    for (const auto &gate : gates) {
+        if (gate->type() == ir::compat::GateType::CNOT) {
+            INFO("CNOT between qubit 2 and the other qubits.");
+            CHECK_EQ(gate->operands[0] == 2, gate->operands[1] == 2);
+        }
+    }
+}
+
+TEST_CASE_FIXTURE(UnitaryTest, "Last qubit unaffected") {
+    auto matrix = identity(3);
+    applyRY(matrix, 1, 0.4);
+    applyRZ(matrix, 2, 1.3);
+    applyCNot(matrix, 1, 2);
+    applyRY(matrix, 2, 2.1);
+
+    auto gates = decomposeAndCheck(matrix, 3);
+
+    for (const auto &gate : gates) {
+        INFO("Gate ", gate->name, " acts on qubit 0.");
+        for (auto q : gate->operands) {
+            CHECK_NE(q, 0);
+        }
+    }
+}
+
+TEST_CASE_FIXTURE(UnitaryTest, "Generic unitary") {
+    auto matrix = identity(3);
+    for (UInt layer = 0; layer < 3; ++layer) {
+        for (UInt q = 0; q < 3; ++q) {
+            applyRY(matrix, q, 0.3 + layer + 0.5 * q);
+            applyRZ(matrix, q, 1.7 * layer - 0.2 * q);
+        }
+        applyCNot(matrix, layer % 3, (layer + 1) % 3);
+    }
+
+    decomposeAndCheck(matrix, 3);
+}
+
+} // namespace dec
+} // namespace com
+} // namespace ql
@@ -6,6 +6,8 @@
 
 #include "ql/utils/exception.h"
 #include "ql/utils/logger.h"
+#include "ql/utils/parallel.h"
+#include "ql/com/options.h"
 
 #ifndef WITHOUT_UNITARY_DECOMPOSITION
 #include <Eigen/MatrixFunctions>
@@ -16,6 +18,11 @@
 #endif
 
 #include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace ql {
 namespace com {
@@ -61,8 +68,232 @@ Bool Unitary::is_decompose_support_enabled() {
     return false;
 }
 
+/**
+ * Removes all finished decompositions from the process-wide decomposition
+ * cache, releasing the memory they use.
+ */
+void Unitary::clear_decomposition_cache() {
+}
+
 #else
 
+/**
+ * Returns the parity of the given number.
+ */
+static Int bitParity(Int i) {
+    if (i < 2 << 16) {
+        i = (i >> 16) ^ i;
+        i = (i >> 8) ^ i;
+        i = (i >> 4) ^ i;
+        i = (i >> 2) ^ i;
+        i = (i >> 1) ^ i;
+        return i % 2;
+    } else {
+        throw utils::Exception("Bit parity number too big!");
+    }
+}
+
+/**
+ * The M^k matrix for a given number of qubits, along with its factorization,
+ * used to solve for the rotation angles of multicontrolled rotations.
+ */
+struct MkTable {
+
+    /**
+     * M^k = (-1)^(b_(i-1)*g_(i-1)), where * is bitwise inner product,
+     * g = binary gray code, b = binary code.
+     */
+    Eigen::MatrixXd matrix;
+
+    /**
+     * Factorization of matrix.
+     */
+    Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> factorization;
+
+    /**
+     * Builds the table for the given number of qubits.
+     */
+    explicit MkTable(Int numberqubits) {
+        Int size = 1 << numberqubits;
+        matrix.resize(size, size);
+        for (Int i = 0; i < size; i++) {
+            for (Int j = 0; j < size; j++) {
+                matrix(i, j) = pow(-1, bitParity(i & (j ^ (j >> 1))));
+            }
+        }
+        factorization.compute(matrix);
+    }
+
+};
+
+/**
+ * Returns the M^k table for the given number of qubits. The tables only depend
+ * on the number of qubits, so they are built once and shared process-wide.
+ * The returned reference remains valid for the lifetime of the process.
+ */
+static const MkTable &get_Mk(Int numberqubits) {
+    static std::mutex mutex;
+    static std::unordered_map<Int, std::unique_ptr<const MkTable>> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &table = tables[numberqubits];
+    if (!table) {
+        table.reset(new MkTable(numberqubits));
+    }
+    return *table;
+}
+
+/**
+ * Tolerance used when checking whether an incoming matrix is unitary. Very
+ * little accuracy because of tests using printed-from-matlab code that does
+ * not have many digits after the comma.
+ */
+static const Real UNITARITY_TOLERANCE = 0.001;
+
+/**
+ * Minimum number of qubits a (sub)matrix must act on for its independent
+ * sub-decompositions to be run concurrently. Below this, the threading
+ * overhead outweighs the work.
+ */
+static const Int PARALLEL_THRESHOLD = 5;
+
+/**
+ * Absolute tolerance below which matrix elements are considered zero by the
+ * structure-analysis stage of the decomposition, and within which a matrix
+ * must match the structure it is recognized as.
+ */
+static const Real STRUCTURE_TOLERANCE = 1.0e-10;
+
+/**
+ * Least-recently-used cache of finished decompositions, such that repeated
+ * unitaries (for instance an oracle used several times in a program) are only
+ * decomposed once. Entries are looked up by a hash of the matrix and the
+ * tolerance it was checked with, and must match the matrix exactly. The cache
+ * is bounded by the memory used by the matrices and decompositions it holds,
+ * as configured by the unitary_decomposition_cache_size option.
+ */
+class DecompositionCache {
+private:
+
+    /**
+     * A cached decomposition.
+     */
+    struct Entry {
+        UInt hash;
+        UInt bytes;
+        Vec<Complex> array;
+        std::shared_ptr<const Vec<Real>> instruction_list;
+    };
+
+    /**
+     * The cached entries, most recently used first.
+     */
+    std::list<Entry> entries;
+
+    /**
+     * Index into the entries by hash.
+     */
+    std::unordered_map<UInt, std::list<Entry>::iterator> index;
+
+    /**
+     * Total number of bytes used by the cached entries.
+     */
+    UInt bytes = 0;
+
+    /**
+     * Mutex protecting the above.
+     */
+    std::mutex mutex;
+
+    /**
+     * Evicts the least recently used entries until the cache uses no more
+     * than the given number of bytes. The mutex must be held.
+     */
+    void evict(UInt max_bytes) {
+        while (bytes > max_bytes) {
+            bytes -= entries.back().bytes;
+            index.erase(entries.back().hash);
+            entries.pop_back();
+        }
+    }
+
+public:
+
+    /**
+     * Computes the cache key for the given matrix.
+     */
+    static UInt hash(const Vec<Complex> &array) {
+        std::hash<Real> hasher;
+        UInt hash = hasher(UNITARITY_TOLERANCE);
+        for (const auto &element : array) {
+            hash ^= hasher(element.real()) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            hash ^= hasher(element.imag()) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    /**
+     * Returns the cached decomposition for the given matrix, or null if there
+     * is none.
+     */
+    std::shared_ptr<const Vec<Real>> find(UInt hash, const Vec<Complex> &array) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(hash);
+        if (it == index.end() || it->second->array != array) {
+            return {};
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->instruction_list;
+    }
+
+    /**
+     * Adds a decomposition to the cache, evicting the least recently used
+     * entries until the cache uses no more than max_bytes. Decompositions
+     * that would use more than max_bytes on their own are not cached.
+     */
+    void insert(
+        UInt hash,
+        const Vec<Complex> &array,
+        const Vec<Real> &instruction_list,
+        UInt max_bytes
+    ) {
+        UInt entry_bytes = array.size() * sizeof(Complex) + instruction_list.size() * sizeof(Real);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(hash);
+        if (it != index.end()) {
+            bytes -= it->second->bytes;
+            entries.erase(it->second);
+            index.erase(it);
+        }
+        if (entry_bytes > max_bytes) {
+            evict(max_bytes);
+            return;
+        }
+        evict(max_bytes - entry_bytes);
+        entries.push_front({hash, entry_bytes, array, std::make_shared<const Vec<Real>>(instruction_list)});
+        index[hash] = entries.begin();
+        bytes += entry_bytes;
+    }
+
+    /**
+     * Removes all entries from the cache.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+        bytes = 0;
+    }
+
+};
+
+/**
+ * Returns the process-wide decomposition cache.
+ */
+static DecompositionCache &get_decomposition_cache() {
+    static DecompositionCache cache;
+    return cache;
+}
+
 // JvS: this was originally the class "unitary" itself, but compile times of
 // Eigen are so excessive that I moved it into its own compile unit and
 // provided a wrapper instead. It doesn't actually NEED to be wrapped like
@@ -80,6 +311,11 @@ public:
     Bool decomposed;
     Vec<Real> instruction_list;
 
+    /**
+     * Maximum number of threads used for the decomposition.
+     */
+    UInt num_threads = 1;
+
     typedef Eigen::Matrix<Complex, Eigen::Dynamic, Eigen::Dynamic> complex_matrix;
 
     UnitaryDecomposer() : name(""), decomposed(false) {}
@@ -126,17 +362,13 @@ public:
 
         Eigen::MatrixXcd identity = Eigen::MatrixXcd::Identity(matrix_size, matrix_size);
         Eigen::MatrixXcd matmatadjoint = (_matrix.adjoint()*_matrix);
-        // very little accuracy because of tests using printed-from-matlab code that does not have many digits after the comma
-        if (!matmatadjoint.isApprox(identity, 0.001)) {
+        if (!matmatadjoint.isApprox(identity, UNITARITY_TOLERANCE)) {
             //Throw an error
             QL_EOUT("Unitary " << name <<" is not a unitary matrix!");
 
             throw utils::Exception("Error: Unitary '"+ name+"' is not a unitary matrix. Cannot be decomposed!" + to_string(matmatadjoint));
         }
-        // initialize the general M^k lookuptable
-        genMk(numberofbits);
-
-        decomp_function(_matrix, numberofbits); //needed because the matrix is read in columnmajor
+        decomp_function(_matrix, numberofbits, instruction_list, num_threads); //needed because the matrix is read in columnmajor
 
         QL_DOUT("Done decomposing");
         decomposed = true;
@@ -152,7 +384,12 @@ public:
         return ss.str();
     }
 
-    void decomp_function(const Eigen::Ref<const complex_matrix>& matrix, Int numberofbits) {
+    void decomp_function(
+        const Eigen::Ref<const complex_matrix>& matrix,
+        Int numberofbits,
+        Vec<Real> &instruction_list,
+        UInt num_threads
+    ) {
         QL_DOUT("decomp_function: \n" << to_string(matrix));
         if(numberofbits == 1) {
             Vec<Real> zyz_angles = zyz_decomp(matrix(0,0), matrix(0,1), matrix.determinant());
@@ -161,38 +398,54 @@ public:
             instruction_list.push_back(-zyz_angles[2]);
         } else {
             Int n = matrix.rows()/2;
+            Bool parallel = num_threads > 1 && numberofbits >= PARALLEL_THRESHOLD;
 
             complex_matrix V(n,n);
             complex_matrix W(n,n);
             Eigen::VectorXcd D(n);
             // if q2 is zero, the whole thing is a demultiplexing problem instead of full CSD
-            if (matrix.bottomLeftCorner(n,n).isZero(10e-14) && matrix.topRightCorner(n,n).isZero(10e-14)) {
-                QL_DOUT("Optimization: q2 is zero, only demultiplexing will be performed.");
+            Bool q2_zero = matrix.bottomLeftCorner(n,n).isZero(10e-14) && matrix.topRightCorner(n,n).isZero(10e-14);
+            if (q2_zero && matrix.topLeftCorner(n, n).isApprox(matrix.bottomRightCorner(n,n),10e-4)) {
+                QL_DOUT("Optimization: Unitaries are equal, skip one step in the recursion for unitaries of size: " << n << " They are both: " << matrix.topLeftCorner(n, n));
                 instruction_list.push_back(200.0);
-                if (matrix.topLeftCorner(n, n).isApprox(matrix.bottomRightCorner(n,n),10e-4)) {
-                    QL_DOUT("Optimization: Unitaries are equal, skip one step in the recursion for unitaries of size: " << n << " They are both: " << matrix.topLeftCorner(n, n));
-                    instruction_list.push_back(300.0);
-                    decomp_function(matrix.topLeftCorner(n, n), numberofbits-1);
-                } else {
-                    demultiplexing(matrix.topLeftCorner(n, n), matrix.bottomRightCorner(n,n), V, D, W, numberofbits-1);
-
-                    decomp_function(W, numberofbits-1);
-                    multicontrolledZ(D, D.rows());
-                    decomp_function(V, numberofbits-1);
-                }
+                instruction_list.push_back(300.0);
+                decomp_function(matrix.topLeftCorner(n, n), numberofbits-1, instruction_list, num_threads);
             } else if (
-                // Check to see if it the kronecker product of a bigger matrix and the identity matrix.
-                // By checking if the first row is equal to the second row one over, and if thelast two rows are equal
+                // Check to see if it the kronecker product of a bigger matrix and the identity matrix,
+                // by checking that the even and odd rows/columns don't mix and that the full blocks
+                // acting on them are equal (comparing only some rows is wrong for diagonal matrices).
                 // Which means the last qubit is not affected by this gate
                 matrix(Eigen::seqN(0, n, 2), Eigen::seqN(1, n, 2)).isZero()
                 && matrix(Eigen::seqN(1, n, 2), Eigen::seqN(0, n, 2)).isZero()
-                && matrix.block(0,0,1,2*n-1) == matrix.block(1,1,1,2*n-1)
-                && matrix.block(2*n-2,0,1,2*n-1) == matrix.block(2*n-1,1,1,2*n-1)
+                && matrix(Eigen::seqN(0, n, 2), Eigen::seqN(0, n, 2)) == matrix(Eigen::seqN(1, n, 2), Eigen::seqN(1, n, 2))
             ) {
                 QL_DOUT("Optimization: last qubit is not affected, skip one step in the recursion.");
                 // Code for last qubit not affected
                 instruction_list.push_back(100.0);
-                decomp_function(matrix(Eigen::seqN(0, n, 2), Eigen::seqN(0, n, 2)), numberofbits-1);
+                decomp_function(matrix(Eigen::seqN(0, n, 2), Eigen::seqN(0, n, 2)), numberofbits-1, instruction_list, num_threads);
+            } else if (
+                // Structure-analysis stage: these classes of matrices have a
+                // direct decomposition that is much cheaper than demultiplexing
+                // or CSD, both in compile time and in number of gates.
+                decomp_permutation(matrix, numberofbits, instruction_list)
+                || decomp_tensor(matrix, numberofbits, instruction_list, num_threads)
+            ) {
+                QL_DOUT("Optimization: matrix structure recognized, skipping generic decomposition.");
+            } else if (q2_zero) {
+                QL_DOUT("Optimization: q2 is zero, only demultiplexing will be performed.");
+                instruction_list.push_back(200.0);
+                demultiplexing(matrix.topLeftCorner(n, n), matrix.bottomRightCorner(n,n), V, D, W, numberofbits-1);
+
+                if (parallel) {
+                    auto parts = decomp_independent({&W, &V}, numberofbits-1, num_threads);
+                    append(instruction_list, parts[0]);
+                    multicontrolledZ(D, D.rows(), instruction_list);
+                    append(instruction_list, parts[1]);
+                } else {
+                    decomp_function(W, numberofbits-1, instruction_list, num_threads);
+                    multicontrolledZ(D, D.rows(), instruction_list);
+                    decomp_function(V, numberofbits-1, instruction_list, num_threads);
+                }
             } else {
                 complex_matrix ss(n,n);
                 complex_matrix L0(n,n);
@@ -202,19 +455,281 @@ public:
                 // auto start = std::chrono::steady_clock::now();
                 CSD(matrix, L0, L1, R0, R1, ss);
                 // CSD_time += (std::chrono::steady_clock::now() - start);
-                demultiplexing(R0, R1, V, D, W, numberofbits-1);
-                decomp_function(W, numberofbits-1);
-                multicontrolledZ(D, D.rows());
-                decomp_function(V, numberofbits-1);
+                if (parallel) {
+
+                    // The four sub-unitaries resulting from the two
+                    // demultiplexing steps are independent, so they can be
+                    // decomposed concurrently. Their instruction lists are
+                    // merged in the same order as the sequential version.
+                    complex_matrix V2(n,n);
+                    complex_matrix W2(n,n);
+                    Eigen::VectorXcd D2(n);
+                    demultiplexing(R0, R1, V, D, W, numberofbits-1);
+                    demultiplexing(L0, L1, V2, D2, W2, numberofbits-1);
+                    auto parts = decomp_independent({&W, &V, &W2, &V2}, numberofbits-1, num_threads);
+                    append(instruction_list, parts[0]);
+                    multicontrolledZ(D, D.rows(), instruction_list);
+                    append(instruction_list, parts[1]);
+                    multicontrolledY(ss.diagonal(), n, instruction_list);
+                    append(instruction_list, parts[2]);
+                    multicontrolledZ(D2, D2.rows(), instruction_list);
+                    append(instruction_list, parts[3]);
+
+                } else {
+                    demultiplexing(R0, R1, V, D, W, numberofbits-1);
+                    decomp_function(W, numberofbits-1, instruction_list, num_threads);
+                    multicontrolledZ(D, D.rows(), instruction_list);
+                    decomp_function(V, numberofbits-1, instruction_list, num_threads);
+
+                    multicontrolledY(ss.diagonal(), n, instruction_list);
+
+                    demultiplexing(L0, L1, V, D, W, numberofbits-1);
+                    decomp_function(W, numberofbits-1, instruction_list, num_threads);
+                    multicontrolledZ(D, D.rows(), instruction_list);
+                    decomp_function(V, numberofbits-1, instruction_list, num_threads);
+                }
+            }
+        }
+    }
+
+    /**
+     * Structure check for matrices that map every basis state to a single
+     * basis state with some phase, i.e. U|x> = e^(i*phi(x))|A*x ^ m>, where A
+     * is an invertible matrix over GF(2) and m is a bit mask. This covers
+     * diagonal (phase) unitaries, X gates, and CNOT/SWAP networks, and any
+     * combination thereof. Such a unitary is encoded directly as a diagonal,
+     * followed by the CNOTs that realize A, followed by X gates for m. Returns
+     * false without touching the instruction list if the matrix does not have
+     * this structure.
+     *
+     * Encoding: 400, flag indicating whether the diagonal is more than a
+     * global phase, the diagonal (see diagonal()) if so, the number of CNOTs,
+     * the control and target qubit index of each CNOT, and the X mask.
+     */
+    Bool decomp_permutation(
+        const Eigen::Ref<const complex_matrix> &matrix,
+        Int numberofbits,
+        Vec<Real> &instruction_list
+    ) {
+        Int size = matrix.rows();
+
+        // Find the single nonzero element of each column. Most matrices that
+        // don't have this structure are rejected by the first column.
+        Vec<UInt> perm(size);
+        Eigen::VectorXcd phases(size);
+        for (Int j = 0; j < size; j++) {
+            Bool found = false;
+            for (Int i = 0; i < size; i++) {
+                if (abs(matrix(i, j)) < STRUCTURE_TOLERANCE) {
+                    continue;
+                }
+                if (found) {
+                    return false;
+                }
+                found = true;
+                perm[j] = i;
+                phases[j] = matrix(i, j);
+            }
+            if (!found) {
+                return false;
+            }
+        }
+
+        // Check that the permutation is affine. The image of zero gives the
+        // mask, the images of the unit vectors give the columns of A.
+        UInt mask = perm[0];
+        Vec<UInt> columns(numberofbits);
+        for (Int b = 0; b < numberofbits; b++) {
+            columns[b] = perm[1ull << b] ^ mask;
+        }
+        for (Int x = 0; x < size; x++) {
+            UInt y = mask;
+            for (Int b = 0; b < numberofbits; b++) {
+                if ((x >> b) & 1) {
+                    y ^= columns[b];
+                }
+            }
+            if (y != perm[x]) {
+                QL_DOUT("Matrix is a permutation, but not an affine one.");
+                return false;
+            }
+        }
+
+        // Reduce A to the identity using Gauss-Jordan elimination, where
+        // adding row c to row t corresponds to CNOT(c, t). A is then the
+        // product of these CNOTs in reverse order of elimination.
+        Vec<UInt> rows(numberofbits, 0);
+        for (Int c = 0; c < numberofbits; c++) {
+            for (Int t = 0; t < numberofbits; t++) {
+                if ((columns[c] >> t) & 1) {
+                    rows[t] |= 1ull << c;
+                }
+            }
+        }
+        Vec<std::pair<Int, Int>> cnots;
+        for (Int p = 0; p < numberofbits; p++) {
+            if (!((rows[p] >> p) & 1)) {
+                Int r = p + 1;
+                while (r < numberofbits && !((rows[r] >> p) & 1)) {
+                    r++;
+                }
+                if (r == numberofbits) {
+                    return false;
+                }
+                rows[p] ^= rows[r];
+                cnots.emplace_back(r, p);
+            }
+            for (Int r = 0; r < numberofbits; r++) {
+                if (r != p && ((rows[r] >> p) & 1)) {
+                    rows[r] ^= rows[p];
+                    cnots.emplace_back(p, r);
+                }
+            }
+        }
+
+        QL_DOUT("Optimization: matrix is an affine permutation with phases, using " << cnots.size() << " CNOTs.");
+        instruction_list.push_back(400.0);
+        if ((phases / phases[0]).isApproxToConstant(1.0, STRUCTURE_TOLERANCE)) {
+            instruction_list.push_back(0.0);
+        } else {
+            instruction_list.push_back(1.0);
+            diagonal(phases, instruction_list);
+        }
+        instruction_list.push_back(cnots.size());
+        for (auto it = cnots.rbegin(); it != cnots.rend(); ++it) {
+            instruction_list.push_back(it->first);
+            instruction_list.push_back(it->second);
+        }
+        instruction_list.push_back(mask);
+        return true;
+    }
 
-                multicontrolledY(ss.diagonal(), n);
+    /**
+     * Encodes the diagonal unitary with the given (unit-modulus) diagonal,
+     * up to global phase. This is the same recursion as the demultiplexing
+     * step, but because everything is diagonal, the phases of the two halves
+     * can be split into a common part and a multicontrolled Z rotation
+     * directly.
+     *
+     * Encoding: for one qubit, a single RZ angle. Otherwise, the diagonal for
+     * all but the most significant qubit, followed by the multicontrolled Z
+     * rotation angles.
+     */
+    void diagonal(const Eigen::Ref<const Eigen::VectorXcd> &d, Vec<Real> &instruction_list) {
+        Int n = d.rows() / 2;
+        if (n == 1) {
+            instruction_list.push_back(arg(d[1]) - arg(d[0]));
+            return;
+        }
+        Eigen::VectorXcd W(n);
+        Eigen::VectorXcd D(n);
+        for (Int k = 0; k < n; k++) {
+            Real a = arg(d[k]);
+            Real b = arg(d[k + n]);
+            W[k] = std::polar(1.0, 0.5 * (a + b));
+            D[k] = std::polar(1.0, 0.5 * (a - b));
+        }
+        diagonal(W, instruction_list);
+        multicontrolledZ(D, n, instruction_list);
+    }
+
+    /**
+     * Structure check for matrices that are the tensor product of a unitary
+     * on the k least significant qubits and a unitary on the remaining
+     * qubits, for the smallest k for which this holds. The two factors are
+     * then decomposed independently. Splits where one of the factors is the
+     * identity are left to the generic decomposition, which already skips
+     * unaffected qubits more cheaply. Returns false without touching the
+     * instruction list if the matrix is not separable.
+     *
+     * Encoding: 500, k, the decomposition of the low factor, and the
+     * decomposition of the high factor.
+     */
+    Bool decomp_tensor(
+        const Eigen::Ref<const complex_matrix> &matrix,
+        Int numberofbits,
+        Vec<Real> &instruction_list,
+        UInt num_threads
+    ) {
+        Int size = matrix.rows();
+
+        // If the matrix is separable, its largest element is the product of
+        // two nonzero elements of the factors, which can thus be recovered by
+        // dividing by it.
+        Eigen::Index pivot_row, pivot_col;
+        matrix.cwiseAbs().maxCoeff(&pivot_row, &pivot_col);
+        for (Int k = 1; k < numberofbits; k++) {
+            Int lsize = 1ll << k;
+            Int hsize = size >> k;
+            complex_matrix lo = matrix.block(pivot_row / lsize * lsize, pivot_col / lsize * lsize, lsize, lsize);
+            complex_matrix hi = matrix(
+                Eigen::seqN(pivot_row % lsize, hsize, lsize),
+                Eigen::seqN(pivot_col % lsize, hsize, lsize)
+            ) / matrix(pivot_row, pivot_col);
+
+            Bool separable = true;
+            for (Int j = 0; j < size && separable; j++) {
+                for (Int i = 0; i < size && separable; i++) {
+                    separable = abs(
+                        matrix(i, j) - hi(i / lsize, j / lsize) * lo(i % lsize, j % lsize)
+                    ) < STRUCTURE_TOLERANCE;
+                }
+            }
+            if (!separable) {
+                continue;
+            }
 
-                demultiplexing(L0, L1, V, D, W, numberofbits-1);
-                decomp_function(W, numberofbits-1);
-                multicontrolledZ(D, D.rows());
-                decomp_function(V, numberofbits-1);
+            // Distribute the magnitude such that both factors are unitary.
+            Real scale = lo.col(0).norm();
+            lo /= scale;
+            hi *= scale;
+            if (is_phased_identity(lo) || is_phased_identity(hi)) {
+                return false;
             }
+
+            QL_DOUT("Optimization: matrix is the tensor product of unitaries on " << numberofbits - k << " and " << k << " qubits.");
+            instruction_list.push_back(500.0);
+            instruction_list.push_back(k);
+            decomp_function(lo, k, instruction_list, num_threads);
+            decomp_function(hi, numberofbits - k, instruction_list, num_threads);
+            return true;
         }
+        return false;
+    }
+
+    /**
+     * Returns whether the given matrix is the identity matrix up to global
+     * phase.
+     */
+    static Bool is_phased_identity(const complex_matrix &matrix) {
+        complex_matrix identity = complex_matrix::Identity(matrix.rows(), matrix.cols());
+        return (matrix - matrix(0, 0) * identity).cwiseAbs().maxCoeff() < STRUCTURE_TOLERANCE;
+    }
+
+    /**
+     * Decomposes the given independent matrices concurrently, dividing the
+     * available threads over them, and returns their instruction lists in the
+     * same order as the matrices.
+     */
+    std::vector<Vec<Real>> decomp_independent(
+        const std::vector<const complex_matrix*> &matrices,
+        Int numberofbits,
+        UInt num_threads
+    ) {
+        std::vector<Vec<Real>> parts(matrices.size());
+        UInt child_threads = max<UInt>(1, num_threads / matrices.size());
+        parallel_for(matrices.size(), num_threads, [&](UInt i) {
+            decomp_function(*matrices[i], numberofbits, parts[i], child_threads);
+        });
+        return parts;
+    }
+
+    /**
+     * Appends an instruction list produced by decomp_independent() to the
+     * given list.
+     */
+    static void append(Vec<Real> &instruction_list, const Vec<Real> &part) {
+        instruction_list.insert(instruction_list.end(), part.begin(), part.end());
     }
 
     void CSD(
@@ -412,25 +927,6 @@ public:
 
     }
 
-    Vec<Eigen::MatrixXd> genMk_lookuptable;
-
-    // returns M^k = (-1)^(b_(i-1)*g_(i-1)), where * is bitwise inner product, g = binary gray code, b = binary code.
-    void genMk(Int numberqubits) {
-        // Int numberqubits = uint64_log2(_matrix.rows());
-        for (Int n = 1; n <= numberqubits; n++) {
-            Int size=1<<n;
-            Eigen::MatrixXd Mk(size,size);
-            for (Int i = 0; i < size; i++) {
-                for (Int j = 0; j < size ;j++) {
-                    Mk(i,j) = pow(-1, bitParity(i&(j^(j>>1))));
-                }
-            }
-            genMk_lookuptable.push_back(Mk);
-        }
-
-        // return genMk_lookuptable[numberqubits-1];
-    }
-
     // source: https://stackoverflow.com/questions/994593/how-to-do-an-integer-log2-in-c user Todd Lehman
     Int uint64_log2(uint64_t n) {
 #define S(k) if (n >= (UINT64_C(1) << k)) { i += k; n >>= k; }
@@ -438,42 +934,29 @@ public:
 #undef S
     }
 
-    Int bitParity(Int i) {
-        if (i < 2 << 16) {
-            i = (i >> 16) ^ i;
-            i = (i >> 8) ^ i;
-            i = (i >> 4) ^ i;
-            i = (i >> 2) ^ i;
-            i = (i >> 1) ^ i;
-            return i % 2;
-        } else {
-            throw utils::Exception("Bit parity number too big!");
-        }
-    }
-
-    void multicontrolledY(const Eigen::Ref<const Eigen::VectorXcd> &ss, Int halfthesizeofthematrix) {
+    void multicontrolledY(const Eigen::Ref<const Eigen::VectorXcd> &ss, Int halfthesizeofthematrix, Vec<Real> &instruction_list) {
         Eigen::VectorXd temp =  2*Eigen::asin(ss.array()).real();
-        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]);
-        Eigen::VectorXd tr = dec.solve(temp);
+        const auto &Mk = get_Mk(uint64_log2(halfthesizeofthematrix));
+        Eigen::VectorXd tr = Mk.factorization.solve(temp);
         // Check is very approximate to account for low-precision input matrices
-        if (!temp.isApprox(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]*tr, 10e-2)) {
+        if (!temp.isApprox(Mk.matrix*tr, 10e-2)) {
             QL_EOUT("Multicontrolled Y not correct!");
             throw utils::Exception("Demultiplexing of unitary '"+ name+"' not correct! Failed at demultiplexing of matrix ss: \n"  + to_string(ss));
         }
 
-        instruction_list.insert(instruction_list.end(), &tr[0], &tr[halfthesizeofthematrix]);
+        instruction_list.insert(instruction_list.end(), tr.data(), tr.data() + halfthesizeofthematrix);
     }
 
-    void multicontrolledZ(const Eigen::Ref<const Eigen::VectorXcd> &D, Int halfthesizeofthematrix) {
+    void multicontrolledZ(const Eigen::Ref<const Eigen::VectorXcd> &D, Int halfthesizeofthematrix, Vec<Real> &instruction_list) {
         Eigen::VectorXd temp =  (Complex(0,-2)*Eigen::log(D.array())).real();
-        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]);
-        Eigen::VectorXd tr = dec.solve(temp);
+        const auto &Mk = get_Mk(uint64_log2(halfthesizeofthematrix));
+        Eigen::VectorXd tr = Mk.factorization.solve(temp);
         // Check is very approximate to account for low-precision input matrices
-        if (!temp.isApprox(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]*tr, 10e-2)) {
+        if (!temp.isApprox(Mk.matrix*tr, 10e-2)) {
             QL_EOUT("Multicontrolled Z not correct!");
             throw utils::Exception("Demultiplexing of unitary '"+ name+"' not correct! Failed at demultiplexing of matrix D: \n"+ to_string(D));
         }
-        instruction_list.insert(instruction_list.end(), &tr[0], &tr[halfthesizeofthematrix]);
+        instruction_list.insert(instruction_list.end(), tr.data(), tr.data() + halfthesizeofthematrix);
     }
 
     ~UnitaryDecomposer() {
@@ -490,10 +973,33 @@ void Unitary::decompose() {
     if (decomposed) {
         return;
     }
+    auto &cache = get_decomposition_cache();
+    auto hash = DecompositionCache::hash(array);
+    if (auto cached = cache.find(hash, array)) {
+        QL_DOUT("using cached decomposition for unitary: " << name);
+        instruction_list = *cached;
+        decomposed = true;
+        return;
+    }
     UnitaryDecomposer decomposer(name, array);
+    decomposer.num_threads = get_num_threads(
+        com::options::current()["unitary_decomposition_threads"].as_uint()
+    );
     decomposer.decompose();
     decomposed = decomposer.decomposed;
     instruction_list = decomposer.instruction_list;
+    cache.insert(
+        hash, array, instruction_list,
+        com::options::current()["unitary_decomposition_cache_size"].as_uint() << 20
+    );
+}
+
+/**
+ * Removes all finished decompositions from the process-wide decomposition
+ * cache, releasing the memory they use.
+ */
+void Unitary::clear_decomposition_cache() {
+    get_decomposition_cache().clear();
 }
 
 /**
@@ -555,6 +1061,27 @@ static void multicontrolled_ry(
     c.emplace<ir::compat::gate_types::CNot>(qubits.end()[-2], qubits.back());
 }
 
+//diagonal unitary, see UnitaryDecomposer::diagonal()
+static Int diagonalRelationsForUnitaryDecomposition(
+    ir::compat::GateRefs &c,
+    const Vec<Real> &insns,
+    const Vec<UInt> &qubits,
+    UInt n,
+    UInt i
+) {
+    if (n == 1) {
+        c.emplace<ir::compat::gate_types::RZ>(qubits.back(), insns[i]);
+        return 1;
+    }
+    Vec<UInt> subvector(qubits.begin(), qubits.end() - 1);
+    UInt numberforcontrolledrotation = pow2(n - 1);
+    UInt start_counter = i;
+    start_counter += diagonalRelationsForUnitaryDecomposition(c, insns, subvector, n - 1, start_counter);
+    multicontrolled_rz(c, insns, start_counter, start_counter + numberforcontrolledrotation - 1, qubits);
+    start_counter += numberforcontrolledrotation;
+    return start_counter - i;
+}
+
 //recursive gate count function
 //n is number of qubits
 //i is the start point for the instructionlist
@@ -597,6 +1124,36 @@ static Int recursiveRelationsForUnitaryDecomposition(
                 start_counter += recursiveRelationsForUnitaryDecomposition(c, insns, subvector, n - 1, start_counter);
                 return start_counter - i;
             }
+        } else if (insns[i] == 400.0) {
+            QL_DOUT("[kernel.h] Optimization: affine permutation with phases. New start_index: " << i + 1);
+            UInt start_counter = i + 1;
+            if (insns[start_counter++] != 0.0) {
+                start_counter += diagonalRelationsForUnitaryDecomposition(c, insns, qubits, n, start_counter);
+            }
+            UInt numberofcnots = insns[start_counter++];
+            for (UInt k = 0; k < numberofcnots; k++) {
+                c.emplace<ir::compat::gate_types::CNot>(
+                    qubits[(UInt)insns[start_counter]],
+                    qubits[(UInt)insns[start_counter + 1]]
+                );
+                start_counter += 2;
+            }
+            UInt mask = insns[start_counter++];
+            for (UInt b = 0; b < n; b++) {
+                if ((mask >> b) & 1) {
+                    c.emplace<ir::compat::gate_types::PauliX>(qubits[b]);
+                }
+            }
+            return start_counter - i;
+        } else if (insns[i] == 500.0) {
+            UInt k = insns[i + 1];
+            QL_DOUT("[kernel.h] Optimization: tensor product, splitting off the lowest " << k << " qubits. New start_index: " << i + 2);
+            Vec<UInt> low(qubits.begin(), qubits.begin() + k);
+            Vec<UInt> high(qubits.begin() + k, qubits.end());
+            UInt start_counter = i + 2;
+            start_counter += recursiveRelationsForUnitaryDecomposition(c, insns, low, k, start_counter);
+            start_counter += recursiveRelationsForUnitaryDecomposition(c, insns, high, n - k, start_counter);
+            return start_counter - i;
         } else {
             // The new qubit vector that is passed to the recursive function
             Vec<UInt> subvector(qubits.begin(), qubits.end() - 1);
@@ -676,7 +1233,6 @@ ir::compat::GateRefs Unitary::prepare_state(const utils::Vec<utils::UInt> &qubit
     if (nqubits > 1){
         UInt start_i = phi.size() - 3;
         UInt ngates;
-        decomposer.genMk(qubits.size());
         Eigen::VectorXd temp;
         Eigen::VectorXd tr;
         UInt idx;
@@ -684,7 +1240,7 @@ ir::compat::GateRefs Unitary::prepare_state(const utils::Vec<utils::UInt> &qubit
         {
             ngates = 1 << i;
             QL_DOUT("Sending indices " << start_i << " until " << (start_i + ngates) << " to multicontrolled z and y. i=" << i);
-            Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec(decomposer.genMk_lookuptable[i - 1]);
+            const auto &dec = get_Mk(i).factorization;
             temp = Eigen::Map<Eigen::VectorXd>(theta.data() + start_i, ngates);
             tr = dec.solve(temp);
 
@@ -24,7 +24,9 @@ Options make_ql_options() {
 
     options.add_enum(
         "log_level",
-        "Log levels",
+        "Log levels. For the global options record, changing this changes the "
+        "process-wide log level immediately. For other records, it is applied "
+        "to the threads they are made current for, see Scope.",
         "LOG_NOTHING",
         {
             "LOG_NOTHING",
@@ -34,7 +36,67 @@ Options make_ql_options() {
             "LOG_INFO",
             "LOG_DEBUG"
         }
-    ).with_callback([](Option &x){logger::set_log_level(x.as_str());});
+    );
+
+    options.add_str(
+        "log_file",
+        "File that log messages are written to. When empty, messages are "
+        "written to stdout, or to stderr for warnings and errors. This is a "
+        "process-wide setting; it only has an effect for the global options.",
+        ""
+    );
+
+    options.add_enum(
+        "log_buffering",
+        "Controls how log messages are written. When `no`, messages are "
+        "written by the thread that logs them. Otherwise, each thread appends "
+        "its messages to a ring buffer, which is written to the log by a "
+        "background thread. This keeps verbose logging from slowing down the "
+        "compiler as much, at the cost of messages appearing slightly later. "
+        "When the buffer of a thread is full, `block` makes the thread wait "
+        "for the writer, while `drop` discards the message (the number of "
+        "discarded messages is logged). This is a process-wide setting; it "
+        "only has an effect for the global options.",
+        "no",
+        {"no", "block", "drop"}
+    );
+
+    options.add_int(
+        "log_buffer_size",
+        "The number of messages each thread can buffer when log_buffering is "
+        "enabled.",
+        "65536",
+        1, utils::MAX
+    );
+
+    options.add_bool(
+        "profile_passes",
+        "When set, the pass manager records the wall-clock time, CPU time, "
+        "memory usage, and program size before and after each pass, as well "
+        "as the time spent converting to and from the legacy IR for legacy "
+        "passes. The results are written to "
+        "`<output_dir>/<program>_pass_profile.json` as a report, and to "
+        "`<output_dir>/<program>_pass_trace.json` in the trace-event format "
+        "understood by Chrome's about:tracing and Perfetto."
+    );
+
+    options.add_bool(
+        "pass_cache",
+        "When set, passes that support it store their result for each block "
+        "in a process-wide in-memory cache, keyed on the contents of the "
+        "input block, the pass type and options, and the platform. When the "
+        "same block is encountered again, for instance when recompiling a "
+        "program after changing only some of its kernels, the cached result "
+        "is used instead of running the pass again."
+    );
+
+    options.add_int(
+        "pass_cache_size",
+        "The maximum number of block results stored in the pass cache. When "
+        "the cache is full, the oldest entries are evicted first.",
+        "1024",
+        1, utils::MAX
+    );
 
     //========================================================================//
     // Kernel/gate and other global behavior not related to passes            //
@@ -78,6 +140,29 @@ Options make_ql_options() {
         "only used when %N is used in the `output_prefix` common pass option."
     );
 
+    options.add_int(
+        "unitary_decomposition_threads",
+        "The maximum number of threads used to decompose a single unitary "
+        "gate. The independent sub-problems of the recursive decomposition "
+        "of unitaries acting on five or more qubits are then handled "
+        "concurrently; the result does not depend on this setting. 0 means "
+        "that the number of hardware threads is used.",
+        "1",
+        0, utils::MAX
+    );
+
+    options.add_int(
+        "unitary_decomposition_cache_size",
+        "The maximum amount of memory in MiB used to cache finished unitary "
+        "decompositions, such that unitaries that occur more than once are "
+        "only decomposed once. When the cache is full, the least recently "
+        "used decompositions are evicted first. Unitaries whose matrix and "
+        "decomposition do not fit in the cache by themselves are not cached. "
+        "0 disables the cache.",
+        "64",
+        0, 1024 * 1024
+    );
+
     //========================================================================//
     // Default pass order                                                     //
     //========================================================================//
@@ -436,17 +521,76 @@ Options make_ql_options() {
     return options;
 }
 
+/**
+ * Applies the log_buffering and log_buffer_size options of the global options
+ * record to the logger.
+ */
+static void update_log_buffering() {
+    auto mode = global["log_buffering"].as_str();
+    auto policy = logger::BufferPolicy::SYNCHRONOUS;
+    if (mode == "block") {
+        policy = logger::BufferPolicy::BLOCK;
+    } else if (mode == "drop") {
+        policy = logger::BufferPolicy::DROP;
+    }
+    logger::set_buffer_policy(policy, global["log_buffer_size"].as_uint());
+}
+
+/**
+ * Makes the global options record, which unlike other records controls the
+ * process-wide log level and log output.
+ */
+static Options make_global_options() {
+    auto options = make_ql_options();
+    options["log_level"].with_callback([](Option &x){logger::set_log_level(x.as_str());});
+    options["log_file"].with_callback([](Option &x){logger::set_sink(x.as_str());});
+    options["log_buffering"].with_callback([](Option&){update_log_buffering();});
+    options["log_buffer_size"].with_callback([](Option&){update_log_buffering();});
+    return options;
+}
+
 /**
  * Global options object for all of OpenQL.
  */
-Options global = make_ql_options();
+Options global = make_global_options();
+
+/**
+ * Returns the options record that applies to the calling thread. This is the
+ * record made current by the innermost Scope on this thread (or on the thread
+ * that spawned it through utils::parallel_for()), or global if there is none.
+ */
+const Options &current() {
+    auto options = Options::get_thread_current();
+    return options ? *options : global;
+}
+
+/**
+ * Makes the given options record current for the calling thread while in
+ * scope, including the log level it specifies.
+ */
+Scope::Scope(const Options &options) :
+    previous_options(Options::get_thread_current()),
+    previous_log_level(logger::get_thread_log_level())
+{
+    Options::set_thread_current(&options);
+    logger::set_thread_log_level(logger::log_level_from_string(options["log_level"].as_str()));
+}
+
+/**
+ * Restores the options record and log level that were current before this
+ * scope was constructed.
+ */
+Scope::~Scope() {
+    Options::set_thread_current(previous_options);
+    logger::set_thread_log_level(previous_log_level);
+}
 
 /**
- * Convenience function for getting an option value as a string from the global
- * options record.
+ * Convenience function for getting an option value as a string from the
+ * options record that applies to the calling thread, see current().
  */
 const Str &get(const Str &key) {
-    return global[key].as_str();
+    return current()[key].as_str();
 }
 
 /**
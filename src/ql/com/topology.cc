@@ -428,40 +428,25 @@ Topology::Topology(utils::UInt num_qubits, const utils::Json &topology) {
             }
         }
 
-        // Compute distances between all qubits using Floyd-Warshall. When not
-        // connected, distance remains set to utils::MAX.
+        // Compute distances between all qubits using a breadth-first search
+        // from each qubit, which scales much better than Floyd-Warshall for
+        // the sparse connectivity of real topologies. When not connected,
+        // distance remains set to utils::MAX.
         distance.resize(num_qubits);
+        utils::Vec<utils::UInt> queue(num_qubits);
         for (utils::UInt i = 0; i < num_qubits; i++) {
-
-            // Initialize all distances to maximum value...
-            distance[i].resize(num_qubits, utils::MAX);
-
-            // ... except the self-edge, which is 0 distance...
-            distance[i][i] = 0;
-
-            // ... and the neighbors, which get distance 1.
-            for (utils::UInt j : neighbors.get(i)) {
-                distance[i][j] = 1;
-            }
-
-        }
-
-        // Find shorter distances by gradually including more qubits (k) in path
-        for (utils::UInt k = 0; k < num_qubits; k++) {
-            for (utils::UInt i = 0; i < num_qubits; i++) {
-                for (utils::UInt j = 0; j < num_qubits; j++) {
-
-                    // Prevent overflow in the sum below by explicitly checking for
-                    // MAX.
-                    if (distance[i][k] == utils::MAX) {
-                        continue;
-                    }
-                    if (distance[k][j] == utils::MAX) {
-                        continue;
-                    }
-
-                    if (distance[i][j] > distance[i][k] + distance[k][j]) {
-                        distance[i][j] = distance[i][k] + distance[k][j];
+            auto &from_i = distance[i];
+            from_i.resize(num_qubits, utils::MAX);
+            from_i[i] = 0;
+            utils::UInt head = 0;
+            utils::UInt tail = 0;
+            queue[tail++] = i;
+            while (head < tail) {
+                auto k = queue[head++];
+                for (utils::UInt j : neighbors.get(k)) {
+                    if (from_i[j] == utils::MAX) {
+                        from_i[j] = from_i[k] + 1;
+                        queue[tail++] = j;
                     }
                 }
             }
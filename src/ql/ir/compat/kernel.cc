@@ -54,7 +54,9 @@ Kernel::Kernel(
     type(KernelType::STATIC),
     iteration_count(1),
     cycles_valid(true),
-    condition(ConditionType::ALWAYS)
+    condition(ConditionType::ALWAYS),
+    use_default_gates(com::options::current()["use_default_gates"].as_bool()),
+    decompose_toffoli(com::options::current()["decompose_toffoli"].as_str())
 {
     if (qubit_count > platform->qubit_count) {
         QL_USER_ERROR(
@@ -691,7 +693,7 @@ Bool Kernel::add_spec_decomposed_gate_if_available(
             // when found, custom_added is true, and the expanded subinstruction was added to the circuit
             Bool custom_added = add_custom_gate_if_available(sub_ins_name, this_gate_qubits, cregs, 0, 0.0, bregs, gcond, gcondregs);
             if (!custom_added) {
-                if (com::options::get("use_default_gates") == "yes") {
+                if (use_default_gates) {
                     // default gate check
                     QL_DOUT("adding default gate for " << sub_ins_name);
                     Bool default_available = add_default_gate_if_available(sub_ins_name, this_gate_qubits, cregs, 0, 0.0, bregs, gcond, gcondregs);
@@ -791,7 +793,7 @@ Bool Kernel::add_param_decomposed_gate_if_available(
             // when found, custom_added is true, and the expanded subinstruction was added to the circuit
             Bool custom_added = add_custom_gate_if_available(sub_ins_name, this_gate_qubits, cregs, 0, 0.0, bregs, gcond, gcondregs);
             if (!custom_added) {
-                if (com::options::get("use_default_gates") == "yes") {
+                if (use_default_gates) {
                     // default gate check
                     QL_DOUT("adding default gate for " << sub_ins_name);
                     Bool default_available = add_default_gate_if_available(sub_ins_name, this_gate_qubits, cregs, 0, 0.0, bregs, gcond, gcondregs);
@@ -1026,7 +1028,7 @@ Bool Kernel::gate_nonfatal(
                 added = true;
                 QL_DOUT("custom gate added for " << gname_lower);
             } else {
-                if (com::options::get("use_default_gates") == "yes") {
+                if (use_default_gates) {
                     // default gate check (which is always parameterized)
                     QL_DOUT("adding default gate for " << gname_lower);
 
@@ -1448,7 +1450,7 @@ void Kernel::controlled_single(
             UInt cq2 = control_qubit;
             UInt tq = goperands[1];
 
-            auto opt = com::options::get("decompose_toffoli");
+            const auto &opt = decompose_toffoli;
             if (opt == "AM") {
                 controlled_cnot_AM(tq, cq1, cq2);
             } else if (opt == "NC") {
@@ -795,6 +795,21 @@ PlatformRef Platform::build(
     return ref;
 }
 
+/**
+ * Returns a copy of this platform, including copies of the gates in the
+ * instruction map, that can be used independently of the original.
+ */
+PlatformRef Platform::copy() const {
+    PlatformRef ref;
+    ref.set(std::shared_ptr<Platform>(new Platform(*this)));
+    for (auto &it : ref->instruction_map) {
+        CustomGateRef gate;
+        gate.emplace<gate_types::Custom>(*it.second);
+        it.second = gate;
+    }
+    return ref;
+}
+
 /**
  * Dumps some basic info about the platform to the given stream.
  */
@@ -23,7 +23,7 @@ using namespace utils;
 utils::Str make_unique_name(const utils::Str &name) {
 
     // Don't uniquify if the unique_output option is not set.
-    if (!com::options::global["unique_output"].as_bool()) {
+    if (!com::options::current()["unique_output"].as_bool()) {
         return name;
     }
 
@@ -4,6 +4,7 @@
 
 #include "ql/ir/cqasm/read.h"
 
+#include <cstdio>
 #include "ql/utils/filesystem.h"
 #include "ql/ir/compat/program.h"
 #include "ql/ir/ops.h"
@@ -1114,44 +1115,70 @@ static ir::compat::PlatformRef load_platform(const cq::parser::ParseResult &pres
 }
 
 /**
- * Reads a cQASM 1.2 file into the IR. If reading is successful, ir->program is
- * completely replaced. data represents the cQASM file contents, fname specifies
- * the filename if one exists for the purpose of generating better error
- * messages.
+ * Annotation placed on the platform node to cache the cQASM analyzer that was
+ * configured for it. Configuring an analyzer means registering typecasts for
+ * all data types and functions for all registers and builtin functions of the
+ * platform, which dominates the time needed to read small cQASM files (such as
+ * decomposition rules) when done for every file.
  */
-void read(
-    const Ref &ir,
-    const utils::Str &data,
-    const utils::Str &fname,
-    const ReadOptions &options
-) {
+struct CachedAnalyzer {
 
-    // Start by parsing the file without analysis.
-    auto pres = cq::parser::parse_string(data, fname);
-    if (!pres.errors.empty()) {
-        utils::StrStrm errors;
-        errors << "failed to parse " << fname << " for the following reasons:";
-        for (const auto &error : pres.errors) {
-            QL_EOUT(error);
-            errors << "\n  " << error;
+    /**
+     * Revision of the platform that the analyzer was configured for, as
+     * computed by get_platform_revision().
+     */
+    utils::UInt revision;
+
+    /**
+     * The configured analyzer.
+     */
+    std::shared_ptr<const cq::analyzer::Analyzer> analyzer;
+
+};
+
+/**
+ * Computes a revision number for the parts of the platform that affect the
+ * configuration of the cQASM analyzer, i.e. the node identities of the
+ * platform, its data types, objects, and functions, and the shape of the main
+ * qubit register. This is cheap compared to configuring an analyzer, and
+ * changes whenever any of these things are added, removed, or replaced (for
+ * instance when the platform is cloned).
+ */
+static utils::UInt get_platform_revision(const PlatformRef &platform) {
+    std::hash<const void*> ptr_hash;
+    utils::UInt revision = ptr_hash(platform.get_ptr().get());
+    auto mix = [&revision](utils::UInt value) {
+        revision ^= value + 0x9E3779B97F4A7C15ull + (revision << 6) + (revision >> 2);
+    };
+    for (const auto &dt : platform->data_types) {
+        mix(ptr_hash(dt.get_ptr().get()));
+    }
+    for (const auto &obj : platform->objects) {
+        mix(ptr_hash(obj.get_ptr().get()));
+        for (auto size : obj->shape) {
+            mix(size);
         }
-        QL_USER_ERROR(errors.str());
     }
-
-    // If the load_platform option was passed to us, look for the
-    // `pragma @ql.platform(...)` annotation in the AST and build the platform
-    // from it, before even building the analyzer, because we need said platform
-    // to correctly build the analyzer.
-    if (options.load_platform) {
-        ir->platform = ir::convert_old_to_new(load_platform(pres))->platform;
+    for (const auto &fun : platform->functions) {
+        mix(ptr_hash(fun.get_ptr().get()));
     }
+    mix(ptr_hash(platform->default_bit_type.get_ptr().get()));
+    return revision;
+}
+
+/**
+ * Builds a cQASM analyzer for the given platform.
+ */
+static std::shared_ptr<const cq::analyzer::Analyzer> build_analyzer(
+    const PlatformRef &platform
+) {
 
     // Create an analyzer for files with a version up to cQASM 1.2.
-    cq::analyzer::Analyzer a{"1.2"};
+    auto a = std::make_shared<cq::analyzer::Analyzer>("1.2");
 
     // Add the default constant-propagation functions and mappings such as true
     // and false.
-    a.register_default_functions_and_mappings();
+    a->register_default_functions_and_mappings();
 
     // Add typecast functions that explicitly cast cQASM's types to OpenQL's
     // types by attaching a type annotation to the incoming value. Without this
@@ -1160,8 +1187,8 @@ void read(
     // there is only one integer type in the platform, but when there are
     // different types, for example different register sizes, these typecast
     // will be needed.
-    for (const auto &dt : ir->platform->data_types) {
-        a.register_function(
+    for (const auto &dt : platform->data_types) {
+        a->register_function(
             dt->name,
             {make_cq_type(dt)},
             [dt](const cqv::Values &ops) -> cqv::Value {
@@ -1171,19 +1198,22 @@ void read(
         );
     }
 
-    // Also allow qubits to be "cast" to their implicit measurement bit.
-    a.register_function(
-        ir->platform->default_bit_type->name,
-        {make_cq_type(ir->platform->qubits->data_type)},
-        [ir](const cqv::Values &ops) -> cqv::Value {
+    // Also allow qubits to be "cast" to their implicit measurement bit. Note
+    // that we capture a link to the bit type rather than the platform itself,
+    // as the analyzer is stored in an annotation on the platform node.
+    DataTypeLink bit_type = platform->default_bit_type;
+    a->register_function(
+        platform->default_bit_type->name,
+        {make_cq_type(platform->qubits->data_type)},
+        [bit_type](const cqv::Values &ops) -> cqv::Value {
             if (auto qrefs = ops[0]->as_qubit_refs()) {
                 auto brefs = cqt::make<cqv::BitRefs>();
                 brefs->index = qrefs->index;
-                brefs->set_annotation<DataTypeLink>(ir->platform->default_bit_type);
+                brefs->set_annotation<DataTypeLink>(bit_type);
                 return std::move(brefs);
             } else if (auto fun = ops[0]->as_function()) {
-                fun->return_type = make_cq_type(ir->platform->default_bit_type);
-                ops[0]->set_annotation<DataTypeLink>(ir->platform->default_bit_type);
+                fun->return_type = make_cq_type(bit_type);
+                ops[0]->set_annotation<DataTypeLink>(bit_type);
                 return ops[0];
             } else {
                 throw cqe::AnalysisError("unexpected argument type");
@@ -1192,8 +1222,8 @@ void read(
     );
 
     // Add registers as default mappings and builtin function calls.
-    for (const auto &obj : ir->platform->objects) {
-        if (ir->platform->qubits.links_to(obj)) {
+    for (const auto &obj : platform->objects) {
+        if (platform->qubits.links_to(obj)) {
 
             // Predefine the q and b registers as well. These will be overridden
             // to the same thing (possibly with a different size) if the cQASM
@@ -1208,8 +1238,8 @@ void read(
                 q->index.add(cqt::make<cqv::ConstInt>(i));
                 b->index.add(cqt::make<cqv::ConstInt>(i));
             }
-            a.register_mapping("q", q);
-            a.register_mapping("b", b);
+            a->register_mapping("q", q);
+            a->register_mapping("b", b);
 
         } else {
 
@@ -1221,30 +1251,19 @@ void read(
             for (utils::UInt i = 0; i < obj->shape.size(); i++) {
                 types.emplace<cqty::Int>();
             }
-            a.register_function(obj->name, types, [obj](const cqv::Values &ops) -> cqv::Value {
+            a->register_function(obj->name, types, [obj](const cqv::Values &ops) -> cqv::Value {
                 return make_cq_register_ref(obj, ops);
             });
 
             // For scalar registers, define a mapping to that function with the
             // () added to it, so you don't have to specify ().
             if (obj->shape.empty()) {
-                a.register_mapping(obj->name, make_cq_register_ref(obj, {}));
+                a->register_mapping(obj->name, make_cq_register_ref(obj, {}));
             }
 
         }
     }
 
-    // Create the op(int) -> ... function for the operand list, if specified.
-    // NB: this is to support new style instruction decomposition, where op(n) refers
-    // to the actual operands of an instruction.
-    if (!options.operands.empty()) {
-        cqty::Types types;
-        types.emplace<cqty::Int>();
-        a.register_function("op", types, [options](const cqv::Values &ops) -> cqv::Value {
-            return make_cq_operand_ref(options.operands, ops[0]);
-        });
-    }
-
     // Add regular builtin functions.
     // NOTE: any builtin function that shares a prototype with a default
     // constant-propagation function from libqasm is overridden. That means that
@@ -1255,12 +1274,12 @@ void read(
     // won't work anymore.
     // Note: these functions are added using calls to 'add_function_type()' in
     // 'Ref convert_old_to_new(const compat::PlatformRef &old)'
-    for (const auto &fun : ir->platform->functions) {
+    for (const auto &fun : platform->functions) {
         cqty::Types cq_types;
         for (const auto &ql_op_type : fun->operand_types) {
             cq_types.add(make_cq_op_type(ql_op_type));
         }
-        a.register_function(fun->name, cq_types, [fun](const cqv::Values &ops) -> cqv::Value {
+        a->register_function(fun->name, cq_types, [fun](const cqv::Values &ops) -> cqv::Value {
             cqv::Value cq_val = cqt::make<cqv::Function>(
                 fun->name,
                 ops,
@@ -1272,11 +1291,121 @@ void read(
         });
     }
 
+    return a;
+}
+
+/**
+ * Returns the cQASM analyzer for the given platform, reusing the one cached in
+ * the platform node if it was built for the current revision of the platform.
+ */
+static std::shared_ptr<const cq::analyzer::Analyzer> get_analyzer(
+    const PlatformRef &platform
+) {
+    auto revision = get_platform_revision(platform);
+    if (auto cached = platform->get_annotation_ptr<CachedAnalyzer>()) {
+        if (cached->revision == revision) {
+            return cached->analyzer;
+        }
+    }
+    QL_DOUT("building cQASM analyzer for platform revision " << revision);
+    auto analyzer = build_analyzer(platform);
+    platform->set_annotation<CachedAnalyzer>({revision, analyzer});
+    return analyzer;
+}
+
+/**
+ * Throws an appropriate exception if the given parse result contains errors.
+ */
+static void check_parse_result(
+    const cq::parser::ParseResult &pres,
+    const utils::Str &fname
+) {
+    if (!pres.errors.empty()) {
+        utils::StrStrm errors;
+        errors << "failed to parse " << fname << " for the following reasons:";
+        for (const auto &error : pres.errors) {
+            QL_EOUT(error);
+            errors << "\n  " << error;
+        }
+        QL_USER_ERROR(errors.str());
+    }
+}
+
+/**
+ * Parses the given cQASM file without analyzing it. The file is handed to
+ * libqasm's parser as a stream, such that its contents don't need to be
+ * loaded into memory as a whole before the AST is built. Relative paths are
+ * treated as relative to the current OpenQL working directory.
+ */
+static cq::parser::ParseResult parse_file(const utils::Str &fname) {
+    auto path = utils::path_relative_to(utils::get_working_directory(), fname);
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file) {
+        QL_SYSTEM_ERROR("failed to open file \"" << fname << "\" for reading");
+    }
+    cq::parser::ParseResult pres;
+    try {
+        pres = cq::parser::parse_file(file, fname);
+    } catch (...) {
+        fclose(file);
+        throw;
+    }
+    fclose(file);
+    check_parse_result(pres, fname);
+    return pres;
+}
+
+/**
+ * Reads a parsed cQASM 1.2 file into the IR. This takes ownership of the parse
+ * result, such that the AST can be released as soon as it has been analyzed.
+ * See read() for more information.
+ */
+static void read_parsed(
+    const Ref &ir,
+    cq::parser::ParseResult &&pres,
+    const utils::Str &fname,
+    const ReadOptions &options
+) {
+
+    // If the load_platform option was passed to us, look for the
+    // `pragma @ql.platform(...)` annotation in the AST and build the platform
+    // from it, before even building the analyzer, because we need said platform
+    // to correctly build the analyzer.
+    if (options.load_platform) {
+        ir->platform = ir::convert_old_to_new(load_platform(pres))->platform;
+    }
+
+    // Fetch the analyzer configured for this platform, building it if it
+    // doesn't exist yet or if the platform changed since it was built.
+    auto analyzer = get_analyzer(ir->platform);
+
     // Analyze the file. Note that we didn't add any instruction or error model
     // types, which disables libqasm's resolver. This lets us completely ignore
     // error models, and handle instruction resolution ourselves using our own
     // type system.
-    auto res = a.analyze(pres);
+    cq::analyzer::AnalysisResult res;
+    if (options.operands.empty()) {
+        res = analyzer->analyze(pres);
+    } else {
+
+        // The op(int) -> ... function for the operand list depends on the read
+        // options, so it can't be part of the cached analyzer. Register it on a
+        // copy instead.
+        // NB: this is to support new style instruction decomposition, where
+        // op(n) refers to the actual operands of an instruction.
+        cq::analyzer::Analyzer a{*analyzer};
+        cqty::Types types;
+        types.emplace<cqty::Int>();
+        a.register_function("op", types, [options](const cqv::Values &ops) -> cqv::Value {
+            return make_cq_operand_ref(options.operands, ops[0]);
+        });
+        res = a.analyze(pres);
+
+    }
+
+    // We don't need the AST anymore now that we have the semantic tree, so
+    // release it before building the OpenQL tree to reduce peak memory usage.
+    pres = cq::parser::ParseResult();
     if (!res.errors.empty()) {
         utils::StrStrm errors;
         errors << "failed to analyze " << fname << " for the following reasons:";
@@ -1496,6 +1625,14 @@ void read(
                 // Make sure no unused @ql.* annotations remain.
                 check_all_annotations_used(cq_program->subcircuits.back());
 
+                // The body of the subcircuit has been fully lowered now, and
+                // nothing refers to it anymore (goto instructions and block
+                // annotations refer to the subcircuit node itself), so release
+                // it early to reduce peak memory usage for large files.
+                if (cq_subc.get_ptr() != cq_program->subcircuits.back().get_ptr()) {
+                    cq_subc->body.reset();
+                }
+
             }
 
         }
@@ -1514,17 +1651,41 @@ void read(
 
 }
 
+/**
+ * Reads a cQASM 1.2 file into the IR. If reading is successful, ir->program is
+ * completely replaced. data represents the cQASM file contents, fname specifies
+ * the filename if one exists for the purpose of generating better error
+ * messages.
+ */
+void read(
+    const Ref &ir,
+    const utils::Str &data,
+    const utils::Str &fname,
+    const ReadOptions &options
+) {
+
+    // Start by parsing the file without analysis.
+    auto pres = cq::parser::parse_string(data, fname);
+    check_parse_result(pres, fname);
+
+    // Convert the parse result.
+    read_parsed(ir, std::move(pres), fname, options);
+
+}
+
 /**
  * Same as read(), but given a file to load, rather than loading from a string.
+ * The file is parsed directly from disk, rather than loading it into a string
+ * first, so the raw text of the file never has to be in memory as a whole.
  */
 void read_file(
     const Ref &ir,
     const utils::Str &fname,
     const ReadOptions &options
 ) {
-    auto data = utils::InFile(fname).read();
+    auto pres = parse_file(fname);
     auto wd = utils::WithWorkingDirectory(utils::dir_name(fname));
-    read(ir, data, fname, options);
+    read_parsed(ir, std::move(pres), fname, options);
 }
 
 /**
@@ -1538,15 +1699,7 @@ ir::compat::PlatformRef read_platform(
 
     // Read the file without analyzing it.
     auto pres = cq::parser::parse_string(data, fname);
-    if (!pres.errors.empty()) {
-        utils::StrStrm errors;
-        errors << "failed to parse " << fname << " for the following reasons:";
-        for (const auto &error : pres.errors) {
-            QL_EOUT(error);
-            errors << "\n  " << error;
-        }
-        QL_USER_ERROR(errors.str());
-    }
+    check_parse_result(pres, fname);
 
     return load_platform(pres);
 }
@@ -1556,9 +1709,9 @@ ir::compat::PlatformRef read_platform(
  * string.
  */
 ir::compat::PlatformRef read_platform_from_file(const utils::Str &fname) {
-    auto data = utils::InFile(fname).read();
+    auto pres = parse_file(fname);
     auto wd = utils::WithWorkingDirectory(utils::dir_name(fname));
-    return read_platform(data, fname);
+    return load_platform(pres);
 }
 
 } // namespace cqasm
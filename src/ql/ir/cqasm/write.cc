@@ -5,6 +5,8 @@
 #include "ql/ir/cqasm/write.h"
 
 #include "ql/version.h"
+#include "ql/utils/filesystem.h"
+#include "ql/utils/parallel.h"
 #include "ql/ir/ops.h"
 #include "ql/ir/describe.h"
 #include "ql/ir/operator_info.h"
@@ -66,14 +68,9 @@ protected:
      * behavior!
      */
     std::string sl(utils::Int indent_delta = 0) {
-        utils::StrStrm ss;
         indent += indent_delta;
         if (indent < 0) indent = 0;
-        auto indent_remain = indent;
-        while (indent_remain-- > 0) {
-            ss << "    ";
-        }
-        return ss.str();
+        return std::string(4 * indent, ' ');
     }
 
     /**
@@ -85,13 +82,14 @@ protected:
      * behavior!
      */
     std::string el(utils::UInt blank = 0, utils::Int indent_delta = 0) {
-        utils::StrStrm ss;
+        std::string s;
         indent += indent_delta;
         if (indent < 0) indent = 0;
         do {
-            ss << "\n" << line_prefix;
+            s += "\n";
+            s += line_prefix;
         } while (blank--);
-        return ss.str();
+        return s;
     }
 
     /**
@@ -104,6 +102,33 @@ protected:
      */
     utils::Map<const void*, utils::Str> unique_names;
 
+    /**
+     * The writer that this writer was derived from to format a single block
+     * concurrently with other blocks, or nullptr for toplevel writers. The
+     * names and unique_names of the parent are treated as read-only extensions
+     * of our own.
+     */
+    const Writer *parent = nullptr;
+
+    /**
+     * Returns whether the given name is already in use or reserved.
+     */
+    utils::Bool is_name_taken(const utils::Str &name) const {
+        if (names.find(name) != names.end()) return true;
+        return parent && parent->is_name_taken(name);
+    }
+
+    /**
+     * Looks up the uniquified name for the given node, returning nullptr if
+     * there is none yet.
+     */
+    const utils::Str *find_unique_name(const void *key) const {
+        auto it = unique_names.find(key);
+        if (it != unique_names.end()) return &it->second;
+        if (parent) return parent->find_unique_name(key);
+        return nullptr;
+    }
+
     /**
      * Generates a unique, valid identifier for the given node based on the
      * given desired name. Calling this multiple times for the same non-empty
@@ -118,9 +143,8 @@ protected:
         // See if we've uniquified the name for this node before.
         const void *key = node.get_ptr().get();
         if (key != nullptr) {
-            auto it = unique_names.find(key);
-            if (it != unique_names.end()) {
-                return it->second;
+            if (auto existing = find_unique_name(key)) {
+                return *existing;
             }
         }
 
@@ -129,9 +153,10 @@ protected:
         if (!std::regex_match(name, IDENTIFIER_RE)) name = "_" + name;
         auto unique_name = name;
         utils::UInt unique_idx = 1;
-        while (!names.insert(unique_name).second) {
+        while (is_name_taken(unique_name)) {
             unique_name = name + "_" + utils::to_string(unique_idx++);
         }
+        names.insert(unique_name);
         QL_ASSERT(std::regex_match(unique_name, IDENTIFIER_RE));
 
         // Store the uniquified name in the map.
@@ -192,6 +217,24 @@ public:
         })
     {}
 
+    /**
+     * Constructs a writer that formats a part of the output of the given
+     * parent writer into a different stream, starting at the parent's current
+     * indentation level. The parent must outlive this writer and must not be
+     * modified while this writer exists.
+     */
+    Writer(
+        const Writer &parent,
+        std::ostream &os
+    ) :
+        ir(parent.ir),
+        os(os),
+        line_prefix(parent.line_prefix),
+        options(parent.options),
+        indent(parent.indent),
+        parent(&parent)
+    {}
+
     /**
      * Fallback function.
      */
@@ -430,61 +473,119 @@ public:
 
         // Print the blocks.
         utils::Str exit_name;
-        for (utils::UInt idx = 0; idx < node.blocks.size(); idx++) {
-            const auto &block = node.blocks[idx];
+        auto num_threads = utils::get_num_threads(options.num_threads);
+        if (num_threads > 1 && node.blocks.size() > 1) {
+            print_blocks_parallel(node, exit_name, num_threads);
+        } else {
+            for (utils::UInt idx = 0; idx < node.blocks.size(); idx++) {
+                print_block(node, idx, exit_name);
+            }
+        }
 
-            // Write the block header.
-            auto name = uniquify(block, block->name);
+        // Print the exit label if needed.
+        if (!exit_name.empty()) {
             os << el();
-            os << sl(-1) << "." << name;
-            if (options.include_metadata && name != block->name) {
-                os << " @ql.name(\"" << block->name << "\")";
+            os << sl(-1) << "." << exit_name;
+            if (options.include_metadata) {
+                os << " @ql.exit()";
             }
-            os << el(0, 1);
+            os << el();
+        }
 
-            // Write the statements.
-            block->visit(*this);
+    }
+
+    /**
+     * Prints the block at the given index of the given program, including its
+     * header, the goto statement to its successor if needed, and its
+     * statistics if requested. exit_name is the name of the exit label; if
+     * empty and the block needs it, it is generated.
+     */
+    void print_block(Program &node, utils::UInt idx, utils::Str &exit_name) {
+        const auto &block = node.blocks[idx];
+
+        // Write the block header.
+        auto name = uniquify(block, block->name);
+        os << el();
+        os << sl(-1) << "." << name;
+        if (options.include_metadata && name != block->name) {
+            os << " @ql.name(\"" << block->name << "\")";
+        }
+        os << el(0, 1);
+
+        // Write the statements.
+        block->visit(*this);
 
-            // Write the goto statement for the next block if needed.
-            if (block->next.empty() && idx != node.blocks.size() - 1) {
+        // Write the goto statement for the next block if needed.
+        if (block->next.empty() && idx != node.blocks.size() - 1) {
+            if (!version_at_least({1, 2})) {
+                QL_USER_ERROR("control-flow is not supported until cQASM 1.2");
+            }
+            if (exit_name.empty()) {
+                exit_name = uniquify("exit");
+            }
+            os << sl() << "goto " << exit_name << el();
+        } else {
+            utils::Link<Block> seq_next;
+            if (idx < node.blocks.size() - 1) {
+                seq_next = node.blocks[idx + 1];
+            }
+            if (block->next != seq_next) {
                 if (!version_at_least({1, 2})) {
                     QL_USER_ERROR("control-flow is not supported until cQASM 1.2");
                 }
-                if (exit_name.empty()) {
-                    exit_name = uniquify("exit");
-                }
-                os << sl() << "goto " << exit_name << el();
-            } else {
-                utils::Link<Block> seq_next;
-                if (idx < node.blocks.size() - 1) {
-                    seq_next = node.blocks[idx + 1];
-                }
-                if (block->next != seq_next) {
-                    if (!version_at_least({1, 2})) {
-                        QL_USER_ERROR("control-flow is not supported until cQASM 1.2");
-                    }
-                    os << sl() << "goto " << uniquify(block->next.as_mut(), block->next->name) << el();
-                }
+                os << sl() << "goto " << uniquify(block->next.as_mut(), block->next->name) << el();
             }
-
-            // Print block-wide statistics as comments at the end if requested.
-            if (options.include_statistics) {
-                os << el();
-                pass::ana::statistics::report::dump(ir, block, os, line_prefix + "    # ");
-            }
-
         }
 
-        // Print the exit label if needed.
-        if (!exit_name.empty()) {
+        // Print block-wide statistics as comments at the end if requested.
+        if (options.include_statistics) {
             os << el();
-            os << sl(-1) << "." << exit_name;
-            if (options.include_metadata) {
-                os << " @ql.exit()";
+            pass::ana::statistics::report::dump(ir, block, os, line_prefix + "    # ");
+        }
+
+    }
+
+    /**
+     * Prints all blocks of the given program using multiple threads. To keep
+     * memory usage bounded, the blocks are formatted in windows of a few
+     * blocks per thread; each block in a window is formatted into its own
+     * buffer by a derived writer, after which the buffers are written to the
+     * output stream in program order and discarded. To make the derived
+     * writers independent of each other, the names of all blocks and of the
+     * exit label (if needed) are uniquified up front.
+     */
+    void print_blocks_parallel(
+        Program &node,
+        utils::Str &exit_name,
+        utils::UInt num_threads
+    ) {
+        for (utils::UInt idx = 0; idx < node.blocks.size(); idx++) {
+            const auto &block = node.blocks[idx];
+            uniquify(block, block->name);
+            if (exit_name.empty() && block->next.empty() && idx != node.blocks.size() - 1) {
+                if (!version_at_least({1, 2})) {
+                    QL_USER_ERROR("control-flow is not supported until cQASM 1.2");
+                }
+                exit_name = uniquify("exit");
             }
-            os << el();
         }
 
+        const utils::UInt window = 4 * num_threads;
+        for (utils::UInt start = 0; start < node.blocks.size(); start += window) {
+            auto count = utils::min(window, node.blocks.size() - start);
+            std::vector<utils::Str> sections(count);
+            utils::parallel_for(count, num_threads, [&](utils::UInt i) {
+                utils::StrStrm ss;
+                Writer w{*this, ss};
+                w.print_block(node, start + i, exit_name);
+                sections[i] = ss.str();
+            });
+            for (auto &section : sections) {
+                os << section;
+                section.clear();
+                section.shrink_to_fit();
+            }
+        }
     }
 
     /**
@@ -1147,6 +1248,21 @@ void write(
     node->visit(w);
 }
 
+/**
+ * Writes a cQASM representation of the IR to the given file, using a large
+ * write buffer. The file is written incrementally, so memory usage does not
+ * depend on the size of the generated file.
+ */
+void write_file(
+    const Ref &ir,
+    const utils::Str &fname,
+    const WriteOptions &options
+) {
+    utils::OutFile file{fname, WRITE_BUFFER_SIZE};
+    write(ir, options, file.unwrap());
+    file.close();
+}
+
 /**
  * Shorthand for getting a cQASM string representation of the given node.
  */
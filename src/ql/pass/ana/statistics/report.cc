@@ -15,28 +15,61 @@ namespace statistics {
 namespace report {
 
 /**
- * Dumps basic statistics for the given kernel to the given output stream.
+ * Dumps the given basic metrics for a block to the given output stream,
+ * followed by any additional statistics attached to the block.
  */
-void dump(
-    const ir::Ref &ir,
+static void dump_values(
     const ir::BlockRef &block,
+    const com::ana::BasicMetricValues &values,
     std::ostream &os,
     const utils::Str &line_prefix
 ) {
-    using namespace com::ana;
-
-    os << line_prefix << "Duration (assuming no control-flow): " << compute_block<Latency>(ir, block) << "\n";
-    os << line_prefix << "Number of quantum gates: " << compute_block<QuantumGateCount>(ir, block) << "\n";
-    os << line_prefix << "Number of multi-qubit gates: " << compute_block<MultiQubitGateCount>(ir, block) << "\n";
-    os << line_prefix << "Number of classical operations: " << compute_block<ClassicalOperationCount>(ir, block) << "\n";
-    os << line_prefix << "Number of qubits used: " << compute_block<QubitUsageCount>(ir, block).sparse_size() << "\n";
-    os << line_prefix << "Qubit cycles use (assuming no control-flow): " << compute_block<QubitUsedCycleCount>(ir, block) << "\n";
+    os << line_prefix << "Duration (assuming no control-flow): " << values.latency << "\n";
+    os << line_prefix << "Number of quantum gates: " << values.quantum_gate_count << "\n";
+    os << line_prefix << "Number of multi-qubit gates: " << values.multi_qubit_gate_count << "\n";
+    os << line_prefix << "Number of classical operations: " << values.classical_operation_count << "\n";
+    os << line_prefix << "Number of qubits used: " << values.qubit_usage_count.sparse_size() << "\n";
+    os << line_prefix << "Qubit cycles use (assuming no control-flow): " << values.qubit_used_cycle_count << "\n";
     for (const auto &line : AdditionalStats::pop(block)) {
         os << line_prefix << "----- " << line << "\n";
     }
     os.flush();
 }
 
+/**
+ * Dumps the given basic metrics for a program to the given output stream,
+ * followed by any additional statistics attached to the program.
+ */
+static void dump_values(
+    const ir::ProgramRef &program,
+    const com::ana::BasicMetricValues &values,
+    std::ostream &os,
+    const utils::Str &line_prefix
+) {
+    os << line_prefix << "Total duration (assuming no control-flow): " << values.latency << "\n";
+    os << line_prefix << "Total number of quantum gates: " << values.quantum_gate_count << "\n";
+    os << line_prefix << "Total number of multi-qubit gates: " << values.multi_qubit_gate_count << "\n";
+    os << line_prefix << "Total number of classical operations: " << values.classical_operation_count << "\n";
+    os << line_prefix << "Number of qubits used: " << values.qubit_usage_count.sparse_size() << "\n";
+    os << line_prefix << "Qubit cycles use (assuming no control-flow): " << values.qubit_used_cycle_count << "\n";
+    for (const auto &line : AdditionalStats::pop(program)) {
+        os << line_prefix << line << "\n";
+    }
+    os.flush();
+}
+
+/**
+ * Dumps basic statistics for the given kernel to the given output stream.
+ */
+void dump(
+    const ir::Ref &ir,
+    const ir::BlockRef &block,
+    std::ostream &os,
+    const utils::Str &line_prefix
+) {
+    dump_values(block, com::ana::compute_block<com::ana::BasicMetrics>(ir, block), os, line_prefix);
+}
+
 /**
  * Dumps basic statistics for the given program to the given output stream. This
  * only dumps the global statistics, not the statistics for each individual
@@ -48,39 +81,37 @@ void dump(
     std::ostream &os,
     const utils::Str &line_prefix
 ) {
-    using namespace com::ana;
-
-    os << line_prefix << "Total duration (assuming no control-flow): " << compute_program<Latency>(ir) << "\n";
-    os << line_prefix << "Total number of quantum gates: " << compute_program<QuantumGateCount>(ir) << "\n";
-    os << line_prefix << "Total number of multi-qubit gates: " << compute_program<MultiQubitGateCount>(ir) << "\n";
-    os << line_prefix << "Total number of classical operations: " << compute_program<ClassicalOperationCount>(ir) << "\n";
-    os << line_prefix << "Number of qubits used: " << compute_program<QubitUsageCount>(ir).sparse_size() << "\n";
-    os << line_prefix << "Qubit cycles use (assuming no control-flow): " << compute_program<QubitUsedCycleCount>(ir) << "\n";
-    for (const auto &line : AdditionalStats::pop(program)) {
-        os << line_prefix << line << "\n";
-    }
-    os.flush();
+    dump_values(program, com::ana::compute_program<com::ana::BasicMetrics>(ir), os, line_prefix);
 }
 
 /**
  * Dumps statistics for the given program and its kernels to the given output
- * stream.
+ * stream. The metrics are computed once for each block, using up to
+ * num_threads threads, and the global statistics are derived from the
+ * per-block results.
  */
 void dump_all(
     const ir::Ref &ir,
     std::ostream &os,
-    const utils::Str &line_prefix
+    const utils::Str &line_prefix,
+    utils::UInt num_threads
 ) {
     if (ir->program.empty()) {
         os << line_prefix << "no program node to dump statistics for" << std::endl;
     } else {
-        for (const auto &block : ir->program->blocks) {
+        auto values = com::ana::compute_basic_metrics_per_block(
+            ir, com::ana::BasicMetrics::ALL, num_threads
+        );
+        com::ana::BasicMetricValues totals;
+        for (utils::UInt i = 0; i < values.size(); i++) {
+            const auto &block = ir->program->blocks[i];
             os << line_prefix << "For block with name \"" << block->name << "\":\n";
-            dump(ir, block, os, line_prefix + "    ");
+            dump_values(block, values[i], os, line_prefix + "    ");
             os << "\n";
+            totals.merge(values[i]);
         }
         os << line_prefix << "Global statistics:\n";
-        dump(ir, ir->program, os, line_prefix);
+        dump_values(ir->program, totals, os, line_prefix);
     }
 }
 
@@ -98,6 +129,11 @@ void ReportStatisticsPass::dump_docs(
     report file. Some passes may also attach additional pass-specific statistics
     to the program and kernels, in which case these are printed and subsequently
     discarded as well.
+
+    All statistics of a block are computed in a single traversal of the block,
+    and the global statistics are derived from those of the blocks, so the IR
+    is only traversed once. The num_threads option allows the blocks to be
+    processed concurrently as well.
     )");
 }
 
@@ -127,6 +163,14 @@ ReportStatisticsPass::ReportStatisticsPass(
         "use this option to emulate that behavior.",
         ""
     );
+    options.add_int(
+        "num_threads",
+        "The number of threads to use for computing the statistics of the "
+        "blocks of the program. When not 1, the statistics of different "
+        "blocks are computed concurrently. 0 means one thread per hardware "
+        "thread.",
+        "1", 0, utils::MAX
+    );
 }
 
 /**
@@ -138,7 +182,10 @@ utils::Int ReportStatisticsPass::run(
 ) const {
     auto line_prefix = options["line_prefix"].as_str();
     auto filename = context.output_prefix + options["output_suffix"].as_str();
-    dump_all(ir, utils::OutFile(filename).unwrap(), line_prefix);
+    dump_all(
+        ir, utils::OutFile(filename).unwrap(), line_prefix,
+        options["num_threads"].as_uint()
+    );
     return 0;
 }
 
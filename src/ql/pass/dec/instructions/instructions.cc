@@ -4,6 +4,7 @@
 
 #include "ql/pass/dec/instructions/instructions.h"
 
+#include "ql/utils/parallel.h"
 #include "ql/ir/old_to_new.h"
 #include "ql/pmgr/pass_types/base.h"
 #include "ql/pmgr/factory.h"
@@ -132,6 +133,11 @@ void DecomposeInstructionsPass::dump_docs(
     decomposition would be expanding a CZ gate to single-qubit flux and parking
     gates; it's vital that these gates will not be shifted around with respect
     to each other, which scheduling after decomposing them might do.
+
+    For large programs with many blocks, the `num_threads` option can be used
+    to decompose the blocks concurrently. The result is identical to the
+    single-threaded result; temporary objects introduced by the expansions are
+    added to the program in block order after all blocks have been processed.
     )");
 }
 
@@ -181,6 +187,13 @@ DecomposeInstructionsPass::DecomposeInstructionsPass(
         "yes"
     );
 
+    options.add_int(
+        "num_threads",
+        "The number of threads used to decompose the blocks of the program "
+        "concurrently. 0 means that the number of hardware threads is used.",
+        "1", 0, utils::MAX
+    );
+
 }
 
 /**
@@ -190,12 +203,13 @@ utils::UInt DecomposeInstructionsPass::run_on_block(
     const ir::Ref &ir,
     const ir::BlockBaseRef &block,
     utils::Bool ignore_schedule,
-    const com::dec::RulePredicate &predicate
+    const com::dec::RulePredicate &predicate,
+    utils::Any<ir::VirtualObject> *temporaries
 ) {
 
     // Apply the decomposition rules.
     auto number_of_applications = com::dec::apply_decomposition_rules(
-        ir, block, ignore_schedule, predicate
+        ir, block, ignore_schedule, predicate, temporaries
     );
 
     // Remove the KernelCyclesValid annotation if we broke the schedule for
@@ -208,13 +222,13 @@ utils::UInt DecomposeInstructionsPass::run_on_block(
     for (const auto &statement : block->statements) {
         if (auto if_else = statement->as_if_else()) {
             for (const auto &branch : if_else->branches) {
-                number_of_applications += run_on_block(ir, branch->body, ignore_schedule, predicate);
+                number_of_applications += run_on_block(ir, branch->body, ignore_schedule, predicate, temporaries);
             }
             if (!if_else->otherwise.empty()) {
-                number_of_applications += run_on_block(ir, if_else->otherwise, ignore_schedule, predicate);
+                number_of_applications += run_on_block(ir, if_else->otherwise, ignore_schedule, predicate, temporaries);
             }
         } else if (auto loop = statement->as_loop()) {
-            number_of_applications += run_on_block(ir, loop->body, ignore_schedule, predicate);
+            number_of_applications += run_on_block(ir, loop->body, ignore_schedule, predicate, temporaries);
         }
     }
 
@@ -233,6 +247,7 @@ utils::Int DecomposeInstructionsPass::run(
     auto ignore_schedule = options["ignore_schedule"].as_bool();
     auto predicate_key = options["predicate_key"].as_str();
     auto predicate_value = options["predicate_value"].as_str();
+    auto num_threads = utils::get_num_threads(options["num_threads"].as_uint());
 
     // Construct the predicate function.
     auto predicate = [predicate_key, predicate_value](const ir::DecompositionRef &rule) {
@@ -250,10 +265,39 @@ utils::Int DecomposeInstructionsPass::run(
 
     // Process the decomposition rules for the whole program.
     utils::UInt number_of_applications = 0;
-    if (!ir->program.empty()) {
-        for (const auto &block : ir->program->blocks) {
+    if (ir->program.empty()) {
+        return 0;
+    }
+    const auto &blocks = ir->program->blocks;
+    if (num_threads > 1 && blocks.size() > 1) {
+
+        // Compile the rules up front, so the worker threads only ever read
+        // from the platform. Each block gets its own list of temporaries,
+        // which are added to the program in block order afterwards, such that
+        // the result does not depend on the order in which the blocks finish.
+        com::dec::prepare_decomposition_rules(ir);
+        std::vector<utils::Any<ir::VirtualObject>> temporaries(blocks.size());
+        std::vector<utils::UInt> counts(blocks.size(), 0);
+        utils::parallel_for(blocks.size(), num_threads, [&](utils::UInt i) {
+            const auto &block = blocks[i];
+            try {
+                counts[i] = run_on_block(ir, block, ignore_schedule, predicate, &temporaries[i]);
+            } catch (utils::Exception &e) {
+                e.add_context("in block " + block->name);
+                throw;
+            }
+        });
+        for (utils::UInt i = 0; i < blocks.size(); i++) {
+            number_of_applications += counts[i];
+            for (const auto &temporary : temporaries[i]) {
+                ir->program->objects.add(temporary);
+            }
+        }
+
+    } else {
+        for (const auto &block : blocks) {
             try {
-                number_of_applications += run_on_block(ir, block, ignore_schedule, predicate);
+                number_of_applications += run_on_block(ir, block, ignore_schedule, predicate, nullptr);
             } catch (utils::Exception &e) {
                 e.add_context("in block " + block->name);
                 throw;
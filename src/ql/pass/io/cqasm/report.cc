@@ -185,6 +185,13 @@ ReportCQasmPass::ReportCQasmPass(
         "notation.",
         true
     );
+    options.add_int(
+        "num_threads",
+        "The number of threads to use for formatting the blocks of the "
+        "program. When not 1, consecutive blocks are formatted concurrently "
+        "and written in program order. 0 means one thread per hardware thread.",
+        "1", 0, utils::MAX
+    );
 }
 
 /**
@@ -194,8 +201,6 @@ utils::Int ReportCQasmPass::run(
     const ir::Ref &ir,
     const pmgr::pass_types::Context &context
 ) const {
-    utils::OutFile file{context.output_prefix + options["output_suffix"].as_str()};
-
     ir::cqasm::WriteOptions write_options;
 
     // This should probably be parsed rather than be an if-else chain, but
@@ -226,8 +231,13 @@ utils::Int ReportCQasmPass::run(
     }
 
     write_options.include_timing = options["with_timing"].as_bool();
+    write_options.num_threads = options["num_threads"].as_uint();
 
-    ir::cqasm::write(ir, write_options, file.unwrap());
+    ir::cqasm::write_file(
+        ir,
+        context.output_prefix + options["output_suffix"].as_str(),
+        write_options
+    );
 
     return 0;
 }
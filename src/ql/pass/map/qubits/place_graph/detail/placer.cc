@@ -0,0 +1,860 @@
+/** \file
+ * Graph-based initial placement engine.
+ */
+
+#include "placer.h"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+#include "ql/utils/parallel.h"
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace place_graph {
+namespace detail {
+
+using namespace utils;
+
+/**
+ * Counts the two-qubit gates between each pair of qubits in the program of
+ * the given IR.
+ */
+Interactions count_interactions(const ir::Ref &ir) {
+    class CountInteractions : public ir::RecursiveVisitor {
+    public:
+        CountInteractions(const ir::Ref &ir, Interactions &interactions) : ir(ir), interactions(interactions) {}
+
+        void visit_node(ir::Node &node) override {}
+
+        void visit_custom_instruction(ir::CustomInstruction &instr) override {
+            Vec<UInt> qubits;
+            for (const auto &op : instr.operands) {
+                if (auto ref = op->as_reference()) {
+                    if (ref->target == ir->platform->qubits && ref->data_type == ir->platform->qubits->data_type) {
+                        QL_ASSERT(ref->indices.size() == 1);
+                        qubits.push_back(ref->indices[0].as<ir::IntLiteral>()->value);
+                    }
+                }
+            }
+
+            // Gates on more than two qubits are counted as interactions
+            // between all pairs of their operands.
+            for (UInt i = 0; i < qubits.size(); ++i) {
+                for (UInt j = i + 1; j < qubits.size(); ++j) {
+                    if (qubits[i] != qubits[j]) {
+                        interactions[qubits[i]].set(qubits[j])++;
+                        interactions[qubits[j]].set(qubits[i])++;
+                    }
+                }
+            }
+        }
+
+    private:
+        const ir::Ref &ir;
+        Interactions &interactions;
+    };
+
+    Interactions interactions(ir->platform->qubits->shape[0]);
+    if (!ir->program.empty()) {
+        CountInteractions counter{ir, interactions};
+        ir->program->visit(counter);
+    }
+    return interactions;
+}
+
+namespace {
+
+/**
+ * Returns the distance between the given real qubits as used for the cost
+ * function. This is the minimum number of hops needed to perform a two-qubit
+ * gate between them, which accounts for the fact that a gate cannot be done
+ * across an inter-core hop. The distance between unconnected qubits is taken
+ * to be the number of qubits, which is more than any real distance.
+ */
+UInt get_cost_distance(const com::Topology &topology, UInt a, UInt b) {
+    if (a == b) {
+        return 0;
+    }
+    auto d = topology.get_distance(a, b);
+    if (d == utils::MAX) {
+        return topology.get_num_qubits();
+    }
+    return topology.get_min_hops(a, b);
+}
+
+/**
+ * Marker for virtual qubits that have not been assigned to a core or
+ * location yet, and for locations that are free.
+ */
+static constexpr UInt UNASSIGNED = com::map::UNDEFINED_QUBIT;
+
+/**
+ * State of the placement algorithm.
+ */
+class Placer {
+private:
+
+    /**
+     * The problem and its configuration.
+     */
+    const Interactions &interactions;
+    const com::Topology &topology;
+    const Options &options;
+
+    /**
+     * The number of threads to use, resolved from the options.
+     */
+    UInt num_threads;
+
+    /**
+     * Number of real qubits and cores, and the number of real qubits per core.
+     */
+    UInt num_qubits;
+    UInt num_cores;
+    UInt core_size;
+
+    /**
+     * Whether all real qubits are communication qubits. When they are not,
+     * the distance of an inter-core interaction depends on which of its
+     * qubits are communication qubits.
+     */
+    Bool all_comm_qubits;
+
+    /**
+     * The total number of interactions of each virtual qubit.
+     */
+    Vec<UInt> total_weight;
+
+    /**
+     * The core that each interacting virtual qubit is assigned to.
+     */
+    Vec<UInt> core_of;
+
+    /**
+     * The current virtual to real and real to virtual qubit maps.
+     */
+    Vec<UInt> v2r;
+    Vec<UInt> r2v;
+
+    /**
+     * A partial placement of the virtual qubits, as virtual to real and real
+     * to virtual qubit maps.
+     */
+    struct Placement {
+        Vec<UInt> v2r;
+        Vec<UInt> r2v;
+    };
+
+    /**
+     * For each location, the sum of the distances to all locations in the
+     * same core. Lower is more central.
+     */
+    Vec<UInt> centrality;
+
+    /**
+     * Returns the distance between the given real qubits.
+     */
+    UInt distance(UInt a, UInt b) const {
+        return get_cost_distance(topology, a, b);
+    }
+
+    /**
+     * Returns whether the given virtual qubit interacts with any other qubit.
+     */
+    Bool is_interacting(UInt v) const {
+        return !interactions[v].empty();
+    }
+
+    /**
+     * Returns the order in which the interacting virtual qubits for which
+     * include is set are to be processed: after the given first qubit, or the
+     * qubit with the most interactions if there is none, the qubit that
+     * interacts most with the qubits processed so far is processed next. Ties
+     * are broken by total number of interactions and then by index, such that
+     * the result is deterministic.
+     */
+    Vec<UInt> compute_order(const Vec<Bool> &include, UInt first = UNASSIGNED) const {
+
+        // Seeds for each connected component, by descending weight.
+        Vec<UInt> seeds;
+        for (UInt v = 0; v < include.size(); ++v) {
+            if (include[v] && is_interacting(v)) {
+                seeds.push_back(v);
+            }
+        }
+        std::stable_sort(seeds.begin(), seeds.end(), [this](UInt a, UInt b) {
+            return total_weight[a] > total_weight[b];
+        });
+        if (first != UNASSIGNED) {
+            seeds.erase(std::find(seeds.begin(), seeds.end(), first));
+            seeds.insert(seeds.begin(), first);
+        }
+
+        // Priority queue of (connection, total weight, -index), with lazy
+        // removal of outdated entries.
+        using Entry = std::tuple<UInt, UInt, Int>;
+        std::priority_queue<Entry> queue;
+        Vec<UInt> connection(include.size(), 0);
+        Vec<Bool> visited(include.size(), false);
+        Vec<UInt> order;
+        auto next_seed = seeds.begin();
+        while (order.size() < seeds.size()) {
+            UInt v;
+            if (queue.empty()) {
+                while (visited[*next_seed]) {
+                    ++next_seed;
+                }
+                v = *next_seed;
+            } else {
+                auto entry = queue.top();
+                queue.pop();
+                v = (UInt)(-std::get<2>(entry));
+                if (visited[v] || std::get<0>(entry) != connection[v]) {
+                    continue;
+                }
+            }
+            visited[v] = true;
+            order.push_back(v);
+            for (const auto &it : interactions[v]) {
+                auto u = it.first;
+                if (include[u] && !visited[u]) {
+                    connection[u] += it.second;
+                    queue.emplace(connection[u], total_weight[u], -(Int)u);
+                }
+            }
+        }
+        return order;
+    }
+
+    /**
+     * Returns an interacting virtual qubit on the periphery of the
+     * interaction graph of the qubits for which include is set, being the
+     * qubit farthest away (in number of interactions) from the qubit farthest
+     * away from the qubit with the most interactions. Ties are broken by
+     * lowest total number of interactions. Returns UNASSIGNED if none of the
+     * included qubits interact.
+     */
+    UInt find_peripheral(const Vec<Bool> &include) const {
+        UInt start = UNASSIGNED;
+        for (UInt v = 0; v < include.size(); ++v) {
+            if (include[v] && is_interacting(v) && (start == UNASSIGNED || total_weight[v] > total_weight[start])) {
+                start = v;
+            }
+        }
+        if (start == UNASSIGNED) {
+            return UNASSIGNED;
+        }
+        for (UInt sweep = 0; sweep < 2; ++sweep) {
+            Vec<UInt> depth(include.size(), UNASSIGNED);
+            Vec<UInt> queue;
+            depth[start] = 0;
+            queue.push_back(start);
+            auto farthest = start;
+            for (UInt head = 0; head < queue.size(); ++head) {
+                auto v = queue[head];
+                if (
+                    depth[v] > depth[farthest] ||
+                    (depth[v] == depth[farthest] && total_weight[v] < total_weight[farthest])
+                ) {
+                    farthest = v;
+                }
+                for (const auto &it : interactions[v]) {
+                    auto u = it.first;
+                    if (include[u] && depth[u] == UNASSIGNED) {
+                        depth[u] = depth[v] + 1;
+                        queue.push_back(u);
+                    }
+                }
+            }
+            start = farthest;
+        }
+        return start;
+    }
+
+    /**
+     * Returns the number of interactions between the given virtual qubit and
+     * the qubits assigned to the given core.
+     */
+    UInt core_weight(UInt v, UInt core) const {
+        UInt weight = 0;
+        for (const auto &it : interactions[v]) {
+            if (core_of[it.first] == core) {
+                weight += it.second;
+            }
+        }
+        return weight;
+    }
+
+    /**
+     * Returns the decrease in the number of inter-core interactions when the
+     * given virtual qubit is moved to the given core.
+     */
+    Int core_move_gain(UInt v, UInt core) const {
+        return (Int)core_weight(v, core) - (Int)core_weight(v, core_of[v]);
+    }
+
+    /**
+     * Assigns the interacting virtual qubits to cores, keeping strongly
+     * interacting qubits together. Each qubit in turn is assigned to the core
+     * with remaining capacity that it interacts with most so far, preferring
+     * the fullest such core, such that the cores are filled one by one with
+     * connected groups of qubits.
+     */
+    void partition() {
+        core_of.assign(interactions.size(), UNASSIGNED);
+        if (num_cores == 1) {
+            for (UInt v = 0; v < interactions.size(); ++v) {
+                if (is_interacting(v)) {
+                    core_of[v] = 0;
+                }
+            }
+            return;
+        }
+
+        Vec<UInt> remaining(num_cores, core_size);
+        for (auto v : compute_order(Vec<Bool>(interactions.size(), true))) {
+            UInt best = UNASSIGNED;
+            UInt best_weight = 0;
+            for (UInt core = 0; core < num_cores; ++core) {
+                if (!remaining[core]) {
+                    continue;
+                }
+                auto weight = core_weight(v, core);
+                if (
+                    best == UNASSIGNED || weight > best_weight ||
+                    (weight == best_weight && remaining[core] < remaining[best])
+                ) {
+                    best = core;
+                    best_weight = weight;
+                }
+            }
+            QL_ASSERT(best != UNASSIGNED);
+            core_of[v] = best;
+            remaining[best]--;
+        }
+
+        refine_partition(remaining);
+    }
+
+    /**
+     * Improves the assignment of qubits to cores by moving qubits to cores
+     * with remaining capacity and exchanging pairs of qubits between cores,
+     * as long as this reduces the number of inter-core interactions. The
+     * preferred moves are computed concurrently, and then applied one by one
+     * if they still reduce the cost.
+     */
+    void refine_partition(Vec<UInt> &remaining) {
+        Vec<UInt> target(interactions.size(), UNASSIGNED);
+        Vec<Int> gain(interactions.size(), 0);
+        for (UInt iteration = 0; iteration < options.refine_iterations; ++iteration) {
+
+            // Determine the preferred core for each qubit.
+            parallel_for(interactions.size(), num_threads, [&](UInt v) {
+                target[v] = UNASSIGNED;
+                if (core_of[v] == UNASSIGNED) {
+                    return;
+                }
+                Vec<UInt> weights(num_cores, 0);
+                for (const auto &it : interactions[v]) {
+                    weights[core_of[it.first]] += it.second;
+                }
+                for (UInt core = 0; core < num_cores; ++core) {
+                    if (core == core_of[v]) {
+                        continue;
+                    }
+                    Int g = (Int)weights[core] - (Int)weights[core_of[v]];
+                    if (target[v] == UNASSIGNED || g > gain[v]) {
+                        target[v] = core;
+                        gain[v] = g;
+                    }
+                }
+            });
+
+            // Group the candidates by source and target core, most promising
+            // first.
+            Vec<Vec<UInt>> candidates(num_cores * num_cores);
+            for (UInt v = 0; v < interactions.size(); ++v) {
+                if (target[v] != UNASSIGNED) {
+                    candidates[core_of[v] * num_cores + target[v]].push_back(v);
+                }
+            }
+            for (auto &list : candidates) {
+                std::stable_sort(list.begin(), list.end(), [&gain](UInt a, UInt b) {
+                    return gain[a] > gain[b];
+                });
+            }
+
+            Bool improved = false;
+
+            // Moves into cores with remaining capacity.
+            for (UInt from = 0; from < num_cores; ++from) {
+                for (UInt to = 0; to < num_cores; ++to) {
+                    for (auto v : candidates[from * num_cores + to]) {
+                        if (!remaining[to]) {
+                            break;
+                        }
+                        if (core_of[v] == from && core_move_gain(v, to) > 0) {
+                            core_of[v] = to;
+                            remaining[from]++;
+                            remaining[to]--;
+                            improved = true;
+                        }
+                    }
+                }
+            }
+
+            // Exchanges between pairs of cores.
+            for (UInt a = 0; a < num_cores; ++a) {
+                for (UInt b = a + 1; b < num_cores; ++b) {
+                    const auto &ab = candidates[a * num_cores + b];
+                    const auto &ba = candidates[b * num_cores + a];
+                    for (UInt n = 0; n < ab.size() && n < ba.size(); ++n) {
+                        auto u = ab[n];
+                        auto v = ba[n];
+                        if (core_of[u] != a || core_of[v] != b) {
+                            continue;
+                        }
+                        Int g = core_move_gain(u, b) + core_move_gain(v, a);
+                        auto it = interactions[u].find(v);
+                        if (it != interactions[u].end()) {
+                            g -= 2 * (Int)it->second;
+                        }
+                        if (g > 0) {
+                            core_of[u] = b;
+                            core_of[v] = a;
+                            improved = true;
+                        }
+                    }
+                }
+            }
+
+            if (!improved) {
+                break;
+            }
+        }
+    }
+
+    /**
+     * Computes the centrality of all locations.
+     */
+    void compute_centrality() {
+        centrality.assign(num_qubits, 0);
+        parallel_for(num_qubits, num_threads, [this](UInt k) {
+            auto core = topology.get_core_index(k);
+            UInt sum = 0;
+            for (UInt l = core * core_size; l < (core + 1) * core_size; ++l) {
+                sum += distance(k, l);
+            }
+            centrality[k] = sum;
+        });
+    }
+
+    /**
+     * Returns the cost contribution of the given virtual qubit when placed on
+     * the given location, with respect to the qubits of the same core that
+     * have been placed in the given placement already.
+     */
+    UInt placement_cost(UInt v, UInt location, const Placement &placement) const {
+        UInt cost = 0;
+        for (const auto &it : interactions[v]) {
+            auto u = it.first;
+            if (core_of[u] == core_of[v] && placement.v2r[u] != UNASSIGNED) {
+                cost += it.second * distance(location, placement.v2r[u]);
+            }
+        }
+        return cost;
+    }
+
+    /**
+     * Returns the cost of the interactions within the given core for the
+     * given placement.
+     */
+    UInt core_cost(UInt core, const Placement &placement) const {
+        UInt cost = 0;
+        for (UInt v = 0; v < interactions.size(); ++v) {
+            if (core_of[v] != core) {
+                continue;
+            }
+            for (const auto &it : interactions[v]) {
+                auto u = it.first;
+                if (u > v && core_of[u] == core) {
+                    cost += it.second * distance(placement.v2r[v], placement.v2r[u]);
+                }
+            }
+        }
+        return cost;
+    }
+
+    /**
+     * Places the interacting virtual qubits assigned to the given core on
+     * the locations of that core, by growing the interaction graph onto the
+     * core. When from_periphery is set, growth starts with a peripheral qubit
+     * of the interaction graph on the least central location of the core,
+     * which suits chain-like interaction graphs. Otherwise, it starts with
+     * the qubit with the most interactions on the most central location.
+     */
+    void grow(UInt core, Bool from_periphery, Placement &placement) const {
+        auto &p_v2r = placement.v2r;
+        auto &p_r2v = placement.r2v;
+        Vec<Bool> include(interactions.size(), false);
+        for (UInt v = 0; v < interactions.size(); ++v) {
+            include[v] = core_of[v] == core;
+        }
+        auto first_location = core * core_size;
+        auto end_location = first_location + core_size;
+
+        // Visitation stamps for the breadth-first searches below.
+        Vec<UInt> visited(num_qubits, 0);
+        UInt stamp = 0;
+        UInt num_free = core_size;
+
+        UInt first = UNASSIGNED;
+        if (from_periphery) {
+            first = find_peripheral(include);
+        }
+
+        UInt last_location = UNASSIGNED;
+        for (auto v : compute_order(include, first)) {
+
+            // Search from the location of the placed qubit that v interacts
+            // with most. If there is none, start from the location of the
+            // previously placed qubit, or from the most or least central
+            // location of the core for the very first qubit.
+            UInt origin = UNASSIGNED;
+            UInt origin_weight = 0;
+            for (const auto &it : interactions[v]) {
+                auto u = it.first;
+                if (core_of[u] == core && p_v2r[u] != UNASSIGNED && it.second > origin_weight) {
+                    origin = p_v2r[u];
+                    origin_weight = it.second;
+                }
+            }
+            if (origin == UNASSIGNED) {
+                origin = last_location;
+            }
+            if (origin == UNASSIGNED) {
+                origin = first_location;
+                for (auto k = first_location; k < end_location; ++k) {
+                    if (from_periphery ? centrality[k] > centrality[origin] : centrality[k] < centrality[origin]) {
+                        origin = k;
+                    }
+                }
+            }
+
+            // Collect the free locations closest to the origin, by
+            // breadth-first search within the core. Once all locations of
+            // the core have been queued, which happens immediately for fully
+            // connected cores, there is no need to expand any further.
+            Vec<UInt> candidates;
+            auto num_candidates = std::min<UInt>(std::max<UInt>(options.candidates, 1), num_free);
+            std::queue<UInt> queue;
+            UInt num_queued = 1;
+            stamp++;
+            visited[origin] = stamp;
+            queue.push(origin);
+            while (!queue.empty() && candidates.size() < num_candidates) {
+                auto k = queue.front();
+                queue.pop();
+                if (p_r2v[k] == UNASSIGNED) {
+                    candidates.push_back(k);
+                }
+                if (num_queued == core_size) {
+                    continue;
+                }
+                for (auto l : topology.get_neighbors(k)) {
+                    if (visited[l] != stamp && topology.get_core_index(l) == core) {
+                        visited[l] = stamp;
+                        queue.push(l);
+                        num_queued++;
+                    }
+                }
+            }
+
+            // If the core is not connected, there may be free locations that
+            // cannot be reached from the origin.
+            for (auto k = first_location; candidates.empty() && k < end_location; ++k) {
+                if (p_r2v[k] == UNASSIGNED) {
+                    candidates.push_back(k);
+                }
+            }
+            QL_ASSERT(!candidates.empty());
+
+            // Select the cheapest candidate, preferring the original index of
+            // the qubit and then the closest candidate.
+            UInt best = UNASSIGNED;
+            UInt best_cost = 0;
+            for (auto k : candidates) {
+                auto cost = placement_cost(v, k, placement);
+                if (best == UNASSIGNED || cost < best_cost || (cost == best_cost && k == v)) {
+                    best = k;
+                    best_cost = cost;
+                }
+            }
+            p_v2r[v] = best;
+            p_r2v[best] = v;
+            last_location = best;
+            num_free--;
+        }
+    }
+
+    /**
+     * Returns the change in cost when virtual qubit v is moved from location
+     * from to location to, ignoring its interaction with virtual qubit
+     * except.
+     */
+    Int move_delta(UInt v, UInt from, UInt to, UInt except) const {
+        Int delta = 0;
+        for (const auto &it : interactions[v]) {
+            auto u = it.first;
+            if (u == except || v2r[u] == UNASSIGNED) {
+                continue;
+            }
+            delta += (Int)(it.second * distance(to, v2r[u]));
+            delta -= (Int)(it.second * distance(from, v2r[u]));
+        }
+        return delta;
+    }
+
+    /**
+     * Returns the change in cost when the virtual qubit on location a is
+     * exchanged with whatever is on location b. Distances are assumed to be
+     * symmetric.
+     */
+    Int swap_delta(UInt a, UInt b) const {
+        auto v = r2v[a];
+        auto u = r2v[b];
+        Int delta = 0;
+        if (v != UNASSIGNED) {
+            delta += move_delta(v, a, b, u);
+        }
+        if (u != UNASSIGNED) {
+            delta += move_delta(u, b, a, v);
+        }
+        return delta;
+    }
+
+    /**
+     * Improves the placement by exchanging qubits on neighboring locations
+     * within a core, as long as this reduces the cost. Unlike the growth
+     * step, this accounts for the inter-core interactions as well, such that
+     * qubits are moved onto or off communication qubits where that helps.
+     * The best exchange for each qubit is computed concurrently, and the
+     * exchanges are then applied one by one, best first, if they still reduce
+     * the cost.
+     */
+    void refine_placement() {
+        Vec<UInt> target(interactions.size(), UNASSIGNED);
+        Vec<Int> delta(interactions.size(), 0);
+        for (UInt iteration = 0; iteration < options.refine_iterations; ++iteration) {
+            parallel_for(interactions.size(), num_threads, [&](UInt v) {
+                target[v] = UNASSIGNED;
+                delta[v] = 0;
+                if (v2r[v] == UNASSIGNED) {
+                    return;
+                }
+                auto a = v2r[v];
+                Vec<UInt> targets;
+                for (auto b : topology.get_neighbors(a)) {
+                    if (!topology.is_inter_core_hop(a, b)) {
+                        targets.push_back(b);
+                    }
+                }
+
+                // When a location is connected to all other locations in its
+                // core and all qubits are communication qubits, exchanges
+                // within the core don't change any distance; the inter-core
+                // interactions are dealt with by the partitioning.
+                if (targets.size() + 1 == core_size && all_comm_qubits) {
+                    return;
+                }
+
+                for (auto b : targets) {
+                    auto d = swap_delta(a, b);
+                    if (d < delta[v]) {
+                        target[v] = b;
+                        delta[v] = d;
+                    }
+                }
+            });
+
+            Vec<UInt> order;
+            for (UInt v = 0; v < interactions.size(); ++v) {
+                if (target[v] != UNASSIGNED) {
+                    order.push_back(v);
+                }
+            }
+            std::stable_sort(order.begin(), order.end(), [&delta](UInt a, UInt b) {
+                return delta[a] < delta[b];
+            });
+
+            Bool improved = false;
+            for (auto v : order) {
+                auto a = v2r[v];
+                auto b = target[v];
+                if (a == b || swap_delta(a, b) >= 0) {
+                    continue;
+                }
+                auto u = r2v[b];
+                v2r[v] = b;
+                r2v[b] = v;
+                r2v[a] = u;
+                if (u != UNASSIGNED) {
+                    v2r[u] = a;
+                }
+                improved = true;
+            }
+
+            if (!improved) {
+                break;
+            }
+        }
+    }
+
+    /**
+     * Places the virtual qubits that don't interact with any other qubit on
+     * the remaining free locations, keeping their index when possible.
+     */
+    void place_remaining() {
+        for (UInt v = 0; v < interactions.size(); ++v) {
+            if (v2r[v] == UNASSIGNED && r2v[v] == UNASSIGNED) {
+                v2r[v] = v;
+                r2v[v] = v;
+            }
+        }
+        UInt next_free = 0;
+        for (UInt v = 0; v < interactions.size(); ++v) {
+            if (v2r[v] != UNASSIGNED) {
+                continue;
+            }
+            while (r2v[next_free] != UNASSIGNED) {
+                next_free++;
+            }
+            v2r[v] = next_free;
+            r2v[next_free] = v;
+        }
+    }
+
+public:
+
+    /**
+     * Constructs the algorithm state for the given problem.
+     */
+    Placer(
+        const Interactions &interactions,
+        const com::Topology &topology,
+        const Options &options
+    ) :
+        interactions(interactions),
+        topology(topology),
+        options(options),
+        num_threads(get_num_threads(options.num_threads)),
+        num_qubits(topology.get_num_qubits()),
+        num_cores(topology.get_num_cores()),
+        core_size(num_qubits / num_cores),
+        all_comm_qubits(true),
+        total_weight(interactions.size(), 0),
+        v2r(interactions.size(), UNASSIGNED),
+        r2v(num_qubits, UNASSIGNED)
+    {
+        if (interactions.size() > num_qubits) {
+            QL_USER_ERROR(
+                "cannot place " << interactions.size() << " virtual qubits on a "
+                "topology with only " << num_qubits << " qubits"
+            );
+        }
+        for (UInt v = 0; v < interactions.size(); ++v) {
+            for (const auto &it : interactions[v]) {
+                QL_ASSERT(it.first < interactions.size() && it.first != v);
+                total_weight[v] += it.second;
+            }
+        }
+        for (UInt k = 0; k < num_qubits; ++k) {
+            if (!topology.is_comm_qubit(k)) {
+                all_comm_qubits = false;
+            }
+        }
+    }
+
+    /**
+     * Runs the algorithm.
+     */
+    com::map::QubitMapping run() {
+        partition();
+        compute_centrality();
+
+        // Grow each core from both starting points concurrently, and keep
+        // the cheaper result.
+        Vec<Placement> placements(2 * num_cores, Placement{v2r, r2v});
+        parallel_for(placements.size(), num_threads, [this, &placements](UInt i) {
+            grow(i / 2, i % 2 == 1, placements[i]);
+        });
+        for (UInt core = 0; core < num_cores; ++core) {
+            const auto &central = placements[2 * core];
+            const auto &peripheral = placements[2 * core + 1];
+            const auto &best = core_cost(core, peripheral) < core_cost(core, central) ? peripheral : central;
+            for (UInt v = 0; v < interactions.size(); ++v) {
+                if (core_of[v] == core) {
+                    v2r[v] = best.v2r[v];
+                }
+            }
+            for (auto k = core * core_size; k < (core + 1) * core_size; ++k) {
+                r2v[k] = best.r2v[k];
+            }
+        }
+        refine_placement();
+        place_remaining();
+
+        com::map::QubitMapping mapping{num_qubits};
+        for (UInt v = 0; v < interactions.size(); ++v) {
+            mapping[v] = v2r[v];
+        }
+        return mapping;
+    }
+
+};
+
+} // anonymous namespace
+
+/**
+ * Computes a placement of the virtual qubits onto the real qubits of the
+ * given topology that approximately minimizes the cost as computed by
+ * compute_cost().
+ */
+com::map::QubitMapping place(
+    const Interactions &interactions,
+    const com::Topology &topology,
+    const Options &options
+) {
+    return Placer(interactions, topology, options).run();
+}
+
+/**
+ * Returns the cost of the given mapping, being the sum of the minimum number
+ * of hops needed to perform each two-qubit gate. The distance between
+ * unconnected qubits is taken to be the number of qubits.
+ */
+UInt compute_cost(
+    const Interactions &interactions,
+    const com::Topology &topology,
+    const com::map::QubitMapping &mapping
+) {
+    UInt cost = 0;
+    for (UInt v = 0; v < interactions.size(); ++v) {
+        for (const auto &it : interactions[v]) {
+            if (it.first > v) {
+                cost += it.second * get_cost_distance(topology, mapping[v], mapping[it.first]);
+            }
+        }
+    }
+    return cost;
+}
+
+} // namespace detail
+} // namespace place_graph
+} // namespace qubits
+} // namespace map
+} // namespace pass
+} // namespace ql
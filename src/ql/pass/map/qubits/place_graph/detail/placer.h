@@ -0,0 +1,101 @@
+/** \file
+ * Graph-based initial placement engine.
+ */
+
+#pragma once
+
+#include "ql/utils/num.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/map.h"
+#include "ql/ir/ir.h"
+#include "ql/com/topology.h"
+#include "ql/com/map/qubit_mapping.h"
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace place_graph {
+namespace detail {
+
+/**
+ * Options structure for configuring the graph-based placement algorithm.
+ */
+struct Options {
+
+    /**
+     * The number of free locations that are considered for each qubit during
+     * the greedy construction, closest to its most-interacting placed partner
+     * first.
+     */
+    utils::UInt candidates = 8;
+
+    /**
+     * The maximum number of improvement rounds, both for the assignment of
+     * qubits to cores and for the placement within the cores.
+     */
+    utils::UInt refine_iterations = 10;
+
+    /**
+     * The number of threads to use. 0 means that the number of hardware
+     * threads is used.
+     */
+    utils::UInt num_threads = 1;
+
+};
+
+/**
+ * The weighted two-qubit interaction graph of a program. For each virtual
+ * qubit, this maps each qubit it interacts with to the number of two-qubit
+ * gates between them, regardless of operand order.
+ */
+using Interactions = utils::Vec<utils::Map<utils::UInt, utils::UInt>>;
+
+/**
+ * Counts the two-qubit gates between each pair of qubits in the program of
+ * the given IR.
+ */
+Interactions count_interactions(const ir::Ref &ir);
+
+/**
+ * Computes a placement of the virtual qubits onto the real qubits of the
+ * given topology that approximately minimizes the cost as computed by
+ * compute_cost().
+ *
+ * For multi-core topologies, the virtual qubits are first partitioned over
+ * the cores such that the number of inter-core interactions is small, and
+ * each core is then placed independently (and concurrently). The placement
+ * itself grows the interaction graph onto the topology: the qubit that
+ * interacts most with the already-placed qubits is placed next, on the
+ * nearby free location that minimizes its cost with respect to them. Growth
+ * starts both from the center of the core and from its periphery, and the
+ * cheaper result is kept. The result is improved by swapping the locations
+ * of neighboring qubits.
+ *
+ * Virtual qubits that don't interact with any other qubit keep their index
+ * when possible.
+ */
+com::map::QubitMapping place(
+    const Interactions &interactions,
+    const com::Topology &topology,
+    const Options &options
+);
+
+/**
+ * Returns the cost of the given mapping, being the sum of the minimum number
+ * of hops needed to perform each two-qubit gate (see
+ * com::Topology::get_min_hops()). The distance between unconnected qubits is
+ * taken to be the number of qubits.
+ */
+utils::UInt compute_cost(
+    const Interactions &interactions,
+    const com::Topology &topology,
+    const com::map::QubitMapping &mapping
+);
+
+} // namespace detail
+} // namespace place_graph
+} // namespace qubits
+} // namespace map
+} // namespace pass
+} // namespace ql
@@ -0,0 +1,178 @@
+/** \file
+ * Defines the graph-based initial placement pass.
+ */
+
+#include "ql/pass/map/qubits/place_graph/place_graph.h"
+
+#include "detail/placer.h"
+#include "ql/pmgr/factory.h"
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace place_graph {
+
+bool PlaceGraphPass::is_pass_registered = pmgr::Factory::register_pass<PlaceGraphPass>("map.qubits.PlaceGraph");
+
+/**
+ * Dumps docs for the graph-based initial qubit placer.
+ */
+void PlaceGraphPass::dump_docs(
+    std::ostream &os,
+    const utils::Str &line_prefix
+) const {
+    utils::dump_str(os, line_prefix, R"(
+    This pass attempts to find a single mapping of the virtual qubits of a
+    circuit to the real qubits of the platform's qubit topology that makes the
+    two-qubit gates of the circuit as local as possible, like
+    map.qubits.PlaceMIP does. Instead of solving this problem exactly, which
+    is infeasible beyond a few tens of qubits, it embeds the interaction graph
+    of the circuit (with an edge between each pair of qubits that share a
+    two-qubit gate, weighted by the number of such gates) into the topology
+    heuristically. This takes in the order of seconds for thousands of
+    qubits. The result is not optimal, but it is usually a much better
+    starting point for the router (map.qubits.Map) than the trivial mapping.
+
+    The algorithm proceeds as follows.
+
+    - For multi-core topologies, the qubits are first partitioned over the
+      cores. The qubits are assigned one by one to the core they interact
+      with most so far, filling the cores one after the other, after which
+      qubits are moved and exchanged between cores as long as this reduces
+      the number of inter-core interactions.
+    - The interaction graph is then grown onto each core, for different cores
+      concurrently. Each qubit is placed on the free location that minimizes
+      the interaction-weighted distance to the already placed qubits, out of
+      the `candidates` free locations closest to its most-interacting placed
+      partner, after which the qubit that interacts most with the placed
+      qubits is placed next. Growth is started in two ways, keeping the
+      cheaper result: with the qubit with the most interactions on the most
+      central location of the core, and with a qubit on the periphery of the
+      interaction graph on the least central location. The latter works
+      better for chain-like circuits.
+    - Finally, qubits on neighboring locations within a core are exchanged as
+      long as this reduces the total interaction-weighted distance. Unlike
+      the growth step, this includes the inter-core interactions: when a
+      multi-core topology has fewer communication qubits than qubits per
+      core, the number of hops an inter-core gate needs depends on which of
+      its qubits are communication qubits, so the exchanges also move qubits
+      onto or off the communication qubits. The exchanges are evaluated
+      concurrently.
+
+    Qubits that are not used in any two-qubit gate keep their index when
+    possible. The qubit indices are only updated when the resulting placement
+    is better than the current one.
+    )");
+}
+
+/**
+ * Returns a user-friendly type name for this pass.
+ */
+utils::Str PlaceGraphPass::get_friendly_type() const {
+    return "Graph-based initial placer";
+}
+
+/**
+ * Constructs a graph-based initial qubit placer.
+ */
+PlaceGraphPass::PlaceGraphPass(
+    const utils::Ptr<const pmgr::Factory> &pass_factory,
+    const utils::Str &instance_name,
+    const utils::Str &type_name
+) : pmgr::pass_types::Transformation(pass_factory, instance_name, type_name) {
+    options.add_int(
+        "candidates",
+        "The number of free locations that are considered for each qubit "
+        "when it is placed. Higher values may give better placements, at the "
+        "cost of compilation time.",
+        "8", 1, utils::MAX
+    );
+    options.add_int(
+        "refine_iterations",
+        "The maximum number of rounds of improvement for the partitioning "
+        "over the cores and for the placement within the cores.",
+        "10", 0, utils::MAX
+    );
+    options.add_int(
+        "num_threads",
+        "The number of threads used to place cores and to evaluate "
+        "improvements concurrently. The result does not depend on this "
+        "setting. 0 means that the number of hardware threads is used.",
+        "1", 0, utils::MAX
+    );
+}
+
+/**
+ * Visitor that renames the qubit operands in the program according to the
+ * given virtual to real qubit mapping.
+ */
+class ReferenceUpdater : public ir::RecursiveVisitor {
+public:
+    ReferenceUpdater(const ir::Ref &ir, const com::map::QubitMapping &mapping) : ir(ir), mapping(mapping) {}
+
+    void visit_node(ir::Node &node) override {}
+
+    void visit_reference(ir::Reference &ref) override {
+        if (ref.target == ir->platform->qubits && ref.data_type == ir->platform->qubits->data_type) {
+            QL_ASSERT(ref.indices.size() == 1);
+            ref.indices[0].as<ir::IntLiteral>()->value = mapping[ref.indices[0].as<ir::IntLiteral>()->value];
+        }
+    }
+
+private:
+    const ir::Ref &ir;
+    const com::map::QubitMapping &mapping;
+};
+
+/**
+ * Runs graph-based initial qubit placement.
+ */
+utils::Int PlaceGraphPass::run(
+    const ir::Ref &ir,
+    const pmgr::pass_types::Context &context
+) const {
+    detail::Options opts;
+    opts.candidates = options["candidates"].as_uint();
+    opts.refine_iterations = options["refine_iterations"].as_uint();
+    opts.num_threads = options["num_threads"].as_uint();
+
+    auto interactions = detail::count_interactions(ir);
+    const auto &topology = *ir->platform->topology;
+
+    auto num_qubits = ir->platform->qubits->shape[0];
+    com::map::QubitMapping current{num_qubits, true};
+    auto current_cost = detail::compute_cost(interactions, topology, current);
+    if (!current_cost) {
+        QL_IOUT("no two-qubit gates to place, leaving qubit indices as they are");
+        return 0;
+    }
+
+    auto mapping = detail::place(interactions, topology, opts);
+    auto cost = detail::compute_cost(interactions, topology, mapping);
+    if (cost >= current_cost) {
+        QL_IOUT(
+            "graph-based placement did not improve on the current placement "
+            "(cost " << cost << " vs. " << current_cost << "), leaving qubit "
+            "indices as they are"
+        );
+        return 0;
+    }
+
+    QL_IOUT(
+        "graph-based placement reduced the sum of two-qubit gate distances "
+        "from " << current_cost << " to " << cost
+    );
+    QL_DOUT("new mapping: " << mapping.mapping_to_string());
+
+    ReferenceUpdater updater{ir, mapping};
+    ir->program->visit(updater);
+
+    return 0;
+}
+
+} // namespace place_graph
+} // namespace qubits
+} // namespace map
+} // namespace pass
+} // namespace ql
@@ -0,0 +1,257 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "ql/pass/map/qubits/place_graph/detail/placer.h"
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace place_graph {
+namespace detail {
+
+class PlacerTest {
+protected:
+    PlacerTest() {
+        ql::utils::logger::set_log_level("LOG_INFO");
+    }
+
+    void setupLine(utils::UInt qubitsCount) {
+        utils::Json json;
+        json["connectivity"] = "specified";
+        json["edges"] = utils::Json::array();
+        for (utils::UInt q = 0; q + 1 < qubitsCount; ++q) {
+            addEdge(json, q, q + 1);
+        }
+        init(qubitsCount, json);
+    }
+
+    void setupGrid(utils::UInt side) {
+        /*
+
+            0------1------2-- ... --(side-1)
+            |      |      |            |
+          side--(side+1)--  ...
+            |      |      |            |
+           ...
+
+        */
+        utils::Json json;
+        json["form"] = "xy";
+        json["connectivity"] = "specified";
+        json["qubits"] = utils::Json::array();
+        json["edges"] = utils::Json::array();
+        for (utils::UInt q = 0; q < side * side; ++q) {
+            json["qubits"].push_back({{"id", q}, {"x", q % side}, {"y", q / side}});
+            if (q % side + 1 < side) {
+                addEdge(json, q, q + 1);
+            }
+            if (q + side < side * side) {
+                addEdge(json, q, q + side);
+            }
+        }
+        init(side * side, json);
+    }
+
+    void setupMultiCore(utils::UInt qubitsCount, utils::UInt coresCount, utils::UInt commQubitsPerCore = 0) {
+        utils::Json json;
+        json["connectivity"] = "full";
+        json["number_of_cores"] = coresCount;
+        if (commQubitsPerCore) {
+            json["comm_qubits_per_core"] = commQubitsPerCore;
+        }
+        init(qubitsCount, json);
+    }
+
+    void add2QGate(utils::UInt q1, utils::UInt q2, utils::UInt n = 1) {
+        REQUIRE_LT(q1, interactions.size());
+        REQUIRE_LT(q2, interactions.size());
+        REQUIRE_NE(q1, q2);
+
+        interactions[q1].set(q2) += n;
+        interactions[q2].set(q1) += n;
+    }
+
+    void computePlacement() {
+        mapping = place(interactions, *topology, options);
+
+        // The result must be a permutation.
+        std::vector<bool> used(interactions.size(), false);
+        for (utils::UInt v = 0; v < interactions.size(); ++v) {
+            REQUIRE_LT(mapping[v], interactions.size());
+            CHECK_FALSE(used[mapping[v]]);
+            used[mapping[v]] = true;
+        }
+    }
+
+    utils::UInt getCost() {
+        return compute_cost(interactions, *topology, mapping);
+    }
+
+    utils::UInt getIdentityCost() {
+        return compute_cost(interactions, *topology, com::map::QubitMapping{interactions.size(), true});
+    }
+
+    void checkAllMappedGatesAreNearestNeighbors() {
+        for (utils::UInt v = 0; v < interactions.size(); ++v) {
+            for (const auto &kv : interactions[v]) {
+                INFO("Gate between operands ", v, " and ", kv.first, " is not between nearest neighbors after placement.");
+                CHECK_EQ(topology->get_distance(mapping[v], mapping[kv.first]), 1);
+            }
+        }
+    }
+
+    void checkNoInterCoreGates() {
+        for (utils::UInt v = 0; v < interactions.size(); ++v) {
+            for (const auto &kv : interactions[v]) {
+                INFO("Gate between operands ", v, " and ", kv.first, " crosses cores after placement.");
+                CHECK_FALSE(topology->is_inter_core_hop(mapping[v], mapping[kv.first]));
+            }
+        }
+    }
+
+    utils::UInt getInterCoreGatesCount() {
+        utils::UInt count = 0;
+        for (utils::UInt v = 0; v < interactions.size(); ++v) {
+            for (const auto &kv : interactions[v]) {
+                if (kv.first > v && topology->is_inter_core_hop(mapping[v], mapping[kv.first])) {
+                    count++;
+                }
+            }
+        }
+        return count;
+    }
+
+    Options options{};
+    Interactions interactions;
+    com::map::QubitMapping mapping;
+
+private:
+    static void addEdge(utils::Json &json, utils::UInt q1, utils::UInt q2) {
+        json["edges"].push_back({{"src", q1}, {"dst", q2}});
+        json["edges"].push_back({{"src", q2}, {"dst", q1}});
+    }
+
+    void init(utils::UInt qubitsCount, const utils::Json &json) {
+        topology.emplace(qubitsCount, json);
+        interactions = Interactions(qubitsCount);
+    }
+
+    utils::Ptr<com::Topology> topology;
+};
+
+TEST_CASE_FIXTURE(PlacerTest, "Line with chain of interactions") {
+    setupLine(10);
+
+    // Chain 0 - 9 - 1 - 8 - 2 - 7 - 3 - 6 - 4 - 5.
+    for (utils::UInt i = 0; i < 4; ++i) {
+        add2QGate(i, 9 - i, 2);
+        add2QGate(9 - i, i + 1, 3);
+    }
+    add2QGate(4, 5);
+
+    computePlacement();
+
+    checkAllMappedGatesAreNearestNeighbors();
+    CHECK_LT(getCost(), getIdentityCost());
+}
+
+TEST_CASE_FIXTURE(PlacerTest, "Qubits without interactions keep their index") {
+    setupLine(6);
+
+    add2QGate(0, 2);
+
+    computePlacement();
+
+    checkAllMappedGatesAreNearestNeighbors();
+    CHECK_EQ(mapping[3], 3);
+    CHECK_EQ(mapping[4], 4);
+    CHECK_EQ(mapping[5], 5);
+}
+
+TEST_CASE_FIXTURE(PlacerTest, "Scrambled grid") {
+    setupGrid(6);
+
+    // Interactions between all neighbors of a grid, with the virtual qubit
+    // indices scrambled.
+    auto scramble = [](utils::UInt q) { return (q * 7 + 3) % 36; };
+    for (utils::UInt q = 0; q < 36; ++q) {
+        if (q % 6 + 1 < 6) {
+            add2QGate(scramble(q), scramble(q + 1));
+        }
+        if (q + 6 < 36) {
+            add2QGate(scramble(q), scramble(q + 6));
+        }
+    }
+
+    computePlacement();
+
+    CHECK_LT(getCost(), getIdentityCost());
+}
+
+TEST_CASE_FIXTURE(PlacerTest, "Multi-core") {
+    setupMultiCore(8, 2);
+
+    // Two groups of qubits that interact only within the group, spread over
+    // both cores.
+    add2QGate(0, 2, 3);
+    add2QGate(2, 4, 3);
+    add2QGate(4, 6, 3);
+    add2QGate(6, 0, 3);
+    add2QGate(1, 3, 3);
+    add2QGate(3, 5, 3);
+    add2QGate(5, 7, 3);
+    add2QGate(7, 1, 3);
+
+    computePlacement();
+
+    checkNoInterCoreGates();
+    CHECK_LT(getCost(), getIdentityCost());
+}
+
+TEST_CASE_FIXTURE(PlacerTest, "Multi-core with fewer communication qubits than qubits") {
+    setupMultiCore(16, 4, 1);
+
+    // Four rings of qubits, one per core, and two inter-core gates. The
+    // number of hops needed for an inter-core gate depends on which of its
+    // qubits are communication qubits, so the placement within the cores
+    // matters even though they are fully connected.
+    for (utils::UInt core = 0; core < 4; ++core) {
+        for (utils::UInt i = 0; i < 4; ++i) {
+            add2QGate(4 * core + i, 4 * core + (i + 1) % 4, 3);
+        }
+    }
+    add2QGate(1, 5, 2);
+    add2QGate(10, 14, 2);
+
+    computePlacement();
+
+    // The gates within the cores take one hop, and the inter-core gates the
+    // minimum of two.
+    CHECK_EQ(getInterCoreGatesCount(), 2);
+    CHECK_EQ(getCost(), 16 * 3 + 2 * 2 * 2);
+    CHECK_LT(getCost(), getIdentityCost());
+}
+
+TEST_CASE_FIXTURE(PlacerTest, "Result does not depend on the number of threads") {
+    setupGrid(8);
+
+    for (utils::UInt q = 0; q < 64; ++q) {
+        add2QGate(q, (q * 13 + 5) % 64, 1 + q % 3);
+    }
+
+    computePlacement();
+    auto singleThreaded = mapping.get_virt_to_real();
+
+    options.num_threads = 4;
+    computePlacement();
+
+    CHECK_EQ(singleThreaded, mapping.get_virt_to_real());
+}
+
+}
+}
+}
+}
+}
+}
@@ -4,6 +4,9 @@
 
 #include "impl.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "Highs.h"
 #include "io/FilereaderMps.h"
 #include "util/HighsMatrixPic.h"
@@ -35,6 +38,24 @@ bool isPermutation(const utils::Vec<utils::UInt> &v2r) {
     return true;
 }
 
+/**
+ * Returns the cost of the given placement of facilities on locations (fac2r),
+ * counting each interaction once.
+ */
+utils::UInt computePlacementCost(
+    const utils::Vec<utils::Vec<utils::UInt>> &weights,
+    const utils::Vec<utils::Vec<utils::UInt>> &distances,
+    const utils::Vec<utils::UInt> &fac2r
+) {
+    utils::UInt cost = 0;
+    for (utils::UInt i = 0; i < fac2r.size(); ++i) {
+        for (utils::UInt j = i + 1; j < fac2r.size(); ++j) {
+            cost += weights[i][j] * distances[fac2r[i]][fac2r[j]];
+        }
+    }
+    return cost;
+}
+
 void logNewMapping(const utils::Vec<utils::UInt> &v2r) {
     std::stringstream ss;
     ss << "Initial placement resulted in the following mapping (virtual -> real): { ";
@@ -102,6 +123,10 @@ Vec<Vec<UInt>> Impl::computeCostMax(const Vec<Vec<UInt>> &refcount) {
 }
 
 std::unique_ptr<HighsModel> Impl::createHiGHSModel(const Vec<Vec<UInt>> &refcount) {
+    return createHiGHSModel(refcount, Vec<Vec<Bool>>(nfac, Vec<Bool>(qubitsCount, true)));
+}
+
+std::unique_ptr<HighsModel> Impl::createHiGHSModel(const Vec<Vec<UInt>> &refcount, const Vec<Vec<Bool>> &allowed) {
     // This describes the MIP problem using HiGHS's API. Some examples can be found in deps/highs/examples.
 
     std::unique_ptr<HighsModel> model(new HighsModel());
@@ -133,10 +158,13 @@ std::unique_ptr<HighsModel> Impl::createHiGHSModel(const Vec<Vec<UInt>> &refcoun
         - the remaining nfac * qubitsCount rows describe forall i: forall k: costmax[i][k] * x[i][k]
             + ( sum j: sum l: refcount[i][j]*distance(k,l)*x[j][l] ) - w[i][k] <= costmax[i][k]
 
+        Facility/location pairs that are not allowed have x[i][k] and w[i][k] fixed to 0. Their
+        linearization rows are trivially satisfied and thus omitted, and their columns are left
+        out of the other rows, so the number of rows depends on the number of allowed pairs.
+
     */
 
     lp_.num_col_ = 2 * nfac * qubitsCount;
-    lp_.num_row_ = nfac + qubitsCount + nfac * qubitsCount;
     lp_.sense_ = ObjSense::kMinimize;
     lp_.offset_ = 0;
 
@@ -151,20 +179,20 @@ std::unique_ptr<HighsModel> Impl::createHiGHSModel(const Vec<Vec<UInt>> &refcoun
     lp_.col_upper_ = std::vector<double>(lp_.num_col_, 1.);
     std::fill(lp_.col_upper_.begin() + nfac * qubitsCount, lp_.col_upper_.end(), HIGHS_LARGE_VALUE);
 
-    lp_.row_lower_ = std::vector<double>(lp_.num_row_, 0.);
-    std::fill(lp_.row_lower_.begin() + qubitsCount, lp_.row_lower_.begin() + qubitsCount + nfac, 1.);
-    std::fill(lp_.row_lower_.begin() + qubitsCount + nfac, lp_.row_lower_.end(), -HIGHS_LARGE_VALUE);
-
-    lp_.row_upper_ = std::vector<double>(lp_.num_row_, 1.);
-    
-    auto costmax = computeCostMax(refcount);
-
     for (UInt i = 0; i < nfac; ++i) {
         for (UInt k = 0; k < qubitsCount; ++k) {
-            lp_.row_upper_[qubitsCount + nfac + i * qubitsCount + k] = costmax[i][k];
+            if (!allowed[i][k]) {
+                lp_.col_upper_[i * qubitsCount + k] = 0.;
+                lp_.col_upper_[nfac * qubitsCount + i * qubitsCount + k] = 0.;
+            }
         }
     }
 
+    lp_.row_lower_ = std::vector<double>();
+    lp_.row_upper_ = std::vector<double>();
+
+    auto costmax = computeCostMax(refcount);
+
     /*
 
         lp_.a_matrix_ is a sparse matrix, non-zero entries are described using 3 vectors index_, value_ and start_.
@@ -187,31 +215,46 @@ std::unique_ptr<HighsModel> Impl::createHiGHSModel(const Vec<Vec<UInt>> &refcoun
     */
 
     lp_.a_matrix_.num_col_ = lp_.num_col_;
-    lp_.a_matrix_.num_row_ = lp_.num_row_;
     lp_.a_matrix_.format_ = MatrixFormat::kRowwise;
     lp_.a_matrix_.start_ = std::vector<int>();
 
     for (UInt k = 0; k < qubitsCount; ++k) {
         lp_.a_matrix_.start_.push_back(lp_.a_matrix_.value_.size());
-        lp_.a_matrix_.value_.insert(lp_.a_matrix_.value_.end(), nfac, 1);
+        lp_.row_lower_.push_back(0.);
+        lp_.row_upper_.push_back(1.);
         for (UInt i = 0; i < nfac; ++i) {
-            lp_.a_matrix_.index_.push_back(i * qubitsCount + k);
+            if (allowed[i][k]) {
+                lp_.a_matrix_.value_.push_back(1);
+                lp_.a_matrix_.index_.push_back(i * qubitsCount + k);
+            }
         }
     }
 
     for (UInt i = 0; i < nfac; ++i) {
         lp_.a_matrix_.start_.push_back(lp_.a_matrix_.value_.size());
-        lp_.a_matrix_.value_.insert(lp_.a_matrix_.value_.end(), qubitsCount, 1);
+        lp_.row_lower_.push_back(1.);
+        lp_.row_upper_.push_back(1.);
         for (UInt k = 0; k < qubitsCount; ++k) {
-            lp_.a_matrix_.index_.push_back(i * qubitsCount + k);
+            if (allowed[i][k]) {
+                lp_.a_matrix_.value_.push_back(1);
+                lp_.a_matrix_.index_.push_back(i * qubitsCount + k);
+            }
         }
     }
 
     for (UInt i = 0; i < nfac; ++i) {
         for (UInt k = 0; k < qubitsCount; ++k) {
+            if (!allowed[i][k]) {
+                continue;
+            }
             lp_.a_matrix_.start_.push_back(lp_.a_matrix_.value_.size());
+            lp_.row_lower_.push_back(-HIGHS_LARGE_VALUE);
+            lp_.row_upper_.push_back(costmax[i][k]);
             for (UInt j = 0; j < nfac; ++j) {
                 for (UInt l = 0; l < qubitsCount; ++l) {
+                    if (!allowed[j][l]) {
+                        continue;
+                    }
                     QL_ASSERT(distanceProvider(k, l) < utils::MAX && "All qubits in the topology should be connected");
                     double newValue = refcount[i][j] * distanceProvider(k, l);
                     if (j == i && l == k) {
@@ -234,6 +277,9 @@ std::unique_ptr<HighsModel> Impl::createHiGHSModel(const Vec<Vec<UInt>> &refcoun
     // Last element of start_ needs to be the total number of non-zero elements in the sparse matrix.
     lp_.a_matrix_.start_.push_back(lp_.a_matrix_.value_.size());
 
+    lp_.num_row_ = lp_.row_lower_.size();
+    lp_.a_matrix_.num_row_ = lp_.num_row_;
+
     QL_ASSERT(lp_.num_row_ > 0);
     QL_ASSERT(lp_.a_matrix_.start_.size() == static_cast<std::size_t>(lp_.num_row_) + 1);
     QL_ASSERT(lp_.a_matrix_.value_.size() == lp_.a_matrix_.index_.size());
@@ -249,6 +295,192 @@ std::unique_ptr<HighsModel> Impl::createHiGHSModel(const Vec<Vec<UInt>> &refcoun
     return model;
 }
 
+Vec<Vec<UInt>> Impl::computeDistances() {
+    Vec<Vec<UInt>> distances(qubitsCount, Vec<UInt>(qubitsCount, 0));
+    for (UInt k = 0; k < qubitsCount; ++k) {
+        for (UInt l = 0; l < qubitsCount; ++l) {
+            if (k != l) {
+                distances[k][l] = distanceProvider(k, l);
+                QL_ASSERT(distances[k][l] < utils::MAX && "All qubits in the topology should be connected");
+            }
+        }
+    }
+    return distances;
+}
+
+Vec<UInt> Impl::computeHeuristicPlacement(
+    const Vec<Vec<UInt>> &weights,
+    const Vec<Vec<UInt>> &distances,
+    const Vec<UInt> &fac2v
+) {
+    static constexpr UInt UNPLACED = utils::MAX;
+
+    // The facility with the largest total interaction count is used as the
+    // seed of the greedy construction.
+    Vec<UInt> totalWeight(nfac, 0);
+    UInt seed = 0;
+    for (UInt i = 0; i < nfac; ++i) {
+        for (UInt j = 0; j < nfac; ++j) {
+            totalWeight[i] += weights[i][j];
+        }
+        if (totalWeight[i] > totalWeight[seed]) {
+            seed = i;
+        }
+    }
+
+    // Greedily construct a placement for each possible location of the seed,
+    // and keep the cheapest one. After the seed, the facility that interacts
+    // most with the facilities placed so far is placed next, on the free
+    // location that minimizes the cost with respect to those facilities.
+    Vec<UInt> fac2r;
+    Vec<UInt> r2fac;
+    UInt bestTotalCost = utils::MAX;
+    for (UInt seedLocation = 0; seedLocation < qubitsCount; ++seedLocation) {
+        Vec<UInt> candidateFac2r(nfac, UNPLACED);
+        Vec<UInt> candidateR2fac(qubitsCount, UNPLACED);
+        Vec<UInt> connection(nfac, 0);
+        UInt totalCost = 0;
+        auto i = seed;
+        auto location = seedLocation;
+        for (UInt n = 0; n < nfac; ++n) {
+            if (n > 0) {
+
+                // Select the next facility.
+                i = UNPLACED;
+                for (UInt j = 0; j < nfac; ++j) {
+                    if (candidateFac2r[j] != UNPLACED) {
+                        continue;
+                    }
+                    if (
+                        i == UNPLACED || connection[j] > connection[i] ||
+                        (connection[j] == connection[i] && totalWeight[j] > totalWeight[i])
+                    ) {
+                        i = j;
+                    }
+                }
+
+                // Select its location.
+                location = UNPLACED;
+                UInt bestCost = utils::MAX;
+                for (UInt k = 0; k < qubitsCount; ++k) {
+                    if (candidateR2fac[k] != UNPLACED) {
+                        continue;
+                    }
+                    UInt cost = 0;
+                    for (UInt j = 0; j < nfac; ++j) {
+                        if (candidateFac2r[j] != UNPLACED) {
+                            cost += weights[i][j] * distances[k][candidateFac2r[j]];
+                        }
+                    }
+                    if (cost < bestCost || (cost == bestCost && k == fac2v[i])) {
+                        bestCost = cost;
+                        location = k;
+                    }
+                }
+                QL_ASSERT(location != UNPLACED);
+                totalCost += bestCost;
+
+            }
+            candidateFac2r[i] = location;
+            candidateR2fac[location] = i;
+            for (UInt j = 0; j < nfac; ++j) {
+                connection[j] += weights[i][j];
+            }
+        }
+        if (totalCost < bestTotalCost) {
+            bestTotalCost = totalCost;
+            fac2r = std::move(candidateFac2r);
+            r2fac = std::move(candidateR2fac);
+        }
+    }
+
+    // Improve the placement by moving single facilities to free locations or
+    // exchanging the locations of two facilities, until no such move reduces
+    // the cost anymore. Distances are assumed to be symmetric.
+    auto moveDelta = [&](UInt i, UInt from, UInt to, UInt except) {
+        Int delta = 0;
+        for (UInt j = 0; j < nfac; ++j) {
+            if (j == i || j == except || weights[i][j] == 0) {
+                continue;
+            }
+            delta += (Int)(weights[i][j] * distances[to][fac2r[j]]);
+            delta -= (Int)(weights[i][j] * distances[from][fac2r[j]]);
+        }
+        return delta;
+    };
+
+    static constexpr UInt MAX_ITERATIONS = 1000;
+    Bool improved = true;
+    for (UInt iteration = 0; improved && iteration < MAX_ITERATIONS; ++iteration) {
+        improved = false;
+        for (UInt i = 0; i < nfac; ++i) {
+            for (UInt k = 0; k < qubitsCount; ++k) {
+                auto from = fac2r[i];
+                if (k == from) {
+                    continue;
+                }
+                auto h = r2fac[k];
+                Int delta = moveDelta(i, from, k, h);
+                if (h != UNPLACED) {
+                    delta += moveDelta(h, k, from, i);
+                }
+                if (delta >= 0) {
+                    continue;
+                }
+                fac2r[i] = k;
+                r2fac[k] = i;
+                r2fac[from] = h;
+                if (h != UNPLACED) {
+                    fac2r[h] = from;
+                }
+                improved = true;
+            }
+        }
+    }
+
+    return fac2r;
+}
+
+Vec<Vec<UInt>> Impl::computeLowerBounds(
+    const Vec<Vec<UInt>> &weights,
+    const Vec<Vec<UInt>> &distances
+) {
+
+    // For each location, the distances to all other locations, ascending.
+    Vec<Vec<UInt>> sortedDistances(qubitsCount);
+    for (UInt k = 0; k < qubitsCount; ++k) {
+        for (UInt l = 0; l < qubitsCount; ++l) {
+            if (l != k) {
+                sortedDistances[k].push_back(distances[k][l]);
+            }
+        }
+        std::sort(sortedDistances[k].begin(), sortedDistances[k].end());
+    }
+
+    // By the rearrangement inequality, the cost of the interactions of
+    // facility i with all other facilities when placed on location k is at
+    // least the inner product of its interaction counts sorted in descending
+    // order and the distances from k sorted in ascending order.
+    Vec<Vec<UInt>> bounds(nfac, Vec<UInt>(qubitsCount, 0));
+    for (UInt i = 0; i < nfac; ++i) {
+        Vec<UInt> sortedWeights;
+        for (UInt j = 0; j < nfac; ++j) {
+            if (j != i && weights[i][j] > 0) {
+                sortedWeights.push_back(weights[i][j]);
+            }
+        }
+        std::sort(sortedWeights.begin(), sortedWeights.end(), std::greater<UInt>());
+        QL_ASSERT(sortedWeights.size() < qubitsCount);
+        for (UInt k = 0; k < qubitsCount; ++k) {
+            for (UInt n = 0; n < sortedWeights.size(); ++n) {
+                bounds[i][k] += sortedWeights[n] * sortedDistances[k][n];
+            }
+        }
+    }
+
+    return bounds;
+}
+
 Result Impl::run(Vec<UInt> &v2r) {
     QL_ASSERT(v2r.size() == qubitsCount);
 
@@ -303,55 +535,153 @@ Result Impl::run(Vec<UInt> &v2r) {
         refcount[v2fac[kv.first.first]][v2fac[kv.first.second]] = kv.second;
     }
 
-    auto model = createHiGHSModel(refcount);
+    // Facility to location mapping, to be determined.
+    Vec<UInt> fac2r(nfac, UNDEFINED_QUBIT);
+
+    // When warm-starting, compute a heuristic placement first, and use it to
+    // rule out all facility/location pairs that cannot be part of a better
+    // placement. If the heuristic placement is provably optimal already, the
+    // MIP solver doesn't need to run at all.
+    Vec<Vec<Bool>> allowed(nfac, Vec<Bool>(qubitsCount, true));
+    Bool solveMip = true;
+    if (opts.warm_start) {
+        Vec<Vec<UInt>> weights(nfac, Vec<UInt>(nfac, 0));
+        for (UInt i = 0; i < nfac; ++i) {
+            for (UInt j = 0; j < nfac; ++j) {
+                weights[i][j] = refcount[i][j] + refcount[j][i];
+            }
+        }
+        auto distances = computeDistances();
+
+        fac2r = computeHeuristicPlacement(weights, distances, fac2v);
+        auto incumbentCost = computePlacementCost(weights, distances, fac2r);
+
+        // Each interaction is counted from both ends in the bounds, so
+        // everything is compared against twice the incumbent cost.
+        auto bounds = computeLowerBounds(weights, distances);
+        Vec<UInt> minBounds(nfac, utils::MAX);
+        UInt sumOfMinBounds = 0;
+        for (UInt i = 0; i < nfac; ++i) {
+            minBounds[i] = *std::min_element(bounds[i].begin(), bounds[i].end());
+            sumOfMinBounds += minBounds[i];
+        }
+        QL_DOUT(
+            "Heuristic placement has cost " << incumbentCost
+            << ", lower bound is " << (sumOfMinBounds + 1) / 2
+        );
+
+        if (sumOfMinBounds >= 2 * incumbentCost) {
+            QL_DOUT("Heuristic placement is optimal, skipping MIP solver");
+            solveMip = false;
+        } else {
+            UInt prunedCount = 0;
+            for (UInt i = 0; i < nfac; ++i) {
+                for (UInt k = 0; k < qubitsCount; ++k) {
+                    if (sumOfMinBounds - minBounds[i] + bounds[i][k] > 2 * incumbentCost) {
+                        QL_ASSERT(k != fac2r[i]);
+                        allowed[i][k] = false;
+                        prunedCount++;
+                    }
+                }
+            }
+            QL_DOUT(
+                "Pruned " << prunedCount << " of " << nfac * qubitsCount
+                << " facility/location pairs"
+            );
+        }
+    }
 
+    // The model is written even when the solver is skipped, such that the
+    // option behaves the same regardless of warm_start. In that case nothing
+    // was pruned, so the model is the complete one.
+    std::unique_ptr<HighsModel> model;
+    if (solveMip || opts.write_model_to_file) {
+        model = createHiGHSModel(refcount, allowed);
+    }
     if (opts.write_model_to_file) {
         FilereaderMps().writeModelToFile(HighsOptions(), opts.model_filename, *model);
         writeLpMatrixPicToFile(HighsOptions(), "LpMatrix", model->lp_);
     }
-    
-    Highs highs;
-    highs.passModel(*model);
 
-    static constexpr double MIN_TIMEOUT = 0.0000001;
-    if (opts.timeout > MIN_TIMEOUT) {
-        highs.setOptionValue("time_limit", opts.timeout);
-    }
+    if (solveMip) {
+        Highs highs;
+        highs.passModel(*model);
 
-    std::chrono::high_resolution_clock::time_point time_at_start = std::chrono::high_resolution_clock::now();
-
-    auto return_status = highs.run();
+        static constexpr double MIN_TIMEOUT = 0.0000001;
+        if (opts.timeout > MIN_TIMEOUT) {
+            highs.setOptionValue("time_limit", opts.timeout);
+        }
 
-    if (return_status != HighsStatus::kOk) {
-        if (highs.getModelStatus() == HighsModelStatus::kTimeLimit) {
-            return Result::TIMED_OUT;
+        // Pass the heuristic placement to the solver as its initial feasible
+        // solution. The w[i][k] values follow from the x[i][k] values.
+        if (opts.warm_start) {
+            HighsSolution start;
+            start.col_value.resize(model->lp_.num_col_, 0.);
+            for (UInt i = 0; i < nfac; ++i) {
+                auto k = fac2r[i];
+                start.col_value[i * qubitsCount + k] = 1.;
+                UInt w = 0;
+                for (UInt j = 0; j < nfac; ++j) {
+                    w += refcount[i][j] * distanceProvider(k, fac2r[j]);
+                }
+                start.col_value[nfac * qubitsCount + i * qubitsCount + k] = w;
+            }
+            highs.setSolution(start);
         }
-        return Result::FAILED;
-    }
-    
-    std::chrono::high_resolution_clock::time_point time_at_end = std::chrono::high_resolution_clock::now();
-    auto time_span = time_at_end - time_at_start;
-    time_taken = time_span.count();
 
-    const HighsSolution& solution = highs.getSolution();
-    
-    // highs.writeInfo("highs_initial_placement_info.txt");
+        std::chrono::high_resolution_clock::time_point time_at_start = std::chrono::high_resolution_clock::now();
 
-    // *** Reconstruct mapping with MIP solution ***
-    // Fill v2r with mapped facilities.
-    for (UInt fac = 0; fac < nfac; fac++) {
-        UInt real_qubit = 0;
-        for (; real_qubit < qubitsCount; real_qubit++) {
-            if (std::abs(solution.col_value[fac * qubitsCount + real_qubit] - 1) < EPSILON) {
-                QL_ASSERT(fac2v[fac] < qubitsCount);
-                QL_ASSERT(v2r[fac2v[fac]] == UNDEFINED_QUBIT);
-
-                v2r[fac2v[fac]] = real_qubit;
-                break;
+        auto return_status = highs.run();
+
+        std::chrono::high_resolution_clock::time_point time_at_end = std::chrono::high_resolution_clock::now();
+        time_taken = std::chrono::duration<Real>(time_at_end - time_at_start).count();
+
+        Bool timedOut = false;
+        if (return_status != HighsStatus::kOk) {
+            if (highs.getModelStatus() != HighsModelStatus::kTimeLimit) {
+                return Result::FAILED;
             }
+            if (!opts.warm_start) {
+                return Result::TIMED_OUT;
+            }
+            timedOut = true;
         }
 
-        QL_ASSERT(real_qubit < qubitsCount && "Each facility has to be allocated (problem constraint)");
+        // *** Reconstruct mapping with MIP solution ***
+        // When the solver timed out, it may still have found a placement that
+        // improves on the heuristic one; if not, the latter is used as-is.
+        const HighsSolution& solution = highs.getSolution();
+        Vec<UInt> solutionFac2r(nfac, UNDEFINED_QUBIT);
+        Bool complete = solution.value_valid;
+        for (UInt fac = 0; complete && fac < nfac; fac++) {
+            for (UInt real_qubit = 0; real_qubit < qubitsCount; real_qubit++) {
+                if (std::abs(solution.col_value[fac * qubitsCount + real_qubit] - 1) < EPSILON) {
+                    solutionFac2r[fac] = real_qubit;
+                    break;
+                }
+            }
+            complete = solutionFac2r[fac] != UNDEFINED_QUBIT;
+        }
+
+        if (complete) {
+            fac2r = solutionFac2r;
+        } else {
+            QL_ASSERT(timedOut && "Each facility has to be allocated (problem constraint)");
+        }
+        if (timedOut) {
+            QL_WOUT(
+                "MIP solver for initial placement timed out after " << time_taken
+                << "s, using the best placement found so far, which may not be optimal"
+            );
+        }
+    }
+
+    // Fill v2r with mapped facilities.
+    for (UInt fac = 0; fac < nfac; fac++) {
+        QL_ASSERT(fac2v[fac] < qubitsCount);
+        QL_ASSERT(fac2r[fac] < qubitsCount);
+        QL_ASSERT(v2r[fac2v[fac]] == UNDEFINED_QUBIT);
+        v2r[fac2v[fac]] = fac2r[fac];
     }
 
     // Allocate randomly remaining virtual qubits, while trying to preserve the original circuit if possible.
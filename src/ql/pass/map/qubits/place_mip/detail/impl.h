@@ -50,6 +50,15 @@ struct Options {
      * If false, in case of timeout, the pass does not update qubit indices.
      */
     utils::Bool fail_on_timeout = true;
+
+    /**
+     * Whether to compute a heuristic placement before running the MIP solver.
+     * This placement is passed to the solver as its initial feasible solution,
+     * is used to prune facility/location pairs that cannot be part of a
+     * better solution, and is returned as-is if the solver times out or if
+     * it is provably optimal already.
+     */
+    utils::Bool warm_start = false;
 };
 
 /**
@@ -118,6 +127,47 @@ private:
      */
     std::unique_ptr<HighsModel> createHiGHSModel(const utils::Vec<utils::Vec<utils::UInt>> &refcount);
 
+    /**
+     * Same as above, but only includes the facility/location pairs for which
+     * allowed[i][k] is set. The x[i][k] and w[i][k] variables of the other
+     * pairs are fixed to zero, and the linearization constraints for them
+     * are omitted.
+     */
+    std::unique_ptr<HighsModel> createHiGHSModel(
+        const utils::Vec<utils::Vec<utils::UInt>> &refcount,
+        const utils::Vec<utils::Vec<utils::Bool>> &allowed
+    );
+
+    /**
+     * Returns the matrix of distances between all pairs of locations.
+     */
+    utils::Vec<utils::Vec<utils::UInt>> computeDistances();
+
+    /**
+     * Computes a placement of the facilities on the locations (fac2r) using
+     * a multi-start greedy construction followed by a local search that moves
+     * facilities to free locations and exchanges pairs of facilities.
+     * weights is the symmetric interaction count matrix between facilities.
+     * Locations equal to the original virtual qubit index are preferred when
+     * there is a tie, such that qubits are not moved needlessly.
+     */
+    utils::Vec<utils::UInt> computeHeuristicPlacement(
+        const utils::Vec<utils::Vec<utils::UInt>> &weights,
+        const utils::Vec<utils::Vec<utils::UInt>> &distances,
+        const utils::Vec<utils::UInt> &fac2v
+    );
+
+    /**
+     * Computes the Gilmore-Lawler lower bound on the cost contribution of
+     * each facility i when placed on location k, counting each interaction
+     * from both ends (so the actual cost is at least half the sum of the
+     * bounds of all facilities).
+     */
+    utils::Vec<utils::Vec<utils::UInt>> computeLowerBounds(
+        const utils::Vec<utils::Vec<utils::UInt>> &weights,
+        const utils::Vec<utils::Vec<utils::UInt>> &distances
+    );
+
     /**
      * Number of locations, real qubits; index variables k and l.
      */
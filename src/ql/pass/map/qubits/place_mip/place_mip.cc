@@ -76,6 +76,24 @@ void PlaceQubitsPass::dump_docs(
     different two-qubit gates considered by the solver to the first N for each kernel;
     - a timeout may be specified.
 
+    Unless disabled with the "warm_start" option, a heuristic placement is
+    computed before the solver is run. For each possible location of the
+    facility with the most interactions, a placement is constructed by
+    repeatedly placing the facility that interacts most with the already-placed
+    ones on the free location that minimizes the cost so far; the cheapest of
+    these is then improved by moving facilities to free locations and
+    exchanging pairs of facilities. This placement is then used as follows:
+    - when its cost equals the Gilmore-Lawler lower bound of the problem, it
+    is optimal, and the solver is not run at all;
+    - otherwise, all x[i][k] for which the lower bound with facility i fixed
+    to location k exceeds the cost of the heuristic placement are fixed to 0,
+    and their linearization constraints are omitted from the model;
+    - it is passed to the solver as its initial feasible solution;
+    - when the solver times out, the best placement found so far (at worst
+    the heuristic one) is used.
+    This makes the pass usable for larger numbers of qubits, at the cost of
+    possibly returning a non-optimal placement when the solver times out.
+
     )asdf");
 }
 
@@ -105,14 +123,17 @@ PlaceQubitsPass::PlaceQubitsPass(
     options.add_real(
         "timeout",
         "A float duration in seconds after which the MIP problem resolution by HiGHS will terminate. "
-        "If this happens, the pass will emit a warning and will not update the qubit indices. "
+        "If this happens, the pass will emit a warning, and will use the best placement found so far "
+        "when warm_start is enabled or will not update the qubit indices otherwise. "
         "When set to 0, there is no time limit.",
         "0.", 0., utils::INF
     );
     options.add_bool(
         "write_model_to_file",
         "Whether to write the model as MPS format to a file, as well as a pixel array representing the "
-        "matrice of the linear optimization problem.",
+        "matrice of the linear optimization problem. The model is also written when warm_start finds "
+        "an optimal placement and the MIP solver is skipped; it then includes all facility/location "
+        "pairs, since none were ruled out.",
         true
     );
     options.add_str(
@@ -122,7 +143,17 @@ PlaceQubitsPass::PlaceQubitsPass(
     );
     options.add_bool(
         "fail_on_timeout",
-        "Whether to exit compilation with an error when the MIP solving times out.",
+        "Whether to exit compilation with an error when the MIP solving times out "
+        "without a placement. This cannot happen when warm_start is enabled.",
+        true
+    );
+    options.add_bool(
+        "warm_start",
+        "Whether to compute a heuristic placement first, which is passed to "
+        "the MIP solver as its initial solution and is used to rule out "
+        "facility/location pairs that cannot lead to a better placement. The "
+        "solver is skipped entirely when the heuristic placement is provably "
+        "optimal.",
         true
     );
 }
@@ -158,6 +189,7 @@ utils::Int PlaceQubitsPass::run(
     opts.write_model_to_file = options["write_model_to_file"].as_bool();
     opts.model_filename = options["model_filename"].as_str();
     opts.fail_on_timeout = options["fail_on_timeout"].as_bool();
+    opts.warm_start = options["warm_start"].as_bool();
 
     auto qubit_count = ir->platform->qubits->shape[0];
     
@@ -23,7 +23,7 @@ protected:
             REQUIRE_LE(q1, utils::MAX);
             REQUIRE_LE(q2, utils::MAX);
             return q1 == q2 ? 0 : distances[q1][q2];
-        }, {}};
+        }, options};
 
         auto actual = impl.run(mapping);
 
@@ -165,6 +165,10 @@ protected:
         return qubitsCount;
     }
 
+    void enableWarmStart() {
+        options.warm_start = true;
+    }
+
 private:
     void init(utils::UInt aQubitsCount) {
         REQUIRE_EQ(qubitsCount, 0);
@@ -181,6 +185,7 @@ private:
     std::vector<std::vector<utils::UInt>> distances;
     Impl::TwoQGatesCount twoQGatesCount{};
     utils::Vec<utils::UInt> mapping;
+    Options options{};
 };
 
 TEST_CASE_FIXTURE(IpTest, "Star with no 2Q gate") {
@@ -388,6 +393,54 @@ TEST_CASE_FIXTURE(IpTest, "Very long line, find permutation of N qubits") {
     }
 }
 
+TEST_CASE_FIXTURE(IpTest, "Warm start") {
+    enableWarmStart();
+
+    SUBCASE("Grid, find complex permutation") {
+        setupGrid();
+
+        add2QGate(3, 5);
+        add2QGate(5, 0);
+        add2QGate(0, 4);
+        add2QGate(4, 1);
+        add2QGate(5, 1);
+        add2QGate(1, 2);
+        add2QGate(2, 3);
+
+        computeAndCheckResultType(Result::NEW_MAP);
+
+        checkAllMappedGatesAreNearestNeighbors();
+    }
+
+    SUBCASE("Line of more qubits than the MIP solver can handle on its own") {
+        setupLine(40);
+
+        // Same interactions as in the "Very long line" test case; the
+        // heuristic placement is provably optimal here, so the MIP solver
+        // isn't needed.
+        for (utils::UInt i = 0; i <= getQubitsCount() / 2 - 2; ++i) {
+            add2QGate(i, getQubitsCount() - 1 - i, 2 + i % 5);
+            add2QGate(getQubitsCount() - 1 - i, i + 1, 3 + i % 5);
+        }
+        add2QGate(getQubitsCount() / 2 - 1, getQubitsCount() / 2, 4);
+
+        computeAndCheckResultType(Result::NEW_MAP);
+
+        checkAllMappedGatesAreNearestNeighbors();
+    }
+
+    SUBCASE("No perfect solution") {
+        setupStar();
+
+        add2QGate(1, 2, 5);
+        add2QGate(3, 4, 10);
+
+        computeAndCheckResultType(Result::NEW_MAP);
+
+        checkAtLeastOneMappedGateIsNonNN();
+    }
+}
+
 TEST_CASE("Horizon") {
     Impl::TwoQGatesCount twoQGatesCount{};
 
@@ -5,7 +5,8 @@
 #include "clifford.h"
 
 #include "ql/utils/num.h"
-#include "ql/com/options.h"
+#include "ql/ir/ops.h"
+#include "ql/ir/old_to_new.h"
 
 namespace ql {
 namespace pass {
@@ -17,46 +18,299 @@ namespace detail {
 using namespace utils;
 
 /**
- * Create gate sequences for all accumulated cliffords, output them and
- * reset state.
+ * Clifford state transition table.
+ *
+ * [from state][accumulating sequence represented as state] => new state
+ */
+const Int Clifford::TRANSITION_TABLE[24][24] = {
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,16,17,18,19,20,21,22,23 },
+    {  1, 2, 0,10,11, 9, 4, 5, 3, 7, 8, 6,23,21,22,14,12,13,20,18,19,17,15,16 },
+    {  2, 0, 1, 8, 6, 7,11, 9,10, 5, 3, 4,16,17,15,22,23,21,19,20,18,13,14,12 },
+    {  3, 4, 5, 0, 1, 2, 9,10,11, 6, 7, 8,15,16,17,12,13,14,21,22,23,18,19,20 },
+    {  4, 5, 3, 7, 8, 6, 1, 2, 0,10,11, 9,20,18,19,17,15,16,23,21,22,14,12,13 },
+    {  5, 3, 4,11, 9,10, 8, 6, 7, 2, 0, 1,13,14,12,19,20,18,22,23,21,16,17,15 },
+    {  6, 7, 8, 9,10,11, 0, 1, 2, 3, 4, 5,18,19,20,21,22,23,12,13,14,15,16,17 },
+    {  7, 8, 6, 4, 5, 3,10,11, 9, 1, 2, 0,17,15,16,20,18,19,14,12,13,23,21,22 },
+    {  8, 6, 7, 2, 0, 1, 5, 3, 4,11, 9,10,22,23,21,16,17,15,13,14,12,19,20,18 },
+    {  9,10,11, 6, 7, 8, 3, 4, 5, 0, 1, 2,21,22,23,18,19,20,15,16,17,12,13,14 },
+    { 10,11, 9, 1, 2, 0, 7, 8, 6, 4, 5, 3,14,12,13,23,21,22,17,15,16,20,18,19 },
+    { 11, 9,10, 5, 3, 4, 2, 0, 1, 8, 6, 7,19,20,18,13,14,12,16,17,15,22,23,21 },
+    { 12,13,14,21,22,23,18,19,20,15,16,17, 0, 1, 2, 9,10,11, 6, 7, 8, 3, 4, 5 },
+    { 13,14,12,16,17,15,22,23,21,19,20,18, 5, 3, 4, 2, 0, 1, 8, 6, 7,11, 9,10 },
+    { 14,12,13,20,18,19,17,15,16,23,21,22,10,11, 9, 4, 5, 3, 7, 8, 6, 1, 2, 0 },
+    { 15,16,17,18,19,20,21,22,23,12,13,14, 3, 4, 5, 6, 7, 8, 9,10,11, 0, 1, 2 },
+    { 16,17,15,13,14,12,19,20,18,22,23,21, 2, 0, 1, 5, 3, 4,11, 9,10, 8, 6, 7 },
+    { 17,15,16,23,21,22,14,12,13,20,18,19, 7, 8, 6, 1, 2, 0,10,11, 9, 4, 5, 3 },
+    { 18,19,20,15,16,17,12,13,14,21,22,23, 6, 7, 8, 3, 4, 5, 0, 1, 2, 9,10,11 },
+    { 19,20,18,22,23,21,16,17,15,13,14,12,11, 9,10, 8, 6, 7, 2, 0, 1, 5, 3, 4 },
+    { 20,18,19,14,12,13,23,21,22,17,15,16, 4, 5, 3,10,11, 9, 1, 2, 0, 7, 8, 6 },
+    { 21,22,23,12,13,14,15,16,17,18,19,20, 9,10,11, 0, 1, 2, 3, 4, 5, 6, 7, 8 },
+    { 22,23,21,19,20,18,13,14,12,16,17,15, 8, 6, 7,11, 9,10, 5, 3, 4, 2, 0, 1 },
+    { 23,21,22,17,15,16,20,18,19,14,12,13, 1, 2, 0, 7, 8, 6, 4, 5, 3,10,11, 9 }
+};
+
+/**
+ * Names of the instruction types used for the primitives, and their cQASM
+ * names in case they need to be added to the platform. These are the names of
+ * the default gates of the old IR that were used for this purpose.
+ */
+static const char *PRIMITIVE_NAMES[] = {
+    "rx180", "ry180", "rx90", "mrx90", "ry90", "mry90"
+};
+static const char *PRIMITIVE_CQASM_NAMES[] = {
+    "x180", "y180", "x90", "mx90", "y90", "my90"
+};
+
+/**
+ * Duration of the default gates of the old IR in nanoseconds.
  */
-void Clifford::sync_all(const ir::compat::KernelRef &k) {
+static const UInt DEFAULT_GATE_DURATION = 40;
+
+/**
+ * Constructs a Clifford optimizer for the given IR. This builds the
+ * instruction type to Clifford state mapping for the platform.
+ */
+Clifford::Clifford(
+    const ir::Ref &ir,
+    Bool commute
+) :
+    ir(ir),
+    commute(commute),
+    gatherer(ir),
+    total_saved(0)
+{
+    for (const auto &type : ir->platform->instructions) {
+        add_instruction_type(type, gate2cs(type->name));
+    }
+    auto nq = ir::get_num_qubits(ir);
+    cliffstate.resize(nq, 0);       // 0 is identity; for all qubits accumulated state is set to identity
+    cliffcycles.resize(nq, 0);      // for all qubits, no accumulated cycles
+}
+
+/**
+ * Records the Clifford state of the given instruction type and all its
+ * specializations in clifford_states, if it is a single-qubit Clifford.
+ */
+void Clifford::add_instruction_type(const One<ir::InstructionType> &type, Int cs) {
+    if (cs < 0) {
+        return;
+    }
+
+    // Only the generalized type has the full prototype. Specializations
+    // inherit the classification of their generalization.
+    if (type->generalization.empty()) {
+        if (
+            type->operand_types.size() != 1 ||
+            !(type->operand_types[0]->data_type == ir->platform->qubits->data_type)
+        ) {
+            return;
+        }
+    }
+
+    clifford_states.set(type.get_ptr().get()) = cs;
+    for (const auto &spec : type->specializations) {
+        add_instruction_type(spec, cs);
+    }
+}
+
+/**
+ * Returns the generalized instruction type for the given primitive.
+ */
+const ir::InstructionTypeLink &Clifford::get_primitive(Primitive primitive) {
+    auto &link = primitives[primitive];
+    if (!link.empty()) {
+        return link;
+    }
+    const auto &qubit_type = ir->platform->qubits->data_type;
+    link = ir::find_instruction_type(
+        ir, PRIMITIVE_NAMES[primitive], {qubit_type}, {true}, true
+    );
+    if (link.empty()) {
+
+        // The platform doesn't define the gate, so infer an instruction type
+        // for it in the same way that the old-to-new IR conversion does for
+        // the default gates of the old IR.
+        UInt cycle_time = 0;
+        const auto &json = ir->platform->data.data;
+        auto hw = json.find("hardware_settings");
+        if (hw != json.end() && hw->is_object()) {
+            auto ct = hw->find("cycle_time");
+            if (ct != hw->end() && ct->is_number_unsigned()) {
+                cycle_time = ct->get<UInt>();
+            }
+        }
+        auto ityp = make<ir::InstructionType>(
+            PRIMITIVE_NAMES[primitive],
+            PRIMITIVE_CQASM_NAMES[primitive]
+        );
+        ityp->duration = cycle_time ? div_ceil(DEFAULT_GATE_DURATION, cycle_time) : 1;
+        ityp->operand_types.emplace(
+            (primitive == X180 || primitive == X90 || primitive == MX90)
+                ? ir::prim::OperandMode::COMMUTE_X
+                : ir::prim::OperandMode::COMMUTE_Y,
+            qubit_type
+        );
+        link = ir::add_instruction_type(ir, ityp);
+        add_instruction_type(ityp, gate2cs(ityp->name));
+
+    } else {
+        link = ir::get_generalization(link);
+    }
+    return link;
+}
+
+/**
+ * Create gate sequences for all accumulated cliffords, append them to the
+ * output and reset state.
+ */
+void Clifford::sync_all(Any<ir::Statement> &output, Int cycle) {
     QL_DOUT("... sync_all");
-    for (UInt q = 0; q < nq; q++) {
-        sync(k, q);
+    for (UInt q = 0; q < cliffstate.size(); q++) {
+        sync(output, cycle, q);
     }
     QL_DOUT("... sync_all DONE");
 }
 
 /**
- * Create gate sequence for accumulated cliffords of qubit q, output it and
- * reset state.
+ * Create gate sequence for accumulated cliffords of qubit q, append it to
+ * the output and reset state.
  */
-void Clifford::sync(const ir::compat::KernelRef &k, UInt q) {
+void Clifford::sync(Any<ir::Statement> &output, Int cycle, UInt q) {
     Int csq = cliffstate[q];
     if (csq != 0) {
         QL_DOUT("... sync q[" << q << "]: generating clifford " << cs2string(csq));
-        k->clifford(csq, q);          // generates clifford(csq) in kernel.c
-        UInt  acc_cycles = cliffcycles[q];
-        UInt  ins_cycles = cs2cycles(csq);
+        for (auto primitive : cs2primitives(csq)) {
+            auto custom = make<ir::CustomInstruction>();
+            custom->instruction_type = get_primitive(primitive);
+            custom->operands.add(ir::make_qubit_ref(ir, q));
+            custom->condition = ir::make_bit_lit(ir, true);
+            custom->cycle = cycle;
+            ir::InstructionRef insn = custom;
+            ir::specialize_instruction(insn);
+            output.add(insn);
+        }
+        UInt acc_cycles = cliffcycles[q];
+        UInt ins_cycles = cs2cycles(csq);
         QL_DOUT("... qubit q[" << q << "]: accumulated: " << acc_cycles << ", inserted: " << ins_cycles);
-        if (acc_cycles > ins_cycles) QL_DOUT("... qubit q[" << q << "]: saved " << (acc_cycles - ins_cycles) << " cycles");
-        if (acc_cycles < ins_cycles) QL_DOUT("... qubit q[" << q << "]: additional " << (ins_cycles - acc_cycles) << " cycles");
-        total_saved += acc_cycles-ins_cycles;
+        total_saved += (Int)acc_cycles - (Int)ins_cycles;
+    } else if (cliffcycles[q]) {
+        QL_DOUT("... qubit q[" << q << "]: sequence reduced to identity, saved " << cliffcycles[q] << " cycles");
+        total_saved += (Int)cliffcycles[q];
     }
     cliffstate[q] = 0;
     cliffcycles[q] = 0;
 }
 
 /**
- * Find the clifford state from identity to given gate, or return -1 if
- * unknown or the gate is not in C1.
+ * Handles a statement that is not a Clifford gate: synchronizes all qubits
+ * it uses that the accumulated state doesn't commute with.
+ */
+void Clifford::sync_for(
+    Any<ir::Statement> &output,
+    const ir::StatementRef &statement
+) {
+
+    // Gather the qubits accessed by the statement, and how they are
+    // accessed. Anything that may access all state, or that accesses qubits
+    // in a way we can't determine statically, synchronizes everything.
+    gatherer.reset();
+    gatherer.add_statement(statement);
+    Map<UInt, com::ddg::AccessMode> modes;
+    for (const auto &event : gatherer.get()) {
+        const auto &ref = event.first;
+        if (ref.is_global_state()) {
+            sync_all(output, statement->cycle);
+            return;
+        }
+        if (
+            !(ref.target == ir->platform->qubits) ||
+            !(ref.data_type == ir->platform->qubits->data_type)
+        ) {
+            continue;
+        }
+        if (ref.indices.size() != 1) {
+            sync_all(output, statement->cycle);
+            return;
+        }
+        modes.set(ref.indices[0]) = event.second;
+    }
+
+    // Synchronize in operand order where possible, such that the order of
+    // the generated gates is stable.
+    Vec<UInt> qubits;
+    if (statement->as_custom_instruction()) {
+        for (const auto &operand : ir::get_operands(statement.as<ir::Instruction>())) {
+            auto ref = operand->as_reference();
+            if (
+                ref &&
+                ref->target == ir->platform->qubits &&
+                ref->data_type == ir->platform->qubits->data_type &&
+                ref->indices.size() == 1 &&
+                ref->indices[0]->as_int_literal()
+            ) {
+                qubits.push_back(ref->indices[0]->as_int_literal()->value);
+            }
+        }
+    }
+    for (const auto &mode : modes) {
+        qubits.push_back(mode.first);
+    }
+    for (auto q : qubits) {
+        auto it = modes.find(q);
+        if (it == modes.end()) {
+            continue;
+        }
+        if (commute && cs_commutes_with(cliffstate[q], it->second)) {
+            QL_DOUT("... " << cs2string(cliffstate[q]) << " on q[" << q << "] commutes; not synchronizing");
+        } else {
+            sync(output, statement->cycle, q);
+        }
+        modes.erase(it);
+    }
+
+}
+
+/**
+ * If the given statement is an unconditional single-qubit Clifford gate,
+ * returns its Clifford state and sets qubit accordingly. Otherwise,
+ * returns -1.
+ */
+Int Clifford::get_clifford(const ir::StatementRef &statement, UInt &qubit) const {
+    auto custom = statement->as_custom_instruction();
+    if (!custom) {
+        return -1;
+    }
+    auto it = clifford_states.find(custom->instruction_type.get_ptr().get());
+    if (it == clifford_states.end()) {
+        return -1;
+    }
+    auto cond = custom->condition->as_bit_literal();
+    if (!cond || !cond->value) {
+        return -1;
+    }
+    auto operands = ir::get_operands(statement.as<ir::Instruction>());
+    QL_ASSERT(operands.size() == 1);
+    auto ref = operands[0]->as_reference();
+    if (
+        !ref ||
+        !(ref->target == ir->platform->qubits) ||
+        ref->indices.size() != 1 ||
+        !ref->indices[0]->as_int_literal()
+    ) {
+        return -1;
+    }
+    qubit = ref->indices[0]->as_int_literal()->value;
+    return it->second;
+}
+
+/**
+ * Find the clifford state from identity to a gate with the given name, or
+ * return -1 if unknown or the gate is not in C1.
  *
  * TODO: this currently infers the Clifford index by gate name; instead
  *  semantics like this should be in the config file somehow.
  */
-Int Clifford::gate2cs(const ir::compat::GateRef &gate) {
-    auto gname = gate->name;
+Int Clifford::gate2cs(const Str &gname) {
     if (gname == "identity")         return 0;
     else if (gname == "i")           return 0;
     else if (gname == "pauli_x")     return 3;
@@ -124,6 +378,40 @@ UInt Clifford::cs2cycles(Int cs) {
     }
 }
 
+/**
+ * Returns the minimal sequence of primitive gates corresponding to the given
+ * clifford state.
+ */
+Vec<Clifford::Primitive> Clifford::cs2primitives(Int cs) {
+    switch(cs) {
+        case 0 : return {};
+        case 1 : return {Y90, X90};
+        case 2 : return {MX90, MY90};
+        case 3 : return {X180};
+        case 4 : return {MY90, MX90};
+        case 5 : return {X90, MY90};
+        case 6 : return {Y180};
+        case 7 : return {MY90, X90};
+        case 8 : return {X90, Y90};
+        case 9 : return {X180, Y180};
+        case 10: return {Y90, MX90};
+        case 11: return {MX90, Y90};
+        case 12: return {Y90, X180};
+        case 13: return {MX90};
+        case 14: return {X90, MY90, MX90};
+        case 15: return {MY90};
+        case 16: return {X90};
+        case 17: return {X90, Y90, X90};
+        case 18: return {MY90, X180};
+        case 19: return {X90, Y180};
+        case 20: return {X90, MY90, X90};
+        case 21: return {Y90};
+        case 22: return {MX90, Y180};
+        case 23: return {X90, Y90, MX90};
+        default: QL_ICE("invalid clifford state " << cs);
+    }
+}
+
 // return the gate sequence as string for debug output corresponding to given clifford state
 Str Clifford::cs2string(Int cs) {
     switch(cs) {
@@ -156,104 +444,117 @@ Str Clifford::cs2string(Int cs) {
 }
 
 /**
- * Optimizes the given kernel, returning how many cycles were saved.
+ * Returns whether the given clifford state commutes with an access to the
+ * qubit in the given mode. The states that commute with anything other than
+ * themselves are the identity and the rotations about a single axis (the
+ * Paulis and the 90-degree rotations).
  */
-utils::UInt Clifford::optimize_kernel(const ir::compat::KernelRef &kernel) {
-    QL_DOUT("clifford_optimize_kernel()");
-
-    nq = kernel->qubit_count;
-    ct = kernel->platform->cycle_time;
-    QL_DOUT("Clifford optimizer on kernel " << kernel->name << " ...");
-
-    // copy circuit kernel.c to take input from;
-    // output will fill kernel.c again
-    auto input_gates = kernel->gates;
-    kernel->gates.reset();
+Bool Clifford::cs_commutes_with(Int cs, const com::ddg::AccessMode &mode) {
+    switch (cs) {
+        case 0:
+            return true;
+        case 3: case 13: case 16:
+            return com::ddg::AccessMode(ir::prim::OperandMode::COMMUTE_X).commutes_with(mode);
+        case 6: case 15: case 21:
+            return com::ddg::AccessMode(ir::prim::OperandMode::COMMUTE_Y).commutes_with(mode);
+        case 9: case 14: case 23:
+            return com::ddg::AccessMode(ir::prim::OperandMode::COMMUTE_Z).commutes_with(mode);
+        default:
+            return false;
+    }
+}
 
-    cliffstate.resize(nq, 0);       // 0 is identity; for all qubits accumulated state is set to identity
-    cliffcycles.resize(nq, 0);      // for all qubits, no accumulated cycles
-    total_saved = 0;                // reset saved, just for reporting
+/**
+ * Optimizes the given block and its sub-blocks, returning how many cycles
+ * were saved.
+ */
+Int Clifford::optimize_block(const ir::BlockBaseRef &block) {
+    QL_DOUT("Clifford optimizer on block ...");
+    auto saved_before = total_saved;
 
     /*
     The main idea of this optimization is that there are 24 clifford gates and these form a group,
     i.e. any sequence of clifford gates is in effect equivalent to one clifford from the group.
 
-    Make a linear scan from begin to end over the circuit;
+    Make a linear scan from begin to end over the block;
     attempt to find sequences of consecutive clifford gates operating on qubit q;
     these series can be interwoven, so have to be found in parallel.
     Each sequence can potentially be replaced by an equivalent shorter one from the group of 24 cliffords,
     reducing the number of cycles that the sequence takes, the circuit latency and the gate count.
 
     The clifford group is represented by:
-    - Int string2cs(Str gname): the clifford state of a gate with the given name; identity is 0
-    - a state diagram clifftrans[24][24] that represents for two given clifford (sequences),
+    - clifford_states: the clifford state of each single-qubit clifford instruction type; identity is 0
+    - a state diagram TRANSITION_TABLE[24][24] that represents for two given clifford (sequences),
       to which clifford the combination is equivalent to;
-      so clifford(sequence1; sequence2) == clifftrans[clifford(sequence1)][clifford(sequence2)].
-    - UInt cs2cycles(Int cs): the minimum number of cycles needed to implement a clifford of state cs
-    - void k.clifford(Int csq, UInt q): generates minimal clifford sequence for state csq and qubit q
+      so clifford(sequence1; sequence2) == TRANSITION_TABLE[clifford(sequence1)][clifford(sequence2)].
+    - cs2cycles(Int cs): the minimum number of cycles needed to implement a clifford of state cs
+    - cs2primitives(Int cs): the minimal gate sequence for state cs
 
     Therefore, maintain for each qubit q while scanning:
     - cliffstate[q]:    clifford state of sequence until now per qubit; initially identity
     - cliffcycles[q]:   number of cycles of the sequence until now per qubit; initially 0
     Each time a clifford c is encountered for qubit q, the clifford c is incorporated into cliffstate[q]
-    by making the transition: cliffstate[q] = clifftrans[cliffstate[q]][string2cs(c)],
+    by making the transition: cliffstate[q] = TRANSITION_TABLE[cliffstate[q]][cs(c)],
     and updating cliffcycles[q].
-    And when finding a gate that ends a sequence of cliffords ('synchronization point'),
-    the minimal sequence corresponding to the accumulated sequence is output before the new gate.
-
-    While scanning the circuit having accumulated the clifford state, for each next gate split out:
-    - those potentially affecting all qubits: push out all state, clearing all accumulated state
-    - those affecting a particular set of qubits: for those qubits, push out state, clearing their state
-    - those affecting a single qubit but not being a clifford: push out state for that qubit, clearing it
-    - those affecting a single qubit and being a conditional gate: push out state for that qubit, clearing it
-    - remaining case is a single qubit clifford: add it to the state
+    And when finding a statement that ends a sequence of cliffords ('synchronization point'),
+    the minimal sequence corresponding to the accumulated sequence is output before it.
+
+    While scanning the block having accumulated the clifford state, for each next statement split out:
+    - structured control-flow and statements potentially affecting all qubits: push out all state
+    - those affecting a particular set of qubits: for those qubits, push out state, clearing their state;
+      if commutation is enabled, qubits for which the accumulated state commutes with the way the
+      statement uses the qubit (as defined by the operand modes used for the data dependency graph)
+      are not synchronized, so the sequence can continue after the statement
+    - remaining case is an unconditional single qubit clifford: add it to the state
     */
-    for (const auto &gate : input_gates) {
-        QL_DOUT("... gate: " << gate->qasm());
+    Any<ir::Statement> output;
+    Bool modified = false;
+    Int cycle = 0;
+    for (const auto &statement : block->statements) {
+        cycle = statement->cycle;
 
-        if (
-            gate->type() == ir::compat::GateType::CLASSICAL       // classical gates (really being pessimistic here about these)
-            || gate->operands.empty()                             // gates without operands which may affect ALL qubits
-        ) {
-            // sync all qubits: create gate sequences corresponding to what was accumulated in cliffstate, for all qubits
-            sync_all(kernel);
-            kernel->gates.add(gate);
-        } else if (gate->operands.size() != 1) {                 // gates like CNOT/CZ/TOFFOLI
-            // sync particular qubits: create gate sequences corresponding to what was accumulated in cliffstate, for those particular operand qubits
-            for (auto q : gate->operands) {
-                sync(kernel, q);
-            }
-            kernel->gates.add(gate);
+        // Accumulate unconditional single-qubit Clifford gates.
+        UInt q;
+        auto cs = get_clifford(statement, q);
+        if (cs >= 0) {
+            cliffcycles[q] += ir::get_duration_of_statement(statement);
+            Int csq = cliffstate[q];
+            QL_DOUT("... from " << cs2string(csq) << " to " << cs2string(TRANSITION_TABLE[csq][cs]));
+            cliffstate[q] = TRANSITION_TABLE[csq][cs];
+            modified = true;
+            continue;
+        }
+
+        // Synchronize before anything else.
+        if (statement.as<ir::Instruction>().empty()) {
+            sync_all(output, cycle);
         } else {
-            // unary quantum gates like x/y/z/h/xm90/y90/s/wait/meas/prepz
-            UInt q = gate->operands[0];
-            Int cs = gate2cs(gate);
-            if (
-                cs == -1                                        // non-clifford unary gates (wait, meas, prepz, ...)
-                || gate->is_conditional()                         // conditional unary (clifford) gates
-            ) {
-                // sync particular single qubit: create gate sequence corresponding to what was accumulated in cliffstate, for this particular operand qubit
-                QL_DOUT("... unary gate not a clifford gate or conditional: " << gate->qasm());
-                sync(kernel, q);
-                kernel->gates.add(gate);
-            } else {
-                // unary quantum clifford gates like x/y/z/h/xm90/y90/s/...
-                // don't emit gate but accumulate gate in cliffstate
-                // also record accumulated cycles to compute savings
-                cliffcycles[q] += (gate->duration + ct - 1) / ct;
-                Int csq = cliffstate[q];
-                QL_DOUT("... from " << cs2string(csq) << " to " << cs2string(TRANSITION_TABLE[csq][cs]));
-                cliffstate[q] = TRANSITION_TABLE[csq][cs];
+            sync_for(output, statement);
+        }
+        output.add(statement);
+
+        // Recurse into structured control-flow sub-blocks.
+        if (auto if_else = statement->as_if_else()) {
+            for (const auto &branch : if_else->branches) {
+                optimize_block(branch->body);
             }
+            if (!if_else->otherwise.empty()) {
+                optimize_block(if_else->otherwise);
+            }
+        } else if (auto loop = statement->as_loop()) {
+            optimize_block(loop->body);
         }
-        QL_DOUT("... gate: " << gate->qasm() << " DONE");
+
     }
-    sync_all(kernel);
-    kernel->cycles_valid = false;
+    sync_all(output, cycle);
 
-    QL_DOUT("Clifford optimizer on kernel " << kernel->name << " saved " << total_saved << " cycles [DONE]");
+    block->statements = output;
+    if (modified) {
+        block->erase_annotation<ir::KernelCyclesValid>();
+    }
 
-    return total_saved;
+    QL_DOUT("Clifford optimizer on block saved " << (total_saved - saved_before) << " cycles [DONE]");
+    return total_saved - saved_before;
 }
 
 } // namespace detail
@@ -6,7 +6,9 @@
 
 #include "ql/utils/num.h"
 #include "ql/utils/vec.h"
-#include "ql/ir/compat/compat.h"
+#include "ql/utils/map.h"
+#include "ql/ir/ir.h"
+#include "ql/com/ddg/build.h"
 
 namespace ql {
 namespace pass {
@@ -22,14 +24,41 @@ class Clifford {
 private:
 
     /**
-     * Shorthand for the number of qubits in the kernel.
+     * The single-qubit gates that accumulated Clifford states are expressed in
+     * when they are written back to the program.
      */
-    utils::UInt nq;
+    enum Primitive {
+        X180, Y180, X90, MX90, Y90, MY90, NUM_PRIMITIVES
+    };
+
+    /**
+     * The IR we're operating on.
+     */
+    ir::Ref ir;
+
+    /**
+     * Whether accumulated Clifford states may be moved past instructions that
+     * commute with them.
+     */
+    utils::Bool commute;
+
+    /**
+     * Clifford state for each single-qubit instruction type in the platform
+     * that represents a C1 Clifford gate, built once when the optimizer is
+     * constructed. Instruction types that are not in here are not Cliffords.
+     */
+    utils::Map<const ir::InstructionType*, utils::Int> clifford_states;
 
     /**
-     * Shorthand for the platform's cycle time in nanoseconds.
+     * Generalized instruction types for the primitives, resolved (or added
+     * to the platform) when they are first needed.
      */
-    utils::UInt ct;
+    ir::InstructionTypeLink primitives[NUM_PRIMITIVES];
+
+    /**
+     * Gatherer for the object accesses of non-Clifford instructions.
+     */
+    com::ddg::EventGatherer gatherer;
 
     /**
      * Current accumulated Clifford state per qubit.
@@ -42,62 +71,64 @@ private:
     utils::Vec<utils::UInt> cliffcycles;
 
     /**
-     * Total number of cycles saved per kernel.
+     * Total number of cycles saved.
+     */
+    utils::Int total_saved;
+
+    /**
+     * Records the Clifford state of the given instruction type and all its
+     * specializations in clifford_states, if it is a single-qubit Clifford.
+     */
+    void add_instruction_type(const utils::One<ir::InstructionType> &type, utils::Int cs);
+
+    /**
+     * Returns the generalized instruction type for the given primitive.
      */
-    utils::UInt total_saved;
+    const ir::InstructionTypeLink &get_primitive(Primitive primitive);
 
     /**
-     * Create gate sequences for all accumulated cliffords, output them and
-     * reset state.
+     * Create gate sequences for all accumulated cliffords, append them to the
+     * output and reset state.
      */
-    void sync_all(const ir::compat::KernelRef &k);
+    void sync_all(utils::Any<ir::Statement> &output, utils::Int cycle);
 
     /**
-     * Create gate sequence for accumulated cliffords of qubit q, output it and
-     * reset state.
+     * Create gate sequence for accumulated cliffords of qubit q, append it to
+     * the output and reset state.
      */
-    void sync(const ir::compat::KernelRef &k, utils::UInt q);
+    void sync(utils::Any<ir::Statement> &output, utils::Int cycle, utils::UInt q);
+
+    /**
+     * Handles a statement that is not a Clifford gate: synchronizes all qubits
+     * it uses that the accumulated state doesn't commute with.
+     */
+    void sync_for(
+        utils::Any<ir::Statement> &output,
+        const ir::StatementRef &statement
+    );
+
+    /**
+     * If the given statement is an unconditional single-qubit Clifford gate,
+     * returns its Clifford state and sets qubit accordingly. Otherwise,
+     * returns -1.
+     */
+    utils::Int get_clifford(const ir::StatementRef &statement, utils::UInt &qubit) const;
 
     /**
      * Clifford state transition table.
      *
      * [from state][accumulating sequence represented as state] => new state
      */
-    const utils::Int TRANSITION_TABLE[24][24] = {
-        {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,16,17,18,19,20,21,22,23 },
-        {  1, 2, 0,10,11, 9, 4, 5, 3, 7, 8, 6,23,21,22,14,12,13,20,18,19,17,15,16 },
-        {  2, 0, 1, 8, 6, 7,11, 9,10, 5, 3, 4,16,17,15,22,23,21,19,20,18,13,14,12 },
-        {  3, 4, 5, 0, 1, 2, 9,10,11, 6, 7, 8,15,16,17,12,13,14,21,22,23,18,19,20 },
-        {  4, 5, 3, 7, 8, 6, 1, 2, 0,10,11, 9,20,18,19,17,15,16,23,21,22,14,12,13 },
-        {  5, 3, 4,11, 9,10, 8, 6, 7, 2, 0, 1,13,14,12,19,20,18,22,23,21,16,17,15 },
-        {  6, 7, 8, 9,10,11, 0, 1, 2, 3, 4, 5,18,19,20,21,22,23,12,13,14,15,16,17 },
-        {  7, 8, 6, 4, 5, 3,10,11, 9, 1, 2, 0,17,15,16,20,18,19,14,12,13,23,21,22 },
-        {  8, 6, 7, 2, 0, 1, 5, 3, 4,11, 9,10,22,23,21,16,17,15,13,14,12,19,20,18 },
-        {  9,10,11, 6, 7, 8, 3, 4, 5, 0, 1, 2,21,22,23,18,19,20,15,16,17,12,13,14 },
-        { 10,11, 9, 1, 2, 0, 7, 8, 6, 4, 5, 3,14,12,13,23,21,22,17,15,16,20,18,19 },
-        { 11, 9,10, 5, 3, 4, 2, 0, 1, 8, 6, 7,19,20,18,13,14,12,16,17,15,22,23,21 },
-        { 12,13,14,21,22,23,18,19,20,15,16,17, 0, 1, 2, 9,10,11, 6, 7, 8, 3, 4, 5 },
-        { 13,14,12,16,17,15,22,23,21,19,20,18, 5, 3, 4, 2, 0, 1, 8, 6, 7,11, 9,10 },
-        { 14,12,13,20,18,19,17,15,16,23,21,22,10,11, 9, 4, 5, 3, 7, 8, 6, 1, 2, 0 },
-        { 15,16,17,18,19,20,21,22,23,12,13,14, 3, 4, 5, 6, 7, 8, 9,10,11, 0, 1, 2 },
-        { 16,17,15,13,14,12,19,20,18,22,23,21, 2, 0, 1, 5, 3, 4,11, 9,10, 8, 6, 7 },
-        { 17,15,16,23,21,22,14,12,13,20,18,19, 7, 8, 6, 1, 2, 0,10,11, 9, 4, 5, 3 },
-        { 18,19,20,15,16,17,12,13,14,21,22,23, 6, 7, 8, 3, 4, 5, 0, 1, 2, 9,10,11 },
-        { 19,20,18,22,23,21,16,17,15,13,14,12,11, 9,10, 8, 6, 7, 2, 0, 1, 5, 3, 4 },
-        { 20,18,19,14,12,13,23,21,22,17,15,16, 4, 5, 3,10,11, 9, 1, 2, 0, 7, 8, 6 },
-        { 21,22,23,12,13,14,15,16,17,18,19,20, 9,10,11, 0, 1, 2, 3, 4, 5, 6, 7, 8 },
-        { 22,23,21,19,20,18,13,14,12,16,17,15, 8, 6, 7,11, 9,10, 5, 3, 4, 2, 0, 1 },
-        { 23,21,22,17,15,16,20,18,19,14,12,13, 1, 2, 0, 7, 8, 6, 4, 5, 3,10,11, 9 }
-    };
+    static const utils::Int TRANSITION_TABLE[24][24];
 
     /**
-     * Find the clifford state from identity to given gate, or return -1 if
-     * unknown or the gate is not in C1.
+     * Find the clifford state from identity to a gate with the given name, or
+     * return -1 if unknown or the gate is not in C1.
      *
      * TODO: this currently infers the Clifford index by gate name; instead
      *  semantics like this should be in the config file somehow.
      */
-    static utils::Int gate2cs(const ir::compat::GateRef &gate);
+    static utils::Int gate2cs(const utils::Str &name);
 
     /**
      * Find the duration of the gate sequence corresponding to given clifford
@@ -108,18 +139,37 @@ private:
      */
     static utils::UInt cs2cycles(utils::Int cs);
 
+    /**
+     * Returns the minimal sequence of primitive gates corresponding to the
+     * given clifford state.
+     */
+    static utils::Vec<Primitive> cs2primitives(utils::Int cs);
+
     /**
      * Return the gate sequence as string for debug output corresponding to
      * given clifford state.
      */
     static utils::Str cs2string(utils::Int cs);
 
+    /**
+     * Returns whether the given clifford state commutes with an access to the
+     * qubit in the given mode.
+     */
+    static utils::Bool cs_commutes_with(utils::Int cs, const com::ddg::AccessMode &mode);
+
 public:
 
     /**
-     * Optimizes the given kernel, returning how many cycles were saved.
+     * Constructs a Clifford optimizer for the given IR. This builds the
+     * instruction type to Clifford state mapping for the platform.
+     */
+    Clifford(const ir::Ref &ir, utils::Bool commute);
+
+    /**
+     * Optimizes the given block and its sub-blocks, returning how many cycles
+     * were saved.
      */
-    utils::UInt optimize_kernel(const ir::compat::KernelRef &kernel);
+    utils::Int optimize_block(const ir::BlockBaseRef &block);
 
 };
 
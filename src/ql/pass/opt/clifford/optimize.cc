@@ -31,7 +31,18 @@ void CliffordOptimizePass::dump_docs(
 
     Note that the relation between the Clifford state transition corresponding
     to a particular gate is currently hardcoded based on gate name, and the
-    equivalent cycle counts are also hardcoded.
+    equivalent cycle counts are also hardcoded. The classification is done
+    once for every instruction type in the platform; only unconditional
+    instructions with a single qubit operand are considered.
+
+    A sequence of Clifford gates on a qubit normally ends at the first other
+    instruction that uses the qubit. When the `commute` option is enabled, the
+    operand access modes of that instruction (the same ones used by the data
+    dependency graph for the scheduler) are used to determine whether the
+    accumulated Clifford commutes with it; if so, the sequence continues after
+    the instruction. For example, a Z-axis Clifford accumulated on the control
+    qubit of a CNOT or on either qubit of a CZ can be merged with Cliffords
+    following the two-qubit gate.
     )");
 }
 
@@ -49,22 +60,36 @@ CliffordOptimizePass::CliffordOptimizePass(
     const utils::Ptr<const pmgr::Factory> &pass_factory,
     const utils::Str &instance_name,
     const utils::Str &type_name
-) : pmgr::pass_types::KernelTransformation(pass_factory, instance_name, type_name) {
+) : pmgr::pass_types::Transformation(pass_factory, instance_name, type_name) {
+    options.add_bool(
+        "commute",
+        "When set, sequences of Clifford gates are merged across instructions "
+        "that commute with the accumulated Clifford on the qubits they share, "
+        "as determined by the operand access modes of the instructions.",
+        "no"
+    );
 }
 
 /**
  * Runs the Clifford optimizer.
  */
 utils::Int CliffordOptimizePass::run(
-    const ir::compat::ProgramRef &program,
-    const ir::compat::KernelRef &kernel,
+    const ir::Ref &ir,
     const pmgr::pass_types::Context &context
 ) const {
-    auto cycles_saved = detail::Clifford().optimize_kernel(kernel);
-    ana::statistics::AdditionalStats::push(
-        kernel,
-        utils::to_string(cycles_saved) + " cycles saved by " + context.full_pass_name
-    );
+    if (ir->program.empty()) {
+        return 0;
+    }
+    detail::Clifford clifford(ir, options["commute"].as_bool());
+    utils::Int cycles_saved = 0;
+    for (const auto &block : ir->program->blocks) {
+        auto block_cycles_saved = clifford.optimize_block(block);
+        ana::statistics::AdditionalStats::push(
+            block,
+            utils::to_string(block_cycles_saved) + " cycles saved by " + context.full_pass_name
+        );
+        cycles_saved += block_cycles_saved;
+    }
     return cycles_saved;
 }
 
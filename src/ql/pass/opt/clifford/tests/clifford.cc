@@ -0,0 +1,289 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include <cmath>
+
+#include "ql/ir/ir.h"
+#include "ql/ir/ops.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/ir/cqasm/read.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/pmgr/manager.h"
+
+namespace ql {
+namespace pass {
+namespace opt {
+namespace clifford {
+namespace optimize {
+
+using namespace utils;
+
+/**
+ * Square matrix in row-major form, indexed as [row][column]. Qubit b
+ * corresponds to bit b of the row and column indices.
+ */
+using Matrix = Vec<Vec<Complex>>;
+
+/**
+ * Number of qubits simulated to check that the circuit is unchanged. The
+ * test programs only use these qubits.
+ */
+static const UInt NUM_QUBITS = 3;
+
+class CliffordTest {
+protected:
+    CliffordTest() {
+        ql::utils::logger::set_log_level("LOG_WARNING");
+    }
+
+    /**
+     * Applies the single-qubit gate u = {u00, u01, u10, u11} to qubit q after
+     * the operation described by m.
+     */
+    static void apply_single(Matrix &m, UInt q, const Vec<Complex> &u) {
+        UInt bit = 1ull << q;
+        for (UInt i = 0; i < m.size(); ++i) {
+            if (i & bit) {
+                continue;
+            }
+            auto j = i | bit;
+            for (UInt col = 0; col < m.size(); ++col) {
+                auto a = m[i][col];
+                auto b = m[j][col];
+                m[i][col] = u[0] * a + u[1] * b;
+                m[j][col] = u[2] * a + u[3] * b;
+            }
+        }
+    }
+
+    static void apply_rx(Matrix &m, UInt q, Real theta) {
+        Complex c = std::cos(theta / 2);
+        Complex s = Complex(0.0, -std::sin(theta / 2));
+        apply_single(m, q, {c, s, s, c});
+    }
+
+    static void apply_ry(Matrix &m, UInt q, Real theta) {
+        Real c = std::cos(theta / 2);
+        Real s = std::sin(theta / 2);
+        apply_single(m, q, {c, -s, s, c});
+    }
+
+    /**
+     * Applies the given instruction to the operation described by m.
+     */
+    static void apply(Matrix &m, const ir::CustomInstruction &insn) {
+        Vec<UInt> qubits;
+        for (const auto &operand : insn.operands) {
+            auto ref = operand->as_reference();
+            REQUIRE(ref);
+            qubits.push_back(ref->indices[0].as<ir::IntLiteral>()->value);
+        }
+        for (auto q : qubits) {
+            REQUIRE(q < NUM_QUBITS);
+        }
+        const Complex i(0.0, 1.0);
+        const Real r = std::sqrt(0.5);
+        const auto &name = insn.instruction_type->name;
+        if (name == "x") {
+            apply_single(m, qubits[0], {0.0, 1.0, 1.0, 0.0});
+        } else if (name == "y") {
+            apply_single(m, qubits[0], {0.0, -i, i, 0.0});
+        } else if (name == "z") {
+            apply_single(m, qubits[0], {1.0, 0.0, 0.0, -1.0});
+        } else if (name == "h") {
+            apply_single(m, qubits[0], {r, r, r, -r});
+        } else if (name == "s") {
+            apply_single(m, qubits[0], {1.0, 0.0, 0.0, i});
+        } else if (name == "sdag") {
+            apply_single(m, qubits[0], {1.0, 0.0, 0.0, -i});
+        } else if (name == "x90" || name == "rx90") {
+            apply_rx(m, qubits[0], PI / 2);
+        } else if (name == "mx90" || name == "mrx90") {
+            apply_rx(m, qubits[0], -PI / 2);
+        } else if (name == "y90" || name == "ry90") {
+            apply_ry(m, qubits[0], PI / 2);
+        } else if (name == "my90" || name == "mry90") {
+            apply_ry(m, qubits[0], -PI / 2);
+        } else if (name == "rx180") {
+            apply_rx(m, qubits[0], PI);
+        } else if (name == "ry180") {
+            apply_ry(m, qubits[0], PI);
+        } else if (name == "cnot") {
+            UInt cbit = 1ull << qubits[0];
+            UInt tbit = 1ull << qubits[1];
+            for (UInt row = 0; row < m.size(); ++row) {
+                if ((row & cbit) && !(row & tbit)) {
+                    std::swap(m[row], m[row | tbit]);
+                }
+            }
+        } else if (name == "cz") {
+            UInt mask = (1ull << qubits[0]) | (1ull << qubits[1]);
+            for (UInt row = 0; row < m.size(); ++row) {
+                if ((row & mask) == mask) {
+                    for (auto &elem : m[row]) {
+                        elem = -elem;
+                    }
+                }
+            }
+        } else {
+            FAIL("unexpected instruction ", name);
+        }
+    }
+
+    /**
+     * Returns the unitary implemented by the given block.
+     */
+    static Matrix unitary(const ir::BlockRef &block) {
+        UInt size = 1ull << NUM_QUBITS;
+        Matrix m(size, Vec<Complex>(size, 0.0));
+        for (UInt idx = 0; idx < size; ++idx) {
+            m[idx][idx] = 1.0;
+        }
+        for (const auto &statement : block->statements) {
+            auto insn = statement->as_custom_instruction();
+            REQUIRE(insn);
+            apply(m, *insn);
+        }
+        return m;
+    }
+
+    /**
+     * Reads the given cQASM statements into a program with a single block,
+     * runs the Clifford optimizer on it with the given value for the commute
+     * option, checks that the resulting block implements the same unitary as
+     * the input up to global phase, and returns the names of the instructions
+     * in the resulting block.
+     */
+    Vec<Str> run(const Str &statements, Bool commute) {
+        auto platform = ir::compat::Platform::build("none", Str("none"));
+        auto ir = ir::convert_old_to_new(platform);
+        ir::cqasm::read(ir, "version 1.2\nqubits 10\n.main\n" + statements);
+        REQUIRE_EQ(ir->program->blocks.size(), 1);
+        auto before = unitary(ir->program->blocks[0]);
+
+        pmgr::Manager manager;
+        manager.append_pass(
+            "opt.clifford.Optimize",
+            "clifford",
+            {{"commute", commute ? "yes" : "no"}}
+        );
+        manager.compile(ir);
+        auto after = unitary(ir->program->blocks[0]);
+
+        // Compare up to global phase, taken from the largest element.
+        UInt best_row = 0;
+        UInt best_col = 0;
+        for (UInt row = 0; row < before.size(); ++row) {
+            for (UInt col = 0; col < before.size(); ++col) {
+                if (std::abs(before[row][col]) > std::abs(before[best_row][best_col])) {
+                    best_row = row;
+                    best_col = col;
+                }
+            }
+        }
+        auto phase = after[best_row][best_col] / before[best_row][best_col];
+        CHECK(std::abs(std::abs(phase) - 1.0) < 1.0e-6);
+        for (UInt row = 0; row < before.size(); ++row) {
+            for (UInt col = 0; col < before.size(); ++col) {
+                INFO("Optimized circuit differs at row ", row, " column ", col, ".");
+                CHECK(std::abs(after[row][col] - phase * before[row][col]) < 1.0e-6);
+            }
+        }
+
+        Vec<Str> names;
+        for (const auto &statement : ir->program->blocks[0]->statements) {
+            names.push_back(statement->as_custom_instruction()->instruction_type->name);
+        }
+        return names;
+    }
+
+};
+
+TEST_CASE_FIXTURE(CliffordTest, "Sequence folding") {
+    Str statements = R"(
+        x q[0]
+        x q[0]
+        h q[1]
+        s q[1]
+        s q[1]
+        h q[1]
+        y q[2]
+        z q[2]
+        x90 q[2]
+    )";
+
+    // X.X reduces to the identity, H.S.S.H = X to X180, and Y.Z.X90 to -X90.
+    // There is nothing to commute with, so the option does not matter.
+    Vec<Str> expected{"rx180", "mrx90"};
+    CHECK_EQ(run(statements, false), expected);
+    CHECK_EQ(run(statements, true), expected);
+}
+
+TEST_CASE_FIXTURE(CliffordTest, "Folding across a CNOT") {
+
+    // Z on the control and X on the target of a CNOT commute with it.
+    Str statements = R"(
+        z q[0]
+        x q[1]
+        cnot q[0], q[1]
+        z q[0]
+        x q[1]
+    )";
+
+    // Z is expressed as X180 followed by Y180.
+    Vec<Str> expected{
+        "rx180", "ry180", "rx180", "cnot", "rx180", "ry180", "rx180"
+    };
+    CHECK_EQ(run(statements, false), expected);
+
+    // With commutation, both sequences reduce to the identity.
+    expected = {"cnot"};
+    CHECK_EQ(run(statements, true), expected);
+}
+
+TEST_CASE_FIXTURE(CliffordTest, "No folding across a non-commuting CNOT") {
+
+    // X on the control and Z on the target of a CNOT do not commute with it,
+    // so the sequences must end at the CNOT regardless of the option.
+    Str statements = R"(
+        x q[0]
+        z q[1]
+        cnot q[0], q[1]
+        x q[0]
+        z q[1]
+    )";
+
+    Vec<Str> expected{
+        "rx180", "rx180", "ry180", "cnot", "rx180", "rx180", "ry180"
+    };
+    CHECK_EQ(run(statements, false), expected);
+    CHECK_EQ(run(statements, true), expected);
+}
+
+TEST_CASE_FIXTURE(CliffordTest, "Folding across a CZ") {
+
+    // S commutes with CZ on both qubits, and S.S = Z. H does not commute with
+    // CZ, so the sequence on qubit 2 ends at the CZ.
+    Str statements = R"(
+        s q[0]
+        h q[2]
+        cz q[0], q[2]
+        s q[0]
+        h q[2]
+    )";
+
+    Vec<Str> expected{
+        "rx90", "mry90", "mrx90", "ry90", "rx180", "cz",
+        "rx90", "mry90", "mrx90", "ry90", "rx180"
+    };
+    CHECK_EQ(run(statements, false), expected);
+
+    expected = {"ry90", "rx180", "cz", "rx180", "ry180", "ry90", "rx180"};
+    CHECK_EQ(run(statements, true), expected);
+}
+
+} // namespace optimize
+} // namespace clifford
+} // namespace opt
+} // namespace pass
+} // namespace ql
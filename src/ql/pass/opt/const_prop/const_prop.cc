@@ -38,11 +38,7 @@ utils::Int ConstantPropagationPass::run(
     const pmgr::pass_types::Context &context
 ) const {
     // perform constant propagation
-    if (!ir->program.empty()) {
-        for (auto &block : ir->program->blocks) {
-            detail::propagate(ir, *block);
-        }
-    }
+    detail::propagate(ir);
     return 0;
 }
 
@@ -51,6 +51,35 @@ PLATFORM_FUNCTION_LIST
 #undef P_I
 
 
+// function pointer
+typedef FncRet (*tOpFunc)(const ir::Ref &ir, const FncArgs &args);
+
+// operand profile encoding: two bits per operand, first operand in the most significant position, see
+// get_operand_profile(). An empty profile is never valid, since all our functions have at least one operand
+static const utils::UInt PROFILE_INT = 1;
+static const utils::UInt PROFILE_BIT = 2;
+
+// a function from PLATFORM_FUNCTION_LIST
+struct PlatformFunction {
+    const char *name;
+    utils::UInt profile;
+    tOpFunc func;
+};
+
+// the functions from PLATFORM_FUNCTION_LIST, with their operand profile
+#define P_I PROFILE_INT
+#define P_B PROFILE_BIT
+#define X2(name, ret_type, par0, par1, operation, func) { name, (par0 << 2) | par1, &(func ## _ ## par0 ## par1) },
+#define X1(name, ret_type, par0,       operation, func) { name, par0,               &(func ## _ ## par0        ) },
+static const PlatformFunction PLATFORM_FUNCTIONS[] = {
+    PLATFORM_FUNCTION_LIST
+};
+#undef X1
+#undef X2
+#undef P_B
+#undef P_I
+
+
 class ConstantPropagator : public ir::RecursiveVisitor {
 public:
 
@@ -123,18 +152,51 @@ private:  // RecursiveVisitor overrides
 
 private:    // types
 
-    // function pointer
-    typedef FncRet (*tOpFunc)(const ir::Ref &ir, const FncArgs &args);
+    // an evaluator for a specific operand profile
+    struct Evaluator {
+        utils::UInt profile;
+        tOpFunc func;
+    };
 
-    // map function key (see register_functions()) to function pointer
-    using FuncMap = std::map<utils::Str, tOpFunc>;
+    // map function type (by address) to the evaluators that may apply to it. Function types for which we
+    // have no evaluator are not in the map
+    using DispatchTable = utils::Map<const ir::FunctionType*, utils::Vec<Evaluator>>;
 
 private:    // vars
     const ir::Ref &ir;
-    FuncMap func_map;
+    DispatchTable dispatch_table;
+    utils::UInt num_replaced = 0;
+
+public:     // functions
+
+    /**
+     * Returns the number of function calls replaced by a literal so far.
+     */
+    utils::UInt get_num_replaced() const {
+        return num_replaced;
+    }
 
 private:    // functions
 
+    /*
+     * Returns the operand profile of the given function call, or 0 if it has operands that aren't int or bit
+     * literals (or no operands at all).
+     */
+    static utils::UInt get_operand_profile(const ir::FunctionCall &function_call) {
+        utils::UInt profile = 0;
+        for (auto &operand : function_call.operands) {
+            if (operand->as_int_literal()) {
+                profile = (profile << 2) | PROFILE_INT;
+            } else if (operand->as_bit_literal()) {
+                profile = (profile << 2) | PROFILE_BIT;
+            } else {
+                DEBUG("not touching operand '" << ir::describe(operand) << "'");
+                return 0;
+            }
+        }
+        return profile;
+    }
+
     /*
      * Handle an expression node, i.e. replace eligible functions calls with a literal expression.
      *
@@ -149,61 +211,55 @@ private:    // functions
         DEBUG("done descending '" << ir::describe(expression));
 
         if (auto function_call = expression->as_function_call()) {
-            QL_IOUT("function call '" << ir::describe(*function_call) << "'");
-
-            // generate key, consistent with register_functions()
-            utils::Str key = function_call->function_type->name + "_";
-            for (auto &operand : function_call->operands) {
-                if (operand->as_int_literal()) {
-                    key += "i";
-                } else if (operand->as_bit_literal()) {
-                    key += "b";
-                } else {
-                    DEBUG("not touching operand '" << ir::describe(operand) << "'");
-                    return;     // we don't handle functions with other operand types, but leave them untouched
-                }
+            DEBUG("function call '" << ir::describe(*function_call) << "'");
+
+            // lookup function type
+            auto it = dispatch_table.find(function_call->function_type.get_ptr().get());
+            if (it == dispatch_table.end()) {
+                DEBUG("ignoring non-eligible function '" << function_call->function_type->name << "'");
+                return;
+            }
+
+            // we don't handle functions with other operand types, but leave them untouched
+            utils::UInt profile = get_operand_profile(*function_call);
+            if (!profile) {
+                return;
             }
 
             // NB: we don't perform type promotions like libqasm's cQASM resolver, see FunctionTable::call
+            for (const auto &evaluator : it->second) {
+                if (evaluator.profile == profile) {
 
-            // lookup key
-            auto it = func_map.find(key);
-            if (it == func_map.end()) {
-                DEBUG("ignoring non-eligible function '" << key << "'");
+                    // call the function
+                    FncRet ret = (*evaluator.func)(ir, function_call->operands);
 
-            } else {
-                // call the function
-                FncRet ret = (*it->second)(ir, function_call->operands);
-
-                // replace node
-                QL_IOUT("replacing '" << ir::describe(*function_call) << "' by '" << ir::describe(*ret) << "'");
-                expression = ret;
+                    // replace node
+                    DEBUG("replacing '" << ir::describe(*function_call) << "' by '" << ir::describe(*ret) << "'");
+                    expression = ret;
+                    num_replaced++;
+                    return;
+                }
             }
+            DEBUG("ignoring function '" << function_call->function_type->name << "' with non-eligible operands");
         }
     }
 
     /**
-     * Register the functions we handle.
+     * Register the functions we handle, by resolving the platform's function types to the functions from
+     * PLATFORM_FUNCTION_LIST with the same name once, such that handling a function call only requires a
+     * lookup by address.
      */
     void register_functions() {
-        // Initialize func_map with the functions from PLATFORM_FUNCTION_LIST
-        // The key consists of the concatenation of name, "_" and the stringified profile, e.g "operator+_ii"
-
-        #define str(x) #x
-        #define xstr(x) str(x)
-        #define P_I i
-        #define P_B b
-        #define X2(name, ret_type, par0, par1, operation, func) { name "_" xstr(par0) xstr(par1), &(func ## _ ## par0 ## par1) },
-        #define X1(name, ret_type, par0,       operation, func) { name "_" xstr(par0)           , &(func ## _ ## par0        ) },
-        func_map = {
-            PLATFORM_FUNCTION_LIST
-        };
-        #undef X1
-        #undef X2
-        #undef P_B
-        #undef P_I
-        #undef xstr
-        #undef str
+        for (const auto &function_type : ir->platform->functions) {
+            for (const auto &platform_function : PLATFORM_FUNCTIONS) {
+                if (function_type->name == platform_function.name) {
+                    dispatch_table.set(function_type.get_ptr().get()).push_back(
+                        {platform_function.profile, platform_function.func}
+                    );
+                }
+            }
+        }
+        DEBUG("resolved " << dispatch_table.size() << " platform functions for constant propagation");
     };
 
 };
@@ -217,6 +273,21 @@ void propagate(const ir::Ref &ir, ir::Node &node) {
     node.visit(visitor);
 }
 
+/**
+ * Recursively perform constant propagation on all blocks of the program in the
+ * given IR. The platform functions are only resolved once for all blocks.
+ */
+void propagate(const ir::Ref &ir) {
+    if (ir->program.empty()) {
+        return;
+    }
+    ConstantPropagator visitor(ir);
+    for (auto &block : ir->program->blocks) {
+        block->visit(visitor);
+    }
+    QL_IOUT("constant propagation replaced " << visitor.get_num_replaced() << " function call(s) by a literal");
+}
+
 } // namespace detail
 } // namespace const_prop
 } // namespace opt
@@ -20,6 +20,14 @@ void propagate(
     ir::Node &node
 );
 
+/**
+ * Recursively perform constant propagation on all blocks of the program in the
+ * given IR. The platform functions are only resolved once for all blocks.
+ */
+void propagate(
+    const ir::Ref &ir
+);
+
 } // namespace detail
 } // namespace const_prop
 } // namespace opt
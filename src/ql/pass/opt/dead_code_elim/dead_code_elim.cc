@@ -4,6 +4,7 @@
 
 #include "ql/pass/opt/dead_code_elim/dead_code_elim.h"
 
+#include "ql/utils/parallel.h"
 #include "ql/pmgr/pass_types/base.h"
 #include "ql/ir/describe.h"
 #include "ql/pmgr/factory.h"
@@ -23,6 +24,12 @@ DeadCodeEliminationPass::DeadCodeEliminationPass(
     const utils::Str &instance_name,
     const utils::Str &type_name
 ) : pmgr::pass_types::Transformation(pass_factory, instance_name, type_name) {
+    options.add_int(
+        "num_threads",
+        "The number of threads used to process the blocks of the program "
+        "concurrently. 0 means that the number of hardware threads is used.",
+        "1", 0, utils::MAX
+    );
 }
 
 /**
@@ -41,8 +48,13 @@ void DeadCodeEliminationPass::run_on_block(
 ) {
     utils::Str block_name = block->as_block() ? block->as_block()->name : QL_SS2S("(anon[" << level << "]");
     DEBUG(block_name << ": running dead code elimination");
-    for (utils::UInt stmt_idx = 0; stmt_idx < block->statements.size(); stmt_idx++) {    // NB: we need index for add() below
-        const auto &statement = block->statements[stmt_idx];
+
+    // The resulting statement list is built in a single pass, such that
+    // removing statements and inlining bodies doesn't shift the remainder of
+    // the list around for every change.
+    utils::Any<ir::Statement> statements;
+    utils::Bool modified = false;
+    for (const auto &statement : block->statements) {
 
         // handle if_else.
         //
@@ -59,78 +71,63 @@ void DeadCodeEliminationPass::run_on_block(
         //                    "   rx90 op(0)",
         //                    "}"
         if (auto if_else = statement->as_if_else()) {
-            utils::UInt if_else_idx = stmt_idx;
-            bool remove_if_else = false;
 
-            // remove unreachable branches, and maybe the complete if_else statement
-            for (utils::UInt branch_idx = 0; branch_idx < if_else->branches.size(); ) {    // NB: we need index for remove() below
-                auto &branch = if_else->branches[branch_idx];
+            // remove unreachable branches, building the list of remaining branches
+            utils::Many<ir::IfElseBranch> branches;
+            utils::Bool found_true = false;
+            for (const auto &branch : if_else->branches) {
                 if (auto condition = branch->condition->as_bit_literal()) {
                     if (condition->value) {   // condition 'true'
                         // descend body
                         run_on_block(branch->body, level+1);
+                        branches.add(branch);
 
-                        // delete subsequent if_else branches and if_else->otherwise, since these are unreachable
+                        // subsequent if_else branches and if_else->otherwise are unreachable
                         DEBUG(block_name << ": found 'if_else(true)': removing unreachable if_else-branches and if_else->otherwise");
-                        for (utils::UInt i = branch_idx + 1; i < if_else->branches.size(); i++) {
-                            if_else->branches.remove(i);
-                        }
-                        if_else->otherwise.reset();     // removes Maybe item
-
-                        // if we're the sole if_else-branch (remaining), turn body (sub_block) into statements
-                        if(branch_idx == 0) {
-                            DEBUG(block_name << ": turn body of sole 'if(true)' branch into statements");
-                            for (auto &st : branch->body->statements) {
-                                block->statements.add(st, ++stmt_idx);  // NB: increment affects both this add and statement loop
-                            }
-
-                            // mark complete if_else statement for removal
-                            remove_if_else = true;
-                        }
-
-                        // NB: done looping, since we erased everything that followed
+                        found_true = true;
                         break;
 
                     } else {    // condition 'false'
                         // NB: no need to descend body, since we'll discard it
-                        DEBUG(block_name << ": removing dead if-branch " << branch_idx);
-                        if_else->branches.remove(branch_idx);
-                        continue;   // loop, using same value for branch_idx
-
-                        // NB: may remove all if_else branches (which we repair later)
+                        DEBUG(block_name << ": removing dead if-branch");
+                        continue;
                     }
-
-                // condition is not a bit_literal
-                } else {
-                    // descend body
-                    run_on_block(branch->body, level+1);
                 }
-                branch_idx++;
+
+                // condition is not a bit_literal: descend body
+                run_on_block(branch->body, level+1);
+                branches.add(branch);
             }
 
-            // descend otherwise
-            if (!if_else->otherwise.empty()) {
+            // handle otherwise
+            if (found_true) {
+                if_else->otherwise.reset();     // removes Maybe item
+            } else if (!if_else->otherwise.empty()) {
                 run_on_block(if_else->otherwise, level+1);
             }
 
-            // if we no longer have branches, but do have otherwise, promote its body into statements within this block
-            if (if_else->branches.empty()) {
+            // if we're left with a sole 'if(true)' branch, turn its body (sub_block) into statements
+            if (found_true && branches.size() == 1) {
+                DEBUG(block_name << ": turn body of sole 'if(true)' branch into statements, removing if_else");
+                statements.extend(branches[0]->body->statements);
+                modified = true;
+                continue;
+            }
+
+            // if we no longer have branches, promote the body of otherwise (if any) into statements within this block
+            if (branches.empty()) {
                 if (!if_else->otherwise.empty()) {
                     DEBUG(block_name << ": turn body of final 'if_else->otherwise' into statements");
-
-                    // move if_else->otherwise statements
-                    for (auto &st : if_else->otherwise->statements) {
-                        block->statements.add(st, ++stmt_idx);  // NB: increment affects both this add and statement loop
-                    }
+                    statements.extend(if_else->otherwise->statements);
                 }
-
-                remove_if_else = true;
+                DEBUG(block_name << ": removing if_else");
+                modified = true;
+                continue;
             }
 
-            // if needed, remove the complete if_else statement altogether
-            if (remove_if_else) {
-                DEBUG(block_name << ": removing if_else (if_else_idx=" << if_else_idx << ", block->statements.size()=" << block->statements.size() << ")");
-                block->statements.remove(if_else_idx);
+            // keep the if_else statement, with the remaining branches
+            if (branches.size() != if_else->branches.size()) {
+                if_else->branches = std::move(branches);
             }
 
         // handle loop
@@ -141,6 +138,11 @@ void DeadCodeEliminationPass::run_on_block(
             // NB: we currently have no real use for optimizing static loops, note that we cannot fully
             // remove loop anyway if break or continue exists
         }
+
+        statements.add(statement);
+    }
+    if (modified) {
+        block->statements = std::move(statements);
     }
     DEBUG(block_name << ": done running dead code elimination");
 }
@@ -152,12 +154,17 @@ utils::Int DeadCodeEliminationPass::run(
     const ir::Ref &ir,
     const pmgr::pass_types::Context &context
 ) const {
-    // perform dead code elimination
-    if (!ir->program.empty()) {
-        for (const auto &block : ir->program->blocks) {
-            run_on_block(block);
-        }
+    if (ir->program.empty()) {
+        return 0;
     }
+
+    // perform dead code elimination. Blocks don't share any statements, so
+    // they can be processed concurrently
+    const auto &blocks = ir->program->blocks;
+    auto num_threads = utils::get_num_threads(options["num_threads"].as_uint());
+    utils::parallel_for(blocks.size(), num_threads, [&](utils::UInt i) {
+        run_on_block(blocks[i]);
+    });
     return 0;
 }
 
@@ -172,6 +179,10 @@ void DeadCodeEliminationPass::dump_docs(
 ) const {
     utils::dump_str(os, line_prefix, R"(
     This pass removes dead code, currently only unreachable if-branches.
+
+    For programs with many blocks, the `num_threads` option can be used to
+    process the blocks concurrently. The result does not depend on the number
+    of threads.
     )");
 }
 
@@ -0,0 +1,211 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "ql/ir/ir.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/ir/cqasm/read.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/pmgr/manager.h"
+
+namespace ql {
+namespace pass {
+namespace opt {
+namespace dead_code_elim {
+
+class DeadCodeElimTest {
+protected:
+    DeadCodeElimTest() {
+        ql::utils::logger::set_log_level("LOG_WARNING");
+    }
+
+    /**
+     * Reads the given cQASM statements into a program with a single block,
+     * runs dead code elimination on it, and returns the resulting block.
+     */
+    ir::BlockRef run(const utils::Str &statements) {
+        auto platform = ir::compat::Platform::build("none", utils::Str("none"));
+        ir = ir::convert_old_to_new(platform);
+        ir::cqasm::read(ir, "version 1.2\nqubits 10\n.main\n" + statements);
+        REQUIRE_EQ(ir->program->blocks.size(), 1);
+
+        pmgr::Manager manager;
+        manager.append_pass("opt.DeadCodeElim", "dce");
+        manager.compile(ir);
+
+        return ir->program->blocks[0];
+    }
+
+    /**
+     * Describes the given statements as a list of strings: "<name> <qubit>"
+     * for single-qubit gates, and "if_else(<branches>)" or
+     * "if_else(<branches>, otherwise)" for if-else statements, followed by
+     * the descriptions of their bodies.
+     */
+    static utils::Vec<utils::Str> describe(const utils::Any<ir::Statement> &statements) {
+        utils::Vec<utils::Str> result;
+        for (const auto &statement : statements) {
+            if (auto custom = statement->as_custom_instruction()) {
+                REQUIRE_EQ(custom->operands.size(), 1);
+                auto ref = custom->operands[0]->as_reference();
+                REQUIRE(ref);
+                result.push_back(
+                    custom->instruction_type->name + " " +
+                    utils::to_string(ref->indices[0].as<ir::IntLiteral>()->value)
+                );
+            } else if (auto if_else = statement->as_if_else()) {
+                result.push_back(
+                    "if_else(" + utils::to_string(if_else->branches.size()) +
+                    (if_else->otherwise.empty() ? ")" : ", otherwise)")
+                );
+                for (const auto &branch : if_else->branches) {
+                    auto body = describe(branch->body->statements);
+                    result.insert(result.end(), body.begin(), body.end());
+                }
+                if (!if_else->otherwise.empty()) {
+                    auto body = describe(if_else->otherwise->statements);
+                    result.insert(result.end(), body.begin(), body.end());
+                }
+            } else {
+                FAIL("unexpected statement in result");
+            }
+        }
+        return result;
+    }
+
+    ir::Ref ir;
+};
+
+TEST_CASE_FIXTURE(DeadCodeElimTest, "Consecutive constant if statements") {
+
+    // Every statement following a removed or inlined if-else used to be
+    // skipped, so the second of two consecutive constant if statements was
+    // not handled.
+    auto block = run(R"(
+        x q[0]
+        if (true) {
+            y q[0]
+        }
+        if (false) {
+            z q[0]
+        }
+        if (true) {
+            h q[0]
+        }
+        if (false) {
+            s q[0]
+        } else {
+            t q[0]
+        }
+        if (true) {
+            x q[1]
+        }
+        x q[2]
+    )");
+
+    utils::Vec<utils::Str> expected{"x 0", "y 0", "h 0", "t 0", "x 1", "x 2"};
+    CHECK_EQ(describe(block->statements), expected);
+}
+
+TEST_CASE_FIXTURE(DeadCodeElimTest, "If true followed by other branches") {
+
+    // Removing the branches after an 'if (true)' used to remove only every
+    // other branch.
+    auto block = run(R"(
+        if (true) {
+            x q[0]
+        } else if (b[0]) {
+            y q[0]
+        } else if (b[1]) {
+            z q[0]
+        } else if (false) {
+            h q[0]
+        } else if (b[2]) {
+            s q[0]
+        } else {
+            t q[0]
+        }
+        x q[1]
+    )");
+
+    utils::Vec<utils::Str> expected{"x 0", "x 1"};
+    CHECK_EQ(describe(block->statements), expected);
+}
+
+TEST_CASE_FIXTURE(DeadCodeElimTest, "If true after a dynamic branch") {
+    auto block = run(R"(
+        if (b[0]) {
+            x q[0]
+        } else if (false) {
+            y q[0]
+        } else if (true) {
+            z q[0]
+        } else if (b[1]) {
+            h q[0]
+        } else if (true) {
+            s q[0]
+        } else {
+            t q[0]
+        }
+    )");
+
+    utils::Vec<utils::Str> expected{"if_else(2)", "x 0", "z 0"};
+    CHECK_EQ(describe(block->statements), expected);
+
+    // The remaining branches must be the original b[0] and true branches.
+    auto if_else = block->statements[0]->as_if_else();
+    REQUIRE(if_else);
+    CHECK(if_else->branches[0]->condition->as_reference());
+    auto condition = if_else->branches[1]->condition->as_bit_literal();
+    REQUIRE(condition);
+    CHECK(condition->value);
+}
+
+TEST_CASE_FIXTURE(DeadCodeElimTest, "Nested constant if statements") {
+    auto block = run(R"(
+        if (b[0]) {
+            if (false) {
+                x q[0]
+            } else {
+                y q[0]
+            }
+            if (true) {
+                z q[0]
+            }
+        } else {
+            if (true) {
+                h q[0]
+            }
+            if (false) {
+                s q[0]
+            }
+        }
+    )");
+
+    utils::Vec<utils::Str> expected{"if_else(1, otherwise)", "y 0", "z 0", "h 0"};
+    CHECK_EQ(describe(block->statements), expected);
+}
+
+TEST_CASE_FIXTURE(DeadCodeElimTest, "All branches false") {
+    auto block = run(R"(
+        if (false) {
+            x q[0]
+        } else if (false) {
+            y q[0]
+        }
+        if (false) {
+            z q[0]
+        } else if (false) {
+            h q[0]
+        } else {
+            s q[0]
+        }
+    )");
+
+    utils::Vec<utils::Str> expected{"s 0"};
+    CHECK_EQ(describe(block->statements), expected);
+}
+
+} // namespace dead_code_elim
+} // namespace opt
+} // namespace pass
+} // namespace ql
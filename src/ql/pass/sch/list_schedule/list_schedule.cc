@@ -263,12 +263,17 @@ utils::Int ListSchedulePass::run(
     const pmgr::pass_types::Context &context
 ) const {
     utils::Set<utils::Str> used_names;
-    if (!ir->program.empty()) {
-        for (const auto &block : ir->program->blocks) {
+
+    // Scheduling is deterministic and block-local, so the results can be
+    // cached, unless we're writing dot files as a side effect.
+    return run_on_blocks(
+        ir,
+        [&](const ir::BlockRef &block) -> utils::Int {
             run_on_block(ir, block, block->name, used_names, context);
-        }
-    }
-    return 0;
+            return 0;
+        },
+        !context.options["write_dot_graphs"].as_bool()
+    );
 }
 
 } // namespace list_schedule
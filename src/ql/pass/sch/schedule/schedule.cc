@@ -99,6 +99,9 @@ SchedulePass::SchedulePass(
         false
     );
 
+    // Kernels are scheduled independently.
+    enable_parallel_kernels();
+
 }
 
 /**
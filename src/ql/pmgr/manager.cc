@@ -301,8 +301,8 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
 
     // Set output_prefix based on output_dir and unique_output.
     utils::StrStrm ss;
-    ss << com::options::global["output_dir"].as_str() << "/";
-    if (com::options::global["unique_output"].as_bool()) {
+    ss << com::options::current()["output_dir"].as_str() << "/";
+    if (com::options::current()["unique_output"].as_bool()) {
         ss << "%N";
     } else {
         ss << "%n";
@@ -312,19 +312,19 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
 
     // Set the debug option based on write_qasm_files and
     // write_report_files.
-    if (com::options::global["write_qasm_files"].as_bool()) {
-        if (com::options::global["write_report_files"].as_bool()) {
+    if (com::options::current()["write_qasm_files"].as_bool()) {
+        if (com::options::current()["write_report_files"].as_bool()) {
             retval.set("debug") = "both";
         } else {
             retval.set("debug") = "qasm";
         }
-    } else if (com::options::global["write_report_files"].as_bool()) {
+    } else if (com::options::current()["write_report_files"].as_bool()) {
         retval.set("debug") = "stats";
     }
 
     // Set options for the scheduler.
-    const auto &scheduler = com::options::global["scheduler"];
-    const auto &scheduler_uniform = com::options::global["scheduler_uniform"];
+    const auto &scheduler = com::options::current()["scheduler"];
+    const auto &scheduler_uniform = com::options::current()["scheduler_uniform"];
     if (scheduler.is_set() || scheduler_uniform.is_set()) {
         if (scheduler_uniform.as_bool()) {
             retval.set("scheduler_target") = "uniform";
@@ -337,61 +337,61 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
 
     // Set options for both the scheduler and mapper (since the mapper has
     // a scheduler built into it, they share some options).
-    const auto &scheduler_commute = com::options::global["scheduler_commute"];
+    const auto &scheduler_commute = com::options::current()["scheduler_commute"];
     if (scheduler_commute.is_set()) {
         retval.set("commute_multi_qubit") = scheduler_commute.as_str();
     }
-    const auto &scheduler_commute_rotations = com::options::global["scheduler_commute_rotations"];
+    const auto &scheduler_commute_rotations = com::options::current()["scheduler_commute_rotations"];
     if (scheduler_commute_rotations.is_set()) {
         retval.set("commute_single_qubit") = scheduler_commute_rotations.as_str();
     }
-    const auto &scheduler_heuristic = com::options::global["scheduler_heuristic"];
+    const auto &scheduler_heuristic = com::options::current()["scheduler_heuristic"];
     if (scheduler_heuristic.is_set()) {
         retval.set("scheduler_heuristic") = scheduler_heuristic.as_str();
     }
-    const auto &print_dot_graphs = com::options::global["print_dot_graphs"];
+    const auto &print_dot_graphs = com::options::current()["print_dot_graphs"];
     if (print_dot_graphs.is_set()) {
         retval.set("write_dot_graphs") = print_dot_graphs.as_str();
     }
 
     // Set options for the mapper.
-    const auto &mapper = com::options::global["mapper"];
+    const auto &mapper = com::options::current()["mapper"];
     if (mapper.is_set() && mapper.as_str() != "no") {
         retval.set("route_heuristic") = mapper.as_str();
     }
-    const auto &mapmaxalters = com::options::global["mapmaxalters"];
+    const auto &mapmaxalters = com::options::current()["mapmaxalters"];
     if (mapmaxalters.is_set()) {
         retval.set("max_alternative_routes") = mapmaxalters.as_str();
     }
-    const auto &mapassumezeroinitstate = com::options::global["mapassumezeroinitstate"];
+    const auto &mapassumezeroinitstate = com::options::current()["mapassumezeroinitstate"];
     if (mapassumezeroinitstate.is_set()) {
         retval.set("assume_initialized") = mapassumezeroinitstate.as_str();
     }
-    const auto &mapprepinitsstate = com::options::global["mapprepinitsstate"];
+    const auto &mapprepinitsstate = com::options::current()["mapprepinitsstate"];
     if (mapprepinitsstate.is_set()) {
         retval.set("assume_prep_only_initializes") = mapprepinitsstate.as_str();
     }
-    const auto &maplookahead = com::options::global["maplookahead"];
+    const auto &maplookahead = com::options::current()["maplookahead"];
     if (maplookahead.is_set()) {
         retval.set("lookahead_mode") = maplookahead.as_str();
     }
-    const auto &mappathselect = com::options::global["mappathselect"];
+    const auto &mappathselect = com::options::current()["mappathselect"];
     if (mappathselect.is_set()) {
         retval.set("path_selection_mode") = mappathselect.as_str();
     }
-    const auto &mapselectswaps = com::options::global["mapselectswaps"];
+    const auto &mapselectswaps = com::options::current()["mapselectswaps"];
     if (mapselectswaps.is_set()) {
         retval.set("swap_selection_mode") = mapselectswaps.as_str();
     }
-    const auto &maprecNN2q = com::options::global["maprecNN2q"];
+    const auto &maprecNN2q = com::options::current()["maprecNN2q"];
     if (maprecNN2q.is_set()) {
         retval.set("recurse_on_nn_two_qubit") = maprecNN2q.as_str();
     }
-    const auto &mapselectmaxlevel = com::options::global["mapselectmaxlevel"];
+    const auto &mapselectmaxlevel = com::options::current()["mapselectmaxlevel"];
     if (mapselectmaxlevel.is_set()) {
         retval.set("recursion_depth_limit") = mapselectmaxlevel.as_str();
     }
-    const auto &mapselectmaxwidth = com::options::global["mapselectmaxwidth"];
+    const auto &mapselectmaxwidth = com::options::current()["mapselectmaxwidth"];
     if (mapselectmaxwidth.is_set()) {
         if (mapselectmaxwidth.as_str() == "min") {
             retval.set("recursion_width_factor") = "1.0";
@@ -405,30 +405,30 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
             retval.set("recursion_width_factor") = "100000000000";
         }
     }
-    const auto &maptiebreak = com::options::global["maptiebreak"];
+    const auto &maptiebreak = com::options::current()["maptiebreak"];
     if (maptiebreak.is_set()) {
         retval.set("tie_break_method") = maptiebreak.as_str();
     }
-    const auto &mapusemoves = com::options::global["mapusemoves"];
+    const auto &mapusemoves = com::options::current()["mapusemoves"];
     if (mapusemoves.is_set()) {
         retval.set("use_moves") = mapusemoves.as_str();
     }
-    const auto &mapreverseswap = com::options::global["mapreverseswap"];
+    const auto &mapreverseswap = com::options::current()["mapreverseswap"];
     if (mapreverseswap.is_set()) {
         retval.set("reverse_swap_if_better") = mapreverseswap.as_str();
     }
 
 #if 0   // FIXME: removed, use pass options
     // Set options for CC backend.
-    const auto &backend_cc_map_input_file = com::options::global["backend_cc_map_input_file"];
+    const auto &backend_cc_map_input_file = com::options::current()["backend_cc_map_input_file"];
     if (backend_cc_map_input_file.is_set()) {
         retval.set("map_input_file") = backend_cc_map_input_file.as_str();
     }
-    const auto &backend_cc_verbose = com::options::global["backend_cc_verbose"];
+    const auto &backend_cc_verbose = com::options::current()["backend_cc_verbose"];
     if (backend_cc_verbose.is_set()) {
         retval.set("verbose") = backend_cc_verbose.as_str();
     }
-    const auto &backend_cc_run_once = com::options::global["backend_cc_run_once"];
+    const auto &backend_cc_run_once = com::options::current()["backend_cc_run_once"];
     if (backend_cc_run_once.is_set()) {
         retval.set("run_once") = backend_cc_run_once.as_str();
     }
@@ -551,21 +551,21 @@ Manager Manager::from_defaults(const ir::compat::PlatformRef &platform) {
         "io.cqasm.Report",
         "initialqasmwriter",
         {
-            {"output_prefix", com::options::global["output_dir"].as_str() + "/%N"},
+            {"output_prefix", com::options::current()["output_dir"].as_str() + "/%N"},
             {"output_suffix", ".qasm"},
             {"with_timing", "no"}
         }
     );
-    if (com::options::global["clifford_prescheduler"].as_bool()) {
+    if (com::options::current()["clifford_prescheduler"].as_bool()) {
         manager.append_pass(
             "opt.clifford.Optimize",
             "clifford_prescheduler"
         );
     }
-    if (com::options::global["prescheduler"].as_bool()) {
+    if (com::options::current()["prescheduler"].as_bool()) {
         if (
-            com::options::global["scheduler_uniform"].as_bool() ||
-            com::options::global["scheduler_heuristic"].is_set()
+            com::options::current()["scheduler_uniform"].as_bool() ||
+            com::options::current()["scheduler_heuristic"].is_set()
         ) {
             manager.append_pass(
                 "sch.Schedule",
@@ -585,7 +585,7 @@ Manager Manager::from_defaults(const ir::compat::PlatformRef &platform) {
             );
         }
     }
-    if (com::options::global["clifford_postscheduler"].as_bool()) {
+    if (com::options::current()["clifford_postscheduler"].as_bool()) {
         manager.append_pass(
             "opt.clifford.Optimize",
             "clifford_postscheduler"
@@ -595,7 +595,7 @@ Manager Manager::from_defaults(const ir::compat::PlatformRef &platform) {
         "io.cqasm.Report",
         "scheduledqasmwriter",
         {
-            {"output_prefix", com::options::global["output_dir"].as_str() + "/%N"},
+            {"output_prefix", com::options::current()["output_dir"].as_str() + "/%N"},
             {"output_suffix", "_scheduled.qasm"}
         }
     );
@@ -869,6 +869,48 @@ void Manager::construct() {
     root->construct_recursive();
 }
 
+/**
+ * Returns a copy of this pass manager, using the same pass factory and a copy
+ * of the pass tree (see pass_types::Base::clone()). Since a manager can only be
+ * used by one thread at a time, this allows a single compilation strategy to
+ * be applied to multiple programs concurrently.
+ */
+Manager Manager::clone() const {
+    Manager manager;
+    manager.pass_factory = pass_factory;
+    manager.root = root->clone();
+    return manager;
+}
+
+/**
+ * Returns the filename prefix for the profiling results of the given program.
+ */
+static utils::Str get_profile_prefix(const utils::Str &program_unique_name) {
+    utils::Str prefix = com::options::get("output_dir") + "/";
+    prefix += program_unique_name.empty() ? "program" : program_unique_name;
+    return prefix;
+}
+
+/**
+ * Ensures that all passes have been constructed, and then returns the prefixes
+ * of all output files that compiling a program with the given name and unique
+ * name may write, i.e. the output_prefix options of all passes after
+ * substitution, and the prefix used for the profiling results. The names must
+ * be empty for a program without kernels.
+ */
+utils::Set<utils::Str> Manager::get_output_prefixes(
+    const utils::Str &program_name,
+    const utils::Str &program_unique_name
+) {
+    construct();
+    utils::Set<utils::Str> prefixes;
+    root->get_output_prefixes(prefixes, program_name, program_unique_name);
+    if (com::options::current()["profile_passes"].as_bool()) {
+        prefixes.insert(get_profile_prefix(program_unique_name) + "_pass_");
+    }
+    return prefixes;
+}
+
 /**
  * Executes this pass or pass group on the given platform and program.
  */
@@ -877,9 +919,36 @@ void Manager::compile(const ir::Ref &ir) {
     // Ensure that all passes are constructed.
     construct();
 
+    // Set up the profiler, if requested.
+    ProfilerRef profiler;
+    if (com::options::current()["profile_passes"].as_bool()) {
+        profiler.emplace();
+    }
+
     // Compile the program.
-    root->compile(ir, "");
+    root->compile(ir, "", profiler);
 
+    // Write the profiling results.
+    if (profiler.has_value()) {
+        auto prefix = get_profile_prefix(ir->program.empty() ? "" : ir->program->unique_name);
+        profiler->write_report(prefix + "_pass_profile.json");
+        profiler->write_trace(prefix + "_pass_trace.json");
+    }
+
+    // Make sure buffered log messages for this compilation are written by the
+    // time we return.
+    utils::logger::flush();
+
+}
+
+/**
+ * Same as compile(const ir::Ref&), but uses the given options record instead
+ * of the global options for the duration of the compilation, on all threads
+ * involved in it. This includes the log level.
+ */
+void Manager::compile(const ir::Ref &ir, const utils::Options &options) {
+    com::options::Scope scope{options};
+    compile(ir);
 }
 
 } // namespace pmgr
@@ -0,0 +1,469 @@
+/** \file
+ * Cache for the per-block results of deterministic transformation passes.
+ */
+
+#include "ql/pmgr/pass_cache.h"
+
+#include <sstream>
+#include "ql/ir/ops.h"
+#include "ql/ir/describe.h"
+#include "ql/ir/cqasm/write.h"
+
+namespace ql {
+namespace pmgr {
+
+using namespace utils;
+
+/**
+ * Visitor that rebinds the links in a cloned block to the equivalent nodes of
+ * a different IR tree. The nodes are matched by name, or by their description
+ * for instruction and function types, since those may be overloaded. If a link
+ * cannot be rebound, or the block contains goto instructions, failed is set.
+ */
+class LinkRebinder : public ir::RecursiveVisitor {
+private:
+
+    /**
+     * The IR to rebind the links to.
+     */
+    const ir::Ref &ir;
+
+    /**
+     * The instruction types and function types of the platform, by their
+     * description. Built on first use.
+     */
+    Bool types_built = false;
+    Map<Str, ir::InstructionTypeLink> instruction_types;
+    Map<Str, ir::FunctionTypeLink> function_types;
+
+    /**
+     * Adds the given instruction type and all its specializations to the
+     * instruction_types map.
+     */
+    void add_instruction_type(const One<ir::InstructionType> &type) {
+        instruction_types.set(ir::describe(*type)) = type;
+        for (const auto &spec : type->specializations) {
+            add_instruction_type(spec);
+        }
+    }
+
+    /**
+     * Builds the instruction_types and function_types maps if this wasn't
+     * done yet.
+     */
+    void build_types() {
+        if (types_built) {
+            return;
+        }
+        types_built = true;
+        for (const auto &type : ir->platform->instructions) {
+            add_instruction_type(type);
+        }
+        for (const auto &type : ir->platform->functions) {
+            function_types.set(ir::describe(*type)) = type;
+        }
+    }
+
+    /**
+     * Rebinds the given data type link.
+     */
+    void rebind(ir::DataTypeLink &data_type) {
+        if (failed) {
+            return;
+        }
+        auto new_data_type = ir::find_type(ir, data_type->name);
+        if (new_data_type.empty()) {
+            failed = true;
+            return;
+        }
+        data_type = new_data_type;
+    }
+
+public:
+
+    /**
+     * Whether rebinding failed for any link.
+     */
+    Bool failed = false;
+
+    /**
+     * Constructs a rebinder for the given IR.
+     */
+    explicit LinkRebinder(const ir::Ref &ir) : ir(ir) {}
+
+    /**
+     * Fallback for nodes that don't contain links.
+     */
+    void visit_node(ir::Node &node) override {
+    }
+
+    /**
+     * Rebinds the instruction type of a custom instruction.
+     */
+    void visit_custom_instruction(ir::CustomInstruction &node) override {
+        ir::RecursiveVisitor::visit_custom_instruction(node);
+        if (failed) {
+            return;
+        }
+        build_types();
+        auto it = instruction_types.find(ir::describe(*node.instruction_type));
+        if (it == instruction_types.end()) {
+            failed = true;
+            return;
+        }
+        node.instruction_type = it->second;
+    }
+
+    /**
+     * Goto instructions refer to other blocks, which are not part of the
+     * cached result, so they cannot be rebound.
+     */
+    void visit_goto_instruction(ir::GotoInstruction &node) override {
+        failed = true;
+    }
+
+    /**
+     * Rebinds the function type of a function call.
+     */
+    void visit_function_call(ir::FunctionCall &node) override {
+        ir::RecursiveVisitor::visit_function_call(node);
+        if (failed) {
+            return;
+        }
+        build_types();
+        auto it = function_types.find(ir::describe(*node.function_type));
+        if (it == function_types.end()) {
+            failed = true;
+            return;
+        }
+        node.function_type = it->second;
+    }
+
+    /**
+     * Rebinds the target and data type of a reference.
+     */
+    void visit_reference(ir::Reference &node) override {
+        ir::RecursiveVisitor::visit_reference(node);
+        rebind(node.data_type);
+        if (failed) {
+            return;
+        }
+        const auto &name = node.target->name;
+        ir::ObjectLink target;
+        if (node.target->as_physical_object()) {
+            target = ir::find_physical_object(ir, name);
+        } else if (!ir->program.empty()) {
+            for (const auto &object : ir->program->objects) {
+                if (object->name == name) {
+                    target = object;
+                    break;
+                }
+            }
+        }
+        if (target.empty()) {
+            failed = true;
+            return;
+        }
+        node.target = target;
+    }
+
+    /**
+     * Rebinds the data types of literals.
+     */
+    void visit_bit_literal(ir::BitLiteral &node) override {
+        rebind(node.data_type);
+    }
+    void visit_int_literal(ir::IntLiteral &node) override {
+        rebind(node.data_type);
+    }
+    void visit_real_literal(ir::RealLiteral &node) override {
+        rebind(node.data_type);
+    }
+    void visit_complex_literal(ir::ComplexLiteral &node) override {
+        rebind(node.data_type);
+    }
+    void visit_real_matrix_literal(ir::RealMatrixLiteral &node) override {
+        rebind(node.data_type);
+    }
+    void visit_complex_matrix_literal(ir::ComplexMatrixLiteral &node) override {
+        rebind(node.data_type);
+    }
+    void visit_string_literal(ir::StringLiteral &node) override {
+        rebind(node.data_type);
+    }
+    void visit_json_literal(ir::JsonLiteral &node) override {
+        rebind(node.data_type);
+    }
+
+};
+
+/**
+ * Writes a description of the given data type to the given stream. Unlike
+ * ir::describe(), this includes the kind of the type and its parameters.
+ */
+static void describe_data_type(const ir::DataType &data_type, std::ostream &ss) {
+    ss << data_type.name << ": ";
+    if (data_type.as_qubit_type()) {
+        ss << "qubit";
+    } else if (data_type.as_bit_type()) {
+        ss << "bit";
+    } else if (auto int_type = data_type.as_int_type()) {
+        ss << (int_type->is_signed ? "int" : "uint") << int_type->bits;
+    } else if (data_type.as_real_type()) {
+        ss << "real";
+    } else if (data_type.as_complex_type()) {
+        ss << "complex";
+    } else if (auto matrix_type = data_type.as_matrix_type()) {
+        ss << (matrix_type->as_real_matrix_type() ? "real" : "complex");
+        ss << "[" << matrix_type->num_rows << ", " << matrix_type->num_cols << "]";
+    } else if (data_type.as_string_type()) {
+        ss << "string";
+    } else if (data_type.as_json_type()) {
+        ss << "json";
+    } else {
+        QL_ICE("unknown data type");
+    }
+}
+
+/**
+ * Returns the process-wide pass cache.
+ */
+PassCache &PassCache::get() {
+    static PassCache cache;
+    return cache;
+}
+
+/**
+ * Returns the part of the cache key that is shared by all blocks processed by
+ * a single run of a pass, based on the pass type name, the pass options, the
+ * platform, and the data type and object declarations of the program.
+ */
+Str PassCache::make_key_prefix(
+    const ir::Ref &ir,
+    const Str &type_name,
+    const Options &options
+) {
+    std::ostringstream ss;
+    ss << type_name << "\n";
+    options.dump_options(false, ss);
+    ss << ir->platform->name << "\n";
+    ss << ir->platform->data.dump() << "\n";
+
+    // The cQASM representation of a block only refers to data types and
+    // objects by name, so their declarations must be part of the key as well.
+    for (const auto &data_type : ir->platform->data_types) {
+        ss << "type ";
+        describe_data_type(*data_type, ss);
+        ss << "\n";
+    }
+    for (const auto &object : ir->platform->objects) {
+        ss << "physical " << ir::describe(*object) << "\n";
+    }
+    if (!ir->program.empty()) {
+        for (const auto &object : ir->program->objects) {
+            ss << (object->as_temporary_object() ? "temporary " : "variable ");
+            ss << ir::describe(*object) << "\n";
+        }
+    }
+
+    return ss.str();
+}
+
+/**
+ * Interns the given key prefix, as returned by make_key_prefix(), and returns
+ * its ID. Every call must be paired with a call to release_prefix() when the
+ * ID is no longer needed to build keys.
+ */
+UInt PassCache::acquire_prefix(const Str &prefix) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = prefix_ids.find(prefix);
+    if (it == prefix_ids.end()) {
+        it = prefix_ids.emplace(prefix, next_prefix_id++).first;
+        prefixes.set(it->second) = {&it->first, 0};
+    }
+    prefixes.at(it->second).uses++;
+    return it->second;
+}
+
+/**
+ * Decrements the use count of the given prefix, and forgets about it when it
+ * is no longer used. The mutex must be held.
+ */
+void PassCache::release_prefix_locked(UInt prefix_id) {
+    auto it = prefixes.find(prefix_id);
+    QL_ASSERT(it != prefixes.end() && it->second.uses > 0);
+    if (--it->second.uses) {
+        return;
+    }
+    prefix_ids.erase(prefix_ids.find(*it->second.text));
+    prefixes.erase(it);
+}
+
+/**
+ * Releases a prefix ID returned by acquire_prefix().
+ */
+void PassCache::release_prefix(UInt prefix_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    release_prefix_locked(prefix_id);
+}
+
+/**
+ * Returns the cache key for the given block, using the ID of its key prefix as
+ * returned by acquire_prefix().
+ */
+Str PassCache::make_key(
+    const ir::Ref &ir,
+    UInt prefix_id,
+    const ir::BlockRef &block
+) {
+    ir::cqasm::WriteOptions write_options;
+    write_options.include_statistics = false;
+    write_options.include_metadata = true;
+    write_options.include_timing = true;
+    return to_string(prefix_id) + "\n" + ir::cqasm::to_string(ir, block.as<ir::Node>(), write_options);
+}
+
+/**
+ * Looks up the cached result for the given key. If there is one and it can be
+ * rebound to the given IR, the statements and annotations of the given block
+ * are replaced with those of the cached result, retval is set to the cached
+ * return value, and true is returned. Otherwise, the block is left unchanged
+ * and false is returned.
+ */
+Bool PassCache::restore(
+    const ir::Ref &ir,
+    const Str &key,
+    const ir::BlockRef &block,
+    Int &retval
+) {
+    Ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            misses++;
+            return false;
+        }
+        entry = it->second;
+    }
+
+    // Entries are immutable once stored, so we can clone and rebind without
+    // holding the lock.
+    auto result = entry->block.clone();
+    LinkRebinder rebinder{ir};
+    result->visit(rebinder);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (rebinder.failed) {
+            misses++;
+            return false;
+        }
+        hits++;
+    }
+
+    // Move the statements into the existing block node rather than replacing
+    // the node, such that links to it remain valid.
+    block->statements = result->statements;
+    block->copy_annotations(*result);
+    retval = entry->retval;
+    return true;
+}
+
+/**
+ * Stores the result of a pass for the given key, built with the given prefix
+ * ID, evicting the oldest entries if this would make the cache exceed the
+ * given number of entries. Blocks that cannot be restored later are not
+ * stored.
+ */
+void PassCache::store(
+    const ir::Ref &ir,
+    UInt prefix_id,
+    const Str &key,
+    const ir::BlockRef &block,
+    Int retval,
+    UInt max_entries
+) {
+
+    // Check that the block can be rebound at all by rebinding a clone to the
+    // IR it came from.
+    auto clone = block.clone();
+    LinkRebinder rebinder{ir};
+    clone->visit(rebinder);
+    if (rebinder.failed) {
+        return;
+    }
+
+    auto entry = Ptr<Entry>::make();
+    entry->block = clone;
+    entry->retval = retval;
+    entry->prefix_id = prefix_id;
+    entry->platform = ir->platform;
+    if (!ir->program.empty()) {
+        entry->objects = ir->program->objects;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        order.push_back(key);
+        prefixes.at(prefix_id).uses++;
+        entries.set(key) = entry;
+    } else {
+        it->second = entry;
+    }
+    while (order.size() > max_entries) {
+        auto evicted = entries.find(order.front());
+        release_prefix_locked(evicted->second->prefix_id);
+        entries.erase(evicted);
+        order.pop_front();
+    }
+}
+
+/**
+ * Removes all entries from the cache and resets the statistics.
+ */
+void PassCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &it : entries) {
+        release_prefix_locked(it.second->prefix_id);
+    }
+    entries.clear();
+    order.clear();
+    hits = 0;
+    misses = 0;
+}
+
+/**
+ * Returns the number of entries in the cache.
+ */
+UInt PassCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+/**
+ * Returns the number of distinct key prefixes the cache currently holds.
+ */
+UInt PassCache::get_num_prefixes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return prefixes.size();
+}
+
+/**
+ * Returns the number of cache hits since construction or the last clear().
+ */
+UInt PassCache::get_hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+/**
+ * Returns the number of cache misses since construction or the last clear().
+ */
+UInt PassCache::get_misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+} // namespace pmgr
+} // namespace ql
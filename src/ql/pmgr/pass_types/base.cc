@@ -988,6 +988,36 @@ condition::Ref Base::get_condition() {
     return condition;
 }
 
+/**
+ * Returns a copy of this pass and, recursively, its sub-passes, with the same
+ * options and in the same state of construction. The copy can be used
+ * independently of the original, for instance by another thread.
+ */
+Ref Base::clone() const {
+    auto pass = Factory::build_pass(pass_factory, type_name, instance_name);
+    pass->options.update_from(options);
+    if (!is_constructed()) {
+        return pass;
+    }
+
+    // Construct the copy from the same options, such that any state the pass
+    // implementation derives from them is rebuilt. The sub-passes and
+    // condition may have been modified by the user after construction,
+    // though, so these are copied from the original instead.
+    pass->construct();
+    QL_ASSERT(pass->node_type == node_type);
+    pass->sub_pass_order.clear();
+    pass->sub_pass_names.clear();
+    for (const auto &sub_pass : sub_pass_order) {
+        auto sub_pass_clone = sub_pass->clone();
+        pass->sub_pass_order.push_back(sub_pass_clone);
+        pass->sub_pass_names.set(sub_pass_clone->get_name()) = sub_pass_clone;
+    }
+    pass->condition = condition;
+
+    return pass;
+}
+
 /**
  * Handles the debug option. Called once before and once after compile().
  * after_pass is false when run before, and true when run after.
@@ -1001,14 +1031,18 @@ void Base::handle_debugging(
     auto debug_opt = options["debug"].as_str();
     if (debug_opt == "yes") {
         ir->dump_seq(
-            utils::OutFile(context.output_prefix + "_debug_" + in_or_out + ".ir").unwrap()
+            utils::OutFile(
+                context.output_prefix + "_debug_" + in_or_out + ".ir",
+                ir::cqasm::WRITE_BUFFER_SIZE
+            ).unwrap()
         );
 
         ir::cqasm::WriteOptions write_options;
         write_options.include_statistics = true;
-        ir::cqasm::write(
-            ir, write_options,
-            utils::OutFile(context.output_prefix + "_debug_" + in_or_out + ".cq").unwrap()
+        ir::cqasm::write_file(
+            ir,
+            context.output_prefix + "_debug_" + in_or_out + ".cq",
+            write_options
         );
     }
     if (debug_opt == "stats" || debug_opt == "both") {
@@ -1018,9 +1052,9 @@ void Base::handle_debugging(
         );
     }
     if (debug_opt == "qasm" || debug_opt == "both") {
-        ir::cqasm::write(
-            ir, {},
-            utils::OutFile(context.output_prefix + "_" + in_or_out + ".qasm").unwrap()
+        ir::cqasm::write_file(
+            ir,
+            context.output_prefix + "_" + in_or_out + ".qasm"
         );
     }
 }
@@ -1049,77 +1083,124 @@ void Base::run_sub_passes(
 ) const {
     utils::Str sub_prefix = context.full_pass_name.empty() ? "" : (context.full_pass_name + ".");
     for (const auto &pass : sub_pass_order) {
-        pass->compile(ir, sub_prefix);
+        pass->compile(ir, sub_prefix, context.profiler);
     }
 }
 
 /**
- * Executes this pass or pass group on the given platform and program.
+ * Returns the prefix for the output products of this pass, obtained by applying
+ * the substitution rules of the output_prefix option for the given
+ * fully-qualified pass name and program. The program names must be empty if
+ * there is no program.
  */
-void Base::compile(
-    const ir::Ref &ir,
-    const utils::Str &pass_name_prefix
-) {
-
-    // The passes should already have been constructed by the pass manager.
-    QL_ASSERT(is_constructed());
-
-    // Construct pass context.
-    Context context{
-        pass_name_prefix + instance_name,   // -> .full_pass_name
-        {},                                 // -> .output_prefix
-        options                             // -> .options
-    };
-
-    // Apply substitution rules for the output prefix option.
+utils::Str Base::get_output_prefix(
+    const utils::Str &full_pass_name,
+    const utils::Str &program_name,
+    const utils::Str &program_unique_name
+) const {
+    utils::Str output_prefix;
     utils::Bool special = false;
     for (auto c : options["output_prefix"].as_str()) {
         if (special) {
             switch (c) {
                 case '%':
-                    context.output_prefix += '%';
+                    output_prefix += '%';
                     break;
                 case 'n':
-                    if (!ir->program.empty()) {
-                        context.output_prefix += ir->program->name;
-                    }
+                    output_prefix += program_name;
                     break;
                 case 'N':
-                    if (!ir->program.empty()) {
-                        context.output_prefix += ir->program->unique_name;
-                    }
+                    output_prefix += program_unique_name;
                     break;
                 case 'p':
-                    context.output_prefix += instance_name;
+                    output_prefix += instance_name;
                     break;
                 case 'P':
-                    context.output_prefix += context.full_pass_name;
+                    output_prefix += full_pass_name;
                     break;
                 case 'U':
-                    context.output_prefix += utils::replace_all(context.full_pass_name, ".", "_");
+                    output_prefix += utils::replace_all(full_pass_name, ".", "_");
                     break;
                 case 'D':
-                    context.output_prefix += utils::replace_all(context.full_pass_name, ".", "/");
+                    output_prefix += utils::replace_all(full_pass_name, ".", "/");
                     break;
                 default:
                     throw utils::Exception(
                         "undefined substitution sequence in output_prefix option "
-                        "for pass " + context.full_pass_name + ": %" + c
+                        "for pass " + full_pass_name + ": %" + c
                     );
             }
             special = false;
         } else if (c == '%') {
             special = true;
         } else {
-            context.output_prefix += c;
+            output_prefix += c;
         }
     }
     if (special) {
         throw utils::Exception(
             "unterminated substitution sequence in output_prefix option "
-            "for pass " + context.full_pass_name
+            "for pass " + full_pass_name
         );
     }
+    return output_prefix;
+}
+
+/**
+ * Adds the output prefixes of this pass and, recursively, its sub-passes to
+ * prefixes, as they would be when compiling a program with the given names.
+ * See get_output_prefix().
+ */
+void Base::get_output_prefixes(
+    utils::Set<utils::Str> &prefixes,
+    const utils::Str &program_name,
+    const utils::Str &program_unique_name,
+    const utils::Str &pass_name_prefix
+) const {
+    auto full_pass_name = pass_name_prefix + instance_name;
+    prefixes.insert(get_output_prefix(full_pass_name, program_name, program_unique_name));
+    if (is_group()) {
+        utils::Str sub_prefix = full_pass_name.empty() ? "" : (full_pass_name + ".");
+        for (const auto &pass : sub_pass_order) {
+            pass->get_output_prefixes(prefixes, program_name, program_unique_name, sub_prefix);
+        }
+    }
+}
+
+/**
+ * Executes this pass or pass group on the given platform and program. If a
+ * profiler is specified, the resource usage of this pass and its sub-passes is
+ * recorded with it. The record is also ended when the pass throws.
+ */
+void Base::compile(
+    const ir::Ref &ir,
+    const utils::Str &pass_name_prefix,
+    const ProfilerRef &profiler
+) {
+
+    // The passes should already have been constructed by the pass manager.
+    QL_ASSERT(is_constructed());
+
+    // Construct pass context.
+    Context context{
+        pass_name_prefix + instance_name,   // -> .full_pass_name
+        {},                                 // -> .output_prefix
+        options,                            // -> .options
+        profiler                            // -> .profiler
+    };
+
+    // Apply substitution rules for the output prefix option.
+    context.output_prefix = get_output_prefix(
+        context.full_pass_name,
+        ir->program.empty() ? "" : ir->program->name,
+        ir->program.empty() ? "" : ir->program->unique_name
+    );
+
+    // Start recording resource usage, if requested.
+    utils::UInt profile_handle = 0;
+    if (profiler.has_value()) {
+        profile_handle = profiler->pass_start(ir, context.full_pass_name, type_name);
+    }
 
     std::string compile_phase = "<not defined>";
     try {
@@ -1189,10 +1270,27 @@ void Base::compile(
         handle_debugging(ir, context, true);
 
     } catch (utils::Exception &e) {
+
+        // Stop recording resource usage, such that the profiler remains
+        // consistent for whoever handles the exception.
+        if (profiler.has_value()) {
+            profiler->pass_end(profile_handle, ir);
+        }
+
         if (context.full_pass_name.size() != 0) {   // not at top level
             e.add_context("in pass " + context.full_pass_name + ", phase " + compile_phase);
         }
         throw;
+    } catch (...) {
+        if (profiler.has_value()) {
+            profiler->pass_end(profile_handle, ir);
+        }
+        throw;
+    }
+
+    // Stop recording resource usage.
+    if (profiler.has_value()) {
+        profiler->pass_end(profile_handle, ir);
     }
 }
 
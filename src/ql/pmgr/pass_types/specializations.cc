@@ -5,6 +5,9 @@
 
 #include "ql/pmgr/pass_types/specializations.h"
 
+#include "ql/utils/parallel.h"
+#include "ql/com/options.h"
+#include "ql/pmgr/pass_cache.h"
 #include "ql/ir/new_to_old.h"
 #include "ql/ir/old_to_new.h"
 
@@ -12,6 +15,45 @@ namespace ql {
 namespace pmgr {
 namespace pass_types {
 
+/**
+ * Converts the new IR to the legacy IR for running a legacy pass, recording
+ * the time taken with the profiler if profiling is enabled.
+ */
+static ir::compat::ProgramRef convert_to_legacy(
+    const ir::Ref &ir,
+    const Context &context
+) {
+    if (!context.profiler.has_value()) {
+        return ir::convert_new_to_old(ir);
+    }
+    auto start_time = context.profiler->now();
+    auto program = ir::convert_new_to_old(ir);
+    context.profiler->record_conversion("convert_new_to_old", start_time);
+    return program;
+}
+
+/**
+ * Converts the legacy IR back to the new IR after running a legacy pass,
+ * recording the time taken with the profiler if profiling is enabled.
+ */
+static void convert_from_legacy(
+    const ir::compat::ProgramRef &program,
+    const ir::Ref &ir,
+    const Context &context
+) {
+    utils::Real start_time = 0.0;
+    if (context.profiler.has_value()) {
+        start_time = context.profiler->now();
+    }
+    auto new_ir = ir::convert_old_to_new(program);
+    ir->program = new_ir->program;
+    ir->platform = new_ir->platform;
+    ir->copy_annotations(*new_ir);
+    if (context.profiler.has_value()) {
+        context.profiler->record_conversion("convert_old_to_new", start_time);
+    }
+}
+
 /**
  * Constructs the abstract pass group. No error checking here; this is up to
  * the parent pass group.
@@ -93,6 +135,63 @@ utils::Int Transformation::run_internal(
     return run(ir, context);
 }
 
+/**
+ * Helper for passes that transform each block of the program independently
+ * and deterministically, i.e. for which the result for a block only depends on
+ * the contents of that block, the platform, and the pass options. Calls fn for
+ * each block of the program, and returns the sum of the return values. When
+ * the pass_cache global option is set and cacheable is true, blocks for which
+ * a result is cached (see PassCache) are skipped, and the results of fn are
+ * added to the cache. cacheable should be set to false for configurations in
+ * which fn has side effects other than modifying the block, such as writing
+ * output files.
+ */
+utils::Int Transformation::run_on_blocks(
+    const ir::Ref &ir,
+    const std::function<utils::Int(const ir::BlockRef &block)> &fn,
+    utils::Bool cacheable
+) const {
+    utils::Int retval = 0;
+    if (ir->program.empty()) {
+        return retval;
+    }
+
+    const auto &global_options = com::options::current();
+    if (!cacheable || !global_options["pass_cache"].as_bool()) {
+        for (const auto &block : ir->program->blocks) {
+            retval += fn(block);
+        }
+        return retval;
+    }
+
+    auto &cache = PassCache::get();
+    auto max_entries = global_options["pass_cache_size"].as_uint();
+    auto prefix_id = cache.acquire_prefix(PassCache::make_key_prefix(ir, type_name, options));
+    utils::UInt num_hits = 0;
+    try {
+        for (const auto &block : ir->program->blocks) {
+            auto key = PassCache::make_key(ir, prefix_id, block);
+            utils::Int block_retval = 0;
+            if (cache.restore(ir, key, block, block_retval)) {
+                num_hits++;
+            } else {
+                block_retval = fn(block);
+                cache.store(ir, prefix_id, key, block, block_retval, max_entries);
+            }
+            retval += block_retval;
+        }
+    } catch (...) {
+        cache.release_prefix(prefix_id);
+        throw;
+    }
+    cache.release_prefix(prefix_id);
+    QL_DOUT(
+        "pass cache: " << num_hits << " of " << ir->program->blocks.size() <<
+        " block(s) restored from cache"
+    );
+    return retval;
+}
+
 /**
  * Constructs the pass. No error checking here; this is up to the parent
  * pass group.
@@ -111,12 +210,9 @@ utils::Int ProgramTransformation::run_internal(
     const ir::Ref &ir,
     const Context &context
 ) const {
-    auto program = ir::convert_new_to_old(ir);
+    auto program = convert_to_legacy(ir, context);
     auto retval = run(program, context);
-    auto new_ir = ir::convert_old_to_new(program);
-    ir->program = new_ir->program;
-    ir->platform = new_ir->platform;
-    ir->copy_annotations(*new_ir);
+    convert_from_legacy(program, ir, context);
     return retval;
 }
 
@@ -138,6 +234,25 @@ KernelTransformation::KernelTransformation(
 ) : Normal(pass_factory, instance_name, type_name) {
 }
 
+/**
+ * Declares that this pass is kernel-independent, i.e. that run() only modifies
+ * the given kernel and only reads the program and platform, such that multiple
+ * kernels can safely be processed concurrently. This adds the
+ * `parallel_kernels` option to the pass, with which the user can select the
+ * number of threads. Must be called from the constructor of the derived pass.
+ */
+void KernelTransformation::enable_parallel_kernels() {
+    options.add_int(
+        "parallel_kernels",
+        "The number of threads used to process the kernels of the program "
+        "concurrently. The result does not depend on this setting, but log "
+        "messages for different kernels may be interleaved. 0 means that the "
+        "number of hardware threads is used.",
+        "1",
+        0, utils::MAX
+    );
+}
+
 /**
  * Initial accumulator value for the return value. Defaults to zero.
  */
@@ -162,15 +277,31 @@ utils::Int KernelTransformation::run_internal(
     const ir::Ref &ir,
     const Context &context
 ) const {
-    auto program = ir::convert_new_to_old(ir);
+    auto program = convert_to_legacy(ir, context);
     utils::Int accumulator = retval_initialize();
-    for (const auto &kernel : program->kernels) {
-        accumulator = retval_accumulate(accumulator, run(program, kernel, context));
+    if (options.has_option("parallel_kernels")) {
+
+        // Process the kernels concurrently, and reduce the return values in
+        // kernel order afterwards, such that the result is the same as for
+        // the sequential case.
+        utils::Vec<utils::Int> retvals(program->kernels.size(), 0);
+        utils::parallel_for(
+            program->kernels.size(),
+            options["parallel_kernels"].as_uint(),
+            [&](utils::UInt i) {
+                retvals[i] = run(program, program->kernels[i], context);
+            }
+        );
+        for (auto retval : retvals) {
+            accumulator = retval_accumulate(accumulator, retval);
+        }
+
+    } else {
+        for (const auto &kernel : program->kernels) {
+            accumulator = retval_accumulate(accumulator, run(program, kernel, context));
+        }
     }
-    auto new_ir = ir::convert_old_to_new(program);
-    ir->program = new_ir->program;
-    ir->platform = new_ir->platform;
-    ir->copy_annotations(*new_ir);
+    convert_from_legacy(program, ir, context);
     return accumulator;
 }
 
@@ -220,12 +351,9 @@ utils::Int ProgramAnalysis::run_internal(
     const ir::Ref &ir,
     const Context &context
 ) const {
-    auto program = ir::convert_new_to_old(ir);
+    auto program = convert_to_legacy(ir, context);
     auto retval = run(program, context);
-    auto new_ir = ir::convert_old_to_new(program);
-    ir->program = new_ir->program;
-    ir->platform = new_ir->platform;
-    ir->copy_annotations(*new_ir);
+    convert_from_legacy(program, ir, context);
     return retval;
 }
 
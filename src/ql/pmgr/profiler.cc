@@ -0,0 +1,307 @@
+/** \file
+ * Profiler for recording the resource usage of passes.
+ */
+
+#include "ql/pmgr/profiler.h"
+
+#include <fstream>
+#include <iomanip>
+#include "ql/utils/json.h"
+#include "ql/utils/filesystem.h"
+#include "ql/ir/ops.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+namespace ql {
+namespace pmgr {
+
+using namespace utils;
+
+/**
+ * Write buffer size used when writing profiler output files.
+ */
+static const UInt WRITE_BUFFER_SIZE = 1024 * 1024;
+
+/**
+ * Returns the current resident set size of the process in bytes, or 0 if this
+ * is not supported on the host platform.
+ */
+static UInt get_current_rss() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    UInt size = 0;
+    UInt resident = 0;
+    if (statm >> size >> resident) {
+        return resident * (UInt)sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Returns the peak resident set size of the process in bytes, or 0 if this is
+ * not supported on the host platform.
+ */
+static UInt get_peak_rss() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (!getrusage(RUSAGE_SELF, &usage)) {
+#ifdef __APPLE__
+        return (UInt)usage.ru_maxrss;
+#else
+        return (UInt)usage.ru_maxrss * 1024;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Counts the nodes in the given expression.
+ */
+static void count_expression(const ir::ExpressionRef &expression, UInt &nodes) {
+    nodes++;
+    if (auto ref = expression->as_reference()) {
+        for (const auto &index : ref->indices) {
+            count_expression(index, nodes);
+        }
+    } else if (auto fnc = expression->as_function_call()) {
+        for (const auto &operand : fnc->operands) {
+            count_expression(operand, nodes);
+        }
+    }
+}
+
+/**
+ * Counts the statements and nodes in the given block, including those in
+ * structured control-flow sub-blocks.
+ */
+static void count_block(const ir::BlockBase &block, UInt &statements, UInt &nodes) {
+    nodes++;
+    for (const auto &statement : block.statements) {
+        statements++;
+        nodes++;
+        if (statement->as_instruction()) {
+            for (const auto &operand : ir::get_operands(statement.as<ir::Instruction>())) {
+                count_expression(operand, nodes);
+            }
+            if (auto cond = statement->as_conditional_instruction()) {
+                count_expression(cond->condition, nodes);
+            }
+        } else if (auto if_else = statement->as_if_else()) {
+            for (const auto &branch : if_else->branches) {
+                nodes++;
+                count_expression(branch->condition, nodes);
+                count_block(*branch->body, statements, nodes);
+            }
+            if (!if_else->otherwise.empty()) {
+                count_block(*if_else->otherwise, statements, nodes);
+            }
+        } else if (auto loop = statement->as_loop()) {
+            if (auto dynamic_loop = statement->as_dynamic_loop()) {
+                count_expression(dynamic_loop->condition, nodes);
+            }
+            count_block(*loop->body, statements, nodes);
+        }
+    }
+}
+
+/**
+ * Counts the statements and nodes in the program of the given IR.
+ */
+static void count_program(const ir::Ref &ir, UInt &statements, UInt &nodes) {
+    statements = 0;
+    nodes = 0;
+    if (ir->program.empty()) {
+        return;
+    }
+    for (const auto &block : ir->program->blocks) {
+        count_block(*block, statements, nodes);
+    }
+}
+
+/**
+ * Returns the process CPU time in seconds since the profiler was constructed.
+ */
+Real Profiler::cpu_now() const {
+    return (Real)(std::clock() - cpu_epoch) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Constructs a new profiler, with no records.
+ */
+Profiler::Profiler() :
+    wall_epoch(std::chrono::steady_clock::now()),
+    cpu_epoch(std::clock())
+{ }
+
+/**
+ * Returns the wall-clock time in seconds since the profiler was constructed.
+ */
+Real Profiler::now() const {
+    return std::chrono::duration<Real>(std::chrono::steady_clock::now() - wall_epoch).count();
+}
+
+/**
+ * Records the start of a pass, and returns a handle for pass_end().
+ */
+UInt Profiler::pass_start(
+    const ir::Ref &ir,
+    const Str &full_pass_name,
+    const Str &type_name
+) {
+    PassProfile profile;
+    profile.full_pass_name = full_pass_name;
+    profile.type_name = type_name;
+    profile.depth = running.size();
+    profile.conversion_time = 0.0;
+    profile.rss_before = get_current_rss();
+    profile.peak_rss_before = get_peak_rss();
+    count_program(ir, profile.statements_before, profile.nodes_before);
+    profile.statements_after = profile.statements_before;
+    profile.nodes_after = profile.nodes_before;
+    profile.rss_after = profile.rss_before;
+    profile.peak_rss_after = profile.peak_rss_before;
+
+    // Sample the clocks last, such that the measurements above aren't
+    // attributed to the pass.
+    profile.wall_time = 0.0;
+    profile.cpu_time = -cpu_now();
+    profile.start_time = now();
+
+    running.push_back(profiles.size());
+    profiles.push_back(profile);
+    return running.back();
+}
+
+/**
+ * Records the end of the pass started with the given handle. Passes must end
+ * in the reverse order in which they were started.
+ */
+void Profiler::pass_end(
+    UInt handle,
+    const ir::Ref &ir
+) {
+    if (running.empty() || running.back() != handle) {
+        QL_ICE("pass profiler records must be ended in reverse order of starting");
+    }
+    running.pop_back();
+    auto &profile = profiles[handle];
+    profile.wall_time = now() - profile.start_time;
+    profile.cpu_time += cpu_now();
+    profile.rss_after = get_current_rss();
+    profile.peak_rss_after = get_peak_rss();
+    count_program(ir, profile.statements_after, profile.nodes_after);
+}
+
+/**
+ * Records a conversion between the new and the legacy IR that started at the
+ * given time (as returned by now()) and ends now, attributing it to the
+ * innermost running pass.
+ */
+void Profiler::record_conversion(
+    const Str &name,
+    Real start_time
+) {
+    Real duration = now() - start_time;
+    conversions.push_back({name, start_time, duration});
+    if (!running.empty()) {
+        profiles[running.back()].conversion_time += duration;
+    }
+}
+
+/**
+ * Returns the records for all passes executed so far.
+ */
+const Vec<PassProfile> &Profiler::get_profiles() const {
+    return profiles;
+}
+
+/**
+ * Writes the recorded data as a JSON report to the given file.
+ */
+void Profiler::write_report(const Str &filename) const {
+    Json passes = Json::array();
+    for (const auto &profile : profiles) {
+        passes.push_back({
+            {"name", profile.full_pass_name},
+            {"type", profile.type_name},
+            {"depth", profile.depth},
+            {"start_s", profile.start_time},
+            {"wall_s", profile.wall_time},
+            {"cpu_s", profile.cpu_time},
+            {"ir_conversion_s", profile.conversion_time},
+            {"rss_before_bytes", profile.rss_before},
+            {"rss_after_bytes", profile.rss_after},
+            {"rss_delta_bytes", (Int)profile.rss_after - (Int)profile.rss_before},
+            {"peak_rss_before_bytes", profile.peak_rss_before},
+            {"peak_rss_after_bytes", profile.peak_rss_after},
+            {"statements_before", profile.statements_before},
+            {"statements_after", profile.statements_after},
+            {"nodes_before", profile.nodes_before},
+            {"nodes_after", profile.nodes_after}
+        });
+    }
+    Json report = {{"passes", passes}};
+
+    QL_IOUT("writing pass profile report to '" << filename << "' ...");
+    OutFile file{filename, WRITE_BUFFER_SIZE};
+    file << std::setw(4) << report << "\n";
+    file.close();
+}
+
+/**
+ * Writes the recorded data as a trace-event JSON file, as understood by
+ * Chrome's about:tracing and Perfetto, to the given file.
+ */
+void Profiler::write_trace(const Str &filename) const {
+
+    // All events are complete ("X") events on a single thread, with
+    // timestamps in microseconds. Events nest based on their time span.
+    Json events = Json::array();
+    for (const auto &profile : profiles) {
+        events.push_back({
+            {"name", profile.full_pass_name.empty() ? "<root>" : profile.full_pass_name},
+            {"cat", profile.type_name.empty() ? "group" : "pass"},
+            {"ph", "X"},
+            {"ts", profile.start_time * 1e6},
+            {"dur", profile.wall_time * 1e6},
+            {"pid", 1},
+            {"tid", 1},
+            {"args", {
+                {"type", profile.type_name},
+                {"cpu_ms", profile.cpu_time * 1e3},
+                {"rss_delta_bytes", (Int)profile.rss_after - (Int)profile.rss_before},
+                {"peak_rss_bytes", profile.peak_rss_after},
+                {"statements_after", profile.statements_after},
+                {"nodes_after", profile.nodes_after}
+            }}
+        });
+    }
+    for (const auto &conversion : conversions) {
+        events.push_back({
+            {"name", conversion.name},
+            {"cat", "ir_conversion"},
+            {"ph", "X"},
+            {"ts", conversion.start_time * 1e6},
+            {"dur", conversion.duration * 1e6},
+            {"pid", 1},
+            {"tid", 1}
+        });
+    }
+    Json trace = {
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"}
+    };
+
+    QL_IOUT("writing pass profile trace to '" << filename << "' ...");
+    OutFile file{filename, WRITE_BUFFER_SIZE};
+    file << trace << "\n";
+    file.close();
+}
+
+} // namespace pmgr
+} // namespace ql
@@ -0,0 +1,179 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "ql/ir/ir.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/ir/cqasm/read.h"
+#include "ql/ir/cqasm/write.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/com/options.h"
+#include "ql/pmgr/manager.h"
+#include "ql/pmgr/pass_cache.h"
+
+namespace ql {
+namespace pmgr {
+
+/**
+ * A program with two blocks.
+ */
+static const utils::Str PROGRAM = R"(
+.first
+    x q[0]
+    cnot q[0], q[1]
+    h q[2]
+    cz q[1], q[2]
+.second
+    y q[3]
+    cnot q[3], q[4]
+    measure q[4]
+)";
+
+class PassCacheTest {
+protected:
+    PassCacheTest() {
+        ql::utils::logger::set_log_level("LOG_WARNING");
+        com::options::set("pass_cache", "yes");
+        PassCache::get().clear();
+    }
+
+    ~PassCacheTest() {
+        com::options::set("pass_cache", "no");
+        com::options::set("pass_cache_size", "1024");
+        PassCache::get().clear();
+    }
+
+    /**
+     * Reads the given cQASM program (without version and qubits statements),
+     * schedules it with the given pass options, and returns the cQASM
+     * representation of the result.
+     */
+    static utils::Str schedule(
+        const utils::Str &program,
+        const utils::Map<utils::Str, utils::Str> &options = {}
+    ) {
+        auto platform = ir::compat::Platform::build("none", utils::Str("none"));
+        auto ir = ir::convert_old_to_new(platform);
+        ir::cqasm::read(ir, "version 1.2\nqubits 10\n" + program);
+
+        Manager manager;
+        manager.append_pass("sch.ListSchedule", "scheduler", options);
+        manager.compile(ir);
+
+        ir::cqasm::WriteOptions write_options;
+        write_options.include_statistics = false;
+        write_options.include_timing = true;
+        return ir::cqasm::to_string(ir, ir->program.as<ir::Node>(), write_options);
+    }
+
+    static void check_stats(utils::UInt hits, utils::UInt misses, utils::UInt size) {
+        CHECK_EQ(PassCache::get().get_hits(), hits);
+        CHECK_EQ(PassCache::get().get_misses(), misses);
+        CHECK_EQ(PassCache::get().size(), size);
+    }
+
+};
+
+TEST_CASE_FIXTURE(PassCacheTest, "Miss followed by hit") {
+    auto first = schedule(PROGRAM);
+    check_stats(0, 2, 2);
+
+    // Scheduling the same program again restores both blocks from the cache,
+    // with the same result.
+    auto second = schedule(PROGRAM);
+    check_stats(2, 2, 2);
+    CHECK_EQ(first, second);
+
+    // The result must also be the same as without the cache.
+    com::options::set("pass_cache", "no");
+    CHECK_EQ(schedule(PROGRAM), first);
+    check_stats(2, 2, 2);
+}
+
+TEST_CASE_FIXTURE(PassCacheTest, "Changed block") {
+    schedule(PROGRAM);
+    check_stats(0, 2, 2);
+
+    // Only the changed block misses.
+    auto program = PROGRAM;
+    program.replace(program.find("y q[3]"), 6, "z q[3]");
+    schedule(program);
+    check_stats(1, 3, 3);
+}
+
+TEST_CASE_FIXTURE(PassCacheTest, "Option change invalidates") {
+    utils::Map<utils::Str, utils::Str> asap_options{{"scheduler_target", "asap"}};
+    utils::Map<utils::Str, utils::Str> alap_options{{"scheduler_target", "alap"}};
+
+    auto asap = schedule(PROGRAM, asap_options);
+    check_stats(0, 2, 2);
+
+    // Different pass options must not use the results for the old options.
+    auto alap = schedule(PROGRAM, alap_options);
+    check_stats(0, 4, 4);
+    CHECK_NE(asap, alap);
+
+    // The results for both options remain available.
+    CHECK_EQ(schedule(PROGRAM, asap_options), asap);
+    check_stats(2, 4, 4);
+    CHECK_EQ(schedule(PROGRAM, alap_options), alap);
+    check_stats(4, 4, 4);
+}
+
+TEST_CASE_FIXTURE(PassCacheTest, "Declarations are part of the key") {
+    auto with_int = PROGRAM;
+    with_int.replace(with_int.find(".first\n"), 7, ".first\n    var v: int\n");
+    auto with_bool = PROGRAM;
+    with_bool.replace(with_bool.find(".first\n"), 7, ".first\n    var v: bool\n");
+
+    schedule(with_int);
+    check_stats(0, 2, 2);
+
+    // The same blocks in a program that declares a variable with the same
+    // name but a different type must not hit.
+    schedule(with_bool);
+    check_stats(0, 4, 4);
+
+    schedule(with_int);
+    check_stats(2, 4, 4);
+}
+
+TEST_CASE_FIXTURE(PassCacheTest, "Key prefixes are interned") {
+    utils::Map<utils::Str, utils::Str> asap_options{{"scheduler_target", "asap"}};
+    utils::Map<utils::Str, utils::Str> alap_options{{"scheduler_target", "alap"}};
+
+    // All entries stored with the same pass options share a single prefix.
+    schedule(PROGRAM, asap_options);
+    schedule(PROGRAM, asap_options);
+    CHECK_EQ(PassCache::get().get_num_prefixes(), 1);
+    schedule(PROGRAM, alap_options);
+    CHECK_EQ(PassCache::get().get_num_prefixes(), 2);
+
+    // A prefix is forgotten when its last entry is evicted. Only the result
+    // for the first block of this program is already cached, so the ALAP
+    // entries for both versions of the second block remain.
+    auto program = PROGRAM;
+    program.replace(program.find("y q[3]"), 6, "z q[3]");
+    com::options::set("pass_cache_size", "2");
+    schedule(program, alap_options);
+    check_stats(3, 5, 2);
+    CHECK_EQ(PassCache::get().get_num_prefixes(), 1);
+
+    PassCache::get().clear();
+    CHECK_EQ(PassCache::get().get_num_prefixes(), 0);
+}
+
+TEST_CASE_FIXTURE(PassCacheTest, "Cache size limit") {
+    com::options::set("pass_cache_size", "3");
+    schedule(PROGRAM, {{"scheduler_target", "asap"}});
+    schedule(PROGRAM, {{"scheduler_target", "alap"}});
+    check_stats(0, 4, 3);
+    com::options::set("pass_cache_size", "1024");
+
+    // The oldest entry, for the first block with ASAP scheduling, has been
+    // evicted.
+    schedule(PROGRAM, {{"scheduler_target", "asap"}});
+    check_stats(1, 5, 4);
+}
+
+} // namespace pmgr
+} // namespace ql
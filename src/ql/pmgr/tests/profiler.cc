@@ -0,0 +1,118 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include <stdexcept>
+
+#include "ql/ir/ir.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/pmgr/manager.h"
+#include "ql/pmgr/profiler.h"
+#include "ql/pmgr/pass_types/specializations.h"
+
+namespace ql {
+namespace pmgr {
+
+/**
+ * Pass that always fails, either with an OpenQL exception or with a standard
+ * library exception.
+ */
+class FailingPass : public pass_types::Transformation {
+    static bool is_pass_registered;
+
+public:
+
+    FailingPass(
+        const utils::Ptr<const Factory> &pass_factory,
+        const utils::Str &instance_name,
+        const utils::Str &type_name
+    ) : pass_types::Transformation(pass_factory, instance_name, type_name) {
+        options.add_bool(
+            "std_exception",
+            "Whether to throw a standard library exception instead of an "
+            "OpenQL exception.",
+            false
+        );
+    }
+
+    utils::Str get_friendly_type() const override {
+        return "Failing pass";
+    }
+
+    utils::Int run(
+        const ir::Ref &ir,
+        const pass_types::Context &context
+    ) const override {
+        if (options["std_exception"].as_bool()) {
+            throw std::runtime_error("failing pass");
+        }
+        throw utils::Exception("failing pass");
+    }
+
+protected:
+
+    void dump_docs(
+        std::ostream &os,
+        const utils::Str &line_prefix
+    ) const override {
+        utils::dump_str(os, line_prefix, "Always fails.");
+    }
+
+};
+
+bool FailingPass::is_pass_registered = Factory::register_pass<FailingPass>("test.Fail");
+
+class ProfilerTest {
+protected:
+    ProfilerTest() {
+        ql::utils::logger::set_log_level("LOG_WARNING");
+        auto platform = ir::compat::Platform::build("none", utils::Str("none"));
+        ir = ir::convert_old_to_new(platform);
+        profiler.emplace();
+    }
+
+    /**
+     * Runs a group containing a failing pass with the profiler, and checks
+     * that the records of the group and the pass were both ended.
+     */
+    void run_failing(utils::Bool std_exception) {
+        Manager manager;
+        auto group = manager.append_pass("", "group");
+        group->append_sub_pass("test.Fail", "fail", {
+            {"std_exception", std_exception ? "yes" : "no"}
+        });
+        manager.construct();
+
+        CHECK_THROWS(manager.get_root()->compile(ir, "", profiler));
+
+        // The root group, the group, and the failing pass were profiled.
+        const auto &profiles = profiler->get_profiles();
+        REQUIRE_EQ(profiles.size(), 3);
+        CHECK_EQ(profiles[1].full_pass_name, "group");
+        CHECK_EQ(profiles[2].full_pass_name, "group.fail");
+        CHECK_EQ(profiles[2].depth, 2);
+        for (const auto &profile : profiles) {
+            CHECK_GE(profile.cpu_time, 0.0);
+        }
+
+        // No pass is still running, so a new pass starts at the root level,
+        // and ending it does not complain about the order.
+        auto handle = profiler->pass_start(ir, "next", "");
+        CHECK_EQ(profiler->get_profiles()[handle].depth, 0);
+        CHECK_NOTHROW(profiler->pass_end(handle, ir));
+    }
+
+    ir::Ref ir;
+    ProfilerRef profiler;
+};
+
+TEST_CASE_FIXTURE(ProfilerTest, "Pass throwing an OpenQL exception") {
+    run_failing(false);
+}
+
+TEST_CASE_FIXTURE(ProfilerTest, "Pass throwing another exception") {
+    run_failing(true);
+}
+
+} // namespace pmgr
+} // namespace ql
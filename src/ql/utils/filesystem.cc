@@ -209,9 +209,17 @@ void make_dirs(const Str &path) {
  * writing. If the directory that path is contained by does not exists, it is
  * first created.
  */
-OutFile::OutFile(const Str &path) : ofs(), path(path) {
+OutFile::OutFile(const Str &path, UInt buffer_size) : buffer(), ofs(), path(path) {
     auto processed_path = process_path(path);
 
+    // Install the custom buffer if requested. This must be done before the
+    // file is opened to have any effect on all standard library
+    // implementations.
+    if (buffer_size > 0) {
+        buffer.reset(new char[buffer_size]);
+        ofs.rdbuf()->pubsetbuf(buffer.get(), buffer_size);
+    }
+
     // If the parent path does not exist yet, recursively try to create a
     // directory for it.
     auto parent = dir_name(processed_path);
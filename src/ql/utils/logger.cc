@@ -3,17 +3,65 @@
  */
 
 #include "ql/utils/logger.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include "ql/utils/exception.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/ptr.h"
+#include "ql/utils/filesystem.h"
 
 namespace ql {
 namespace utils {
 namespace logger {
 
 /**
- * The current log level (verbosity).
+ * The process-wide log level (verbosity). This applies to all threads that
+ * don't have a thread-local override, see set_thread_log_level().
  */
 LogLevel log_level;
 
+/**
+ * The thread-local log level override, or NO_THREAD_LOG_LEVEL if none.
+ */
+static thread_local Int thread_log_level = NO_THREAD_LOG_LEVEL;
+
+/**
+ * Returns the log level that applies to the calling thread, i.e. its
+ * thread-local override if it has one, or the process-wide log level
+ * otherwise.
+ */
+LogLevel get_log_level() {
+    if (thread_log_level == NO_THREAD_LOG_LEVEL) {
+        return log_level;
+    }
+    return (LogLevel)thread_log_level;
+}
+
+/**
+ * Returns the thread-local log level override for the calling thread, or
+ * NO_THREAD_LOG_LEVEL if it has none.
+ */
+Int get_thread_log_level() {
+    return thread_log_level;
+}
+
+/**
+ * Sets the thread-local log level override for the calling thread. Passing
+ * NO_THREAD_LOG_LEVEL removes the override, such that the process-wide log
+ * level applies again. Threads spawned by parallel_for() inherit the override
+ * of the thread that calls it.
+ */
+void set_thread_log_level(Int level) {
+    thread_log_level = level;
+}
+
 /**
  * Converts the string representation of a log level to a LogLevel enum variant.
  * Throws ql::exception if the string could not be converted.
@@ -43,6 +91,503 @@ void set_log_level(const Str &level) {
     log_level = log_level_from_string(level);
 }
 
+/**
+ * Write buffer size used when logging to a file.
+ */
+static const UInt WRITE_BUFFER_SIZE = 1024 * 1024;
+
+/**
+ * Interval at which the background writer writes buffered messages, unless
+ * it is woken up earlier because a buffer is filling up.
+ */
+static const std::chrono::milliseconds WRITER_INTERVAL{10};
+
+/**
+ * A log message waiting to be written by the background writer.
+ */
+struct PendingMessage {
+
+    /**
+     * Process-wide sequence number, used to restore the order in which the
+     * messages of different threads were logged.
+     */
+    UInt sequence;
+
+    /**
+     * Whether the message goes to stderr when logging to the console.
+     */
+    Bool to_stderr;
+
+    /**
+     * The formatted message.
+     */
+    Str text;
+
+};
+
+/**
+ * Fixed-capacity ring buffer for the messages logged by a single thread while
+ * an asynchronous buffer policy is active. Only the owning thread adds to it
+ * and only the writer takes from it, so the mutex is rarely contended.
+ */
+struct ThreadBuffer {
+
+    /**
+     * Mutex protecting all of the below.
+     */
+    std::mutex mutex;
+
+    /**
+     * Notified by the writer when it has taken the messages out of the
+     * buffer.
+     */
+    std::condition_variable space_available;
+
+    /**
+     * The ring buffer storage, and the index and number of the pending
+     * messages in it.
+     */
+    Vec<PendingMessage> ring;
+    UInt head = 0;
+    UInt count = 0;
+
+    /**
+     * Number of messages dropped because the buffer was full.
+     */
+    UInt dropped = 0;
+
+    /**
+     * Set when the owning thread exits, such that the writer can forget about
+     * the buffer once it is empty.
+     */
+    Bool exited = false;
+
+    /**
+     * Constructs a buffer with room for the given number of messages.
+     */
+    explicit ThreadBuffer(UInt capacity) : ring(capacity) {}
+
+};
+
+/**
+ * Reference from a thread to its buffer. When the thread exits, the buffer is
+ * marked as such, but it is kept alive by the writer until its messages have
+ * been written.
+ */
+struct LocalBuffer {
+
+    /**
+     * The buffer of this thread, if it logged anything in asynchronous mode.
+     */
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    /**
+     * The generation of the backend configuration the buffer was created for.
+     */
+    UInt generation = 0;
+
+    /**
+     * Marks the buffer as belonging to an exited thread.
+     */
+    ~LocalBuffer() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->exited = true;
+        }
+    }
+
+};
+
+/**
+ * The buffer of the calling thread.
+ */
+static thread_local LocalBuffer local_buffer;
+
+/**
+ * The process-wide logging backend, managing the sink, the per-thread buffers,
+ * and the background writer.
+ */
+class Backend {
+private:
+
+    /**
+     * Mutex serializing writes to the sink and protecting file.
+     */
+    std::mutex sink_mutex;
+
+    /**
+     * The file that is logged to, or empty to log to stdout/stderr.
+     */
+    Ptr<OutFile> file;
+
+    /**
+     * Mutex serializing calls to drain(), such that messages taken out of the
+     * buffers by the writer and by flush() can't be written out of order.
+     */
+    std::mutex drain_mutex;
+
+    /**
+     * Mutex protecting the buffer list, the buffer size, and the writer thread
+     * state.
+     */
+    std::mutex state_mutex;
+
+    /**
+     * The current buffer policy.
+     */
+    std::atomic<BufferPolicy> policy{BufferPolicy::SYNCHRONOUS};
+
+    /**
+     * Incremented whenever the buffers are discarded due to a configuration
+     * change, such that threads know to allocate a new one.
+     */
+    std::atomic<UInt> generation{0};
+
+    /**
+     * Source of message sequence numbers.
+     */
+    std::atomic<UInt> sequence{0};
+
+    /**
+     * Capacity of newly created thread buffers.
+     */
+    UInt buffer_size = 0;
+
+    /**
+     * The buffers of all threads that logged in asynchronous mode.
+     */
+    Vec<std::shared_ptr<ThreadBuffer>> buffers;
+
+    /**
+     * The background writer thread, if running, and the flags used to
+     * control it.
+     */
+    std::thread writer;
+    std::condition_variable wake_writer;
+    Bool stop_requested = false;
+    Bool wake_requested = false;
+
+    /**
+     * Writes a single line to the sink. sink_mutex must be held.
+     */
+    void write_line(Bool to_stderr, const Str &text) {
+        if (file.has_value()) {
+            file->unwrap() << text << '\n';
+        } else if (to_stderr) {
+            std::cerr << text << '\n';
+        } else {
+            std::cout << text << '\n';
+        }
+    }
+
+    /**
+     * Flushes the sink. sink_mutex must be held.
+     */
+    void flush_sink() {
+        if (file.has_value()) {
+            file->unwrap().flush();
+        } else {
+            std::cout.flush();
+            std::cerr.flush();
+        }
+    }
+
+    /**
+     * Returns the buffer of the calling thread, creating it if needed.
+     */
+    const std::shared_ptr<ThreadBuffer> &get_thread_buffer() {
+        if (!local_buffer.buffer || local_buffer.generation != generation.load()) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            local_buffer.buffer = std::make_shared<ThreadBuffer>(buffer_size);
+            local_buffer.generation = generation.load();
+            buffers.push_back(local_buffer.buffer);
+        }
+        return local_buffer.buffer;
+    }
+
+    /**
+     * Wakes up the writer before its interval has elapsed.
+     */
+    void request_drain() {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            wake_requested = true;
+        }
+        wake_writer.notify_one();
+    }
+
+    /**
+     * Takes all pending messages out of the thread buffers and writes them to
+     * the sink in the order in which they were logged.
+     */
+    void drain() {
+        std::lock_guard<std::mutex> drain_lock(drain_mutex);
+
+        // Take the messages out of the buffers. The buffer list may change
+        // while we're doing this, so work on a copy.
+        Vec<std::shared_ptr<ThreadBuffer>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            snapshot = buffers;
+        }
+        Vec<PendingMessage> messages;
+        Vec<std::shared_ptr<ThreadBuffer>> exited;
+        UInt dropped = 0;
+        for (const auto &buffer : snapshot) {
+            {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                auto capacity = buffer->ring.size();
+                for (UInt i = 0; i < buffer->count; i++) {
+                    messages.push_back(std::move(buffer->ring[(buffer->head + i) % capacity]));
+                }
+                buffer->head = 0;
+                buffer->count = 0;
+                dropped += buffer->dropped;
+                buffer->dropped = 0;
+                if (buffer->exited) {
+                    exited.push_back(buffer);
+                }
+            }
+            buffer->space_available.notify_all();
+        }
+
+        // Forget about the buffers of threads that no longer exist.
+        if (!exited.empty()) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            for (const auto &buffer : exited) {
+                buffers.erase(std::remove(buffers.begin(), buffers.end(), buffer), buffers.end());
+            }
+        }
+
+        // Write the messages.
+        if (messages.empty() && !dropped) {
+            return;
+        }
+        std::sort(
+            messages.begin(), messages.end(),
+            [](const PendingMessage &a, const PendingMessage &b) {
+                return a.sequence < b.sequence;
+            }
+        );
+        std::lock_guard<std::mutex> lock(sink_mutex);
+        for (const auto &message : messages) {
+            write_line(message.to_stderr, message.text);
+        }
+        if (dropped) {
+            write_line(
+                true,
+                "[OPENQL] " + to_string(dropped) + " log message(s) dropped "
+                "because the log buffer was full"
+            );
+        }
+        flush_sink();
+    }
+
+    /**
+     * Main loop for the background writer thread.
+     */
+    void run_writer() {
+        std::unique_lock<std::mutex> lock(state_mutex);
+        while (!stop_requested) {
+            wake_writer.wait_for(lock, WRITER_INTERVAL, [this]() {
+                return stop_requested || wake_requested;
+            });
+            wake_requested = false;
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    /**
+     * Stops the background writer thread, if it is running.
+     */
+    void stop_writer() {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (!writer.joinable()) {
+                return;
+            }
+            stop_requested = true;
+        }
+        wake_writer.notify_one();
+        writer.join();
+        stop_requested = false;
+    }
+
+public:
+
+    /**
+     * Writes or buffers a message, depending on the buffer policy.
+     */
+    void write(Bool to_stderr, Str &&text) {
+        auto current_policy = policy.load();
+        if (current_policy == BufferPolicy::SYNCHRONOUS) {
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            write_line(to_stderr, text);
+
+            // Like the std::endl the console used to be written with, flush
+            // immediately, such that log output interleaves correctly with
+            // other output to the console. The log file stays buffered.
+            if (!file.has_value()) {
+                if (to_stderr) {
+                    std::cerr.flush();
+                } else {
+                    std::cout.flush();
+                }
+            }
+            return;
+        }
+
+        const auto &buffer = get_thread_buffer();
+        std::unique_lock<std::mutex> lock(buffer->mutex);
+        auto capacity = buffer->ring.size();
+        if (buffer->count == capacity) {
+            if (current_policy == BufferPolicy::DROP) {
+                buffer->dropped++;
+                return;
+            }
+            request_drain();
+            buffer->space_available.wait(lock, [&buffer, capacity]() {
+                return buffer->count < capacity;
+            });
+        }
+        auto &slot = buffer->ring[(buffer->head + buffer->count) % capacity];
+        slot.sequence = sequence++;
+        slot.to_stderr = to_stderr;
+        slot.text = std::move(text);
+        buffer->count++;
+
+        // Wake the writer early when the buffer is half full, to make
+        // blocking or dropping less likely.
+        if (buffer->count == (capacity + 1) / 2) {
+            lock.unlock();
+            request_drain();
+        }
+    }
+
+    /**
+     * Sets the file that is logged to, or restores logging to stdout/stderr
+     * if filename is empty.
+     */
+    void set_sink(const Str &filename) {
+        flush();
+
+        // Open the file before taking the lock, since opening it may log.
+        Ptr<OutFile> new_file;
+        if (!filename.empty()) {
+            new_file.emplace(filename, WRITE_BUFFER_SIZE);
+        }
+
+        std::lock_guard<std::mutex> lock(sink_mutex);
+        if (file.has_value()) {
+            file->close();
+        }
+        file = new_file;
+    }
+
+    /**
+     * Sets the buffer policy and per-thread buffer size.
+     */
+    void set_buffer_policy(BufferPolicy new_policy, UInt new_buffer_size) {
+        stop_writer();
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            buffers.clear();
+            buffer_size = new_buffer_size;
+            generation++;
+            policy = new_policy;
+            if (new_policy != BufferPolicy::SYNCHRONOUS) {
+                writer = std::thread(&Backend::run_writer, this);
+            }
+        }
+    }
+
+    /**
+     * Writes all pending messages and flushes the sink.
+     */
+    void flush() {
+        drain();
+        std::lock_guard<std::mutex> lock(sink_mutex);
+        flush_sink();
+    }
+
+    /**
+     * Stops the background writer and writes all pending messages. Messages
+     * logged afterwards are written synchronously.
+     */
+    void shutdown() {
+        stop_writer();
+        policy = BufferPolicy::SYNCHRONOUS;
+        flush();
+    }
+
+};
+
+static void shutdown_backend();
+
+/**
+ * Returns the process-wide logging backend. It is intentionally never
+ * destroyed, such that logging from static destructors remains safe; pending
+ * messages are written by an exit handler instead.
+ */
+static Backend &get_backend() {
+    static Backend *backend = []() {
+        auto b = new Backend();
+        std::atexit(shutdown_backend);
+        return b;
+    }();
+    return *backend;
+}
+
+/**
+ * Shuts down the backend when the process exits.
+ */
+static void shutdown_backend() {
+    get_backend().shutdown();
+}
+
+/**
+ * Writes a formatted log message (without trailing newline) to the sink. The
+ * level only selects the stream when logging to the console: errors and
+ * warnings go to stderr, everything else to stdout. This is normally only
+ * called via the QL_*OUT() macros.
+ */
+void write(LogLevel level, Str &&message) {
+    auto to_stderr = level == LogLevel::LOG_CRITICAL
+        || level == LogLevel::LOG_ERROR
+        || level == LogLevel::LOG_WARNING;
+    get_backend().write(to_stderr, std::move(message));
+}
+
+/**
+ * Sets the file that log messages are written to, or restores logging to
+ * stdout/stderr if filename is empty. Pending messages are written to the
+ * previous sink first.
+ */
+void set_sink(const Str &filename) {
+    get_backend().set_sink(filename);
+}
+
+/**
+ * Sets how messages are handed off to the sink, and the number of messages
+ * each thread can buffer for the asynchronous policies. Pending messages are
+ * written before the change takes effect. This should not be called while
+ * other threads are logging.
+ */
+void set_buffer_policy(BufferPolicy policy, UInt buffer_size) {
+    get_backend().set_buffer_policy(policy, buffer_size);
+}
+
+/**
+ * Writes all pending messages to the sink and flushes it. This is also done
+ * automatically when the process exits.
+ */
+void flush() {
+    get_backend().flush();
+}
+
 } // namespace logger
 } // namespace utils
 } // namespace ql
@@ -625,6 +625,31 @@ void Options::dump_options(bool only_set, std::ostream &os, const utils::Str &li
     }
 }
 
+/**
+ * The options record that is current for the calling thread, if any.
+ */
+static thread_local const Options *thread_current = nullptr;
+
+/**
+ * Returns the options record that was made current for the calling thread
+ * using set_thread_current(), or nullptr if there is none. This is used by
+ * com::options to select between the process-wide global options and a
+ * per-compilation options record.
+ */
+const Options *Options::get_thread_current() {
+    return thread_current;
+}
+
+/**
+ * Makes the given options record current for the calling thread, or clears it
+ * if nullptr is passed. Threads spawned by parallel_for() inherit the current
+ * record of the thread that calls it. The record must outlive its use as the
+ * current record.
+ */
+void Options::set_thread_current(const Options *options) {
+    thread_current = options;
+}
+
 /**
  * Stream write operator for Options.
  */
@@ -0,0 +1,107 @@
+/** \file
+ * Provides utilities for distributing independent work items over multiple
+ * threads.
+ */
+
+#include "ql/utils/parallel.h"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ql/utils/logger.h"
+#include "ql/utils/options.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Resolves a user-specified thread count to the number of threads that should
+ * actually be used. Zero is interpreted as the number of hardware threads
+ * supported by the system (or 1 if this cannot be determined).
+ */
+UInt get_num_threads(UInt requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    UInt hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+/**
+ * Calls fn(i) for every i in 0..count-1, distributing the calls over at most
+ * num_threads threads (where 0 means one thread per hardware thread, see
+ * get_num_threads()). The order in which the calls are made is undefined, so
+ * fn must only touch state that is either read-only or specific to index i.
+ * When num_threads resolves to 1 or count is less than 2, everything is done
+ * on the calling thread without spawning any threads.
+ *
+ * If any of the calls throws an exception, no new work items are started, and
+ * the first exception is rethrown on the calling thread once all threads have
+ * finished.
+ */
+void parallel_for(
+    UInt count,
+    UInt num_threads,
+    const std::function<void(UInt)> &fn
+) {
+    num_threads = min(get_num_threads(num_threads), count);
+    if (num_threads < 2) {
+        for (UInt i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    // Work items are handed out dynamically, because their cost is usually
+    // quite unbalanced.
+    std::atomic<UInt> next{0};
+    std::atomic<Bool> failed{false};
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+    auto worker = [&]() {
+        while (!failed.load()) {
+            UInt i = next.fetch_add(1);
+            if (i >= count) {
+                break;
+            }
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{exception_mutex};
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+                failed.store(true);
+            }
+        }
+    };
+
+    // The calling thread participates as well, so we only need to spawn
+    // num_threads - 1 additional threads. These inherit the thread-local
+    // context of the calling thread, i.e. the log level override and the
+    // current options record, such that the work done on them behaves the
+    // same as it would on the calling thread.
+    auto log_level = logger::get_thread_log_level();
+    auto options = Options::get_thread_current();
+    std::vector<std::thread> threads;
+    for (UInt i = 1; i < num_threads; i++) {
+        threads.emplace_back([&]() {
+            logger::set_thread_log_level(log_level);
+            Options::set_thread_current(options);
+            worker();
+        });
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+} // namespace utils
+} // namespace ql
@@ -0,0 +1,182 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "ql/utils/logger.h"
+#include "ql/utils/vec.h"
+
+namespace ql {
+namespace utils {
+namespace logger {
+
+/**
+ * The file the tests log to.
+ */
+static const Str LOG_FILE = "logger_test.log";
+
+class LoggerTest {
+protected:
+    LoggerTest() {
+        std::remove(LOG_FILE.c_str());
+    }
+
+    ~LoggerTest() {
+        set_buffer_policy(BufferPolicy::SYNCHRONOUS, 65536);
+        set_sink("");
+        std::remove(LOG_FILE.c_str());
+    }
+
+    /**
+     * Returns the lines of the log file.
+     */
+    static Vec<Str> read_log() {
+        Vec<Str> lines;
+        std::ifstream ifs(LOG_FILE);
+        Str line;
+        while (std::getline(ifs, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    /**
+     * If the given line is the report for dropped messages, returns the
+     * number of dropped messages it reports. Otherwise returns zero.
+     */
+    static UInt parse_dropped(const Str &line) {
+        static const Str PREFIX = "[OPENQL] ";
+        if (!starts_with(line, PREFIX) || line.find(" dropped ") == Str::npos) {
+            return 0;
+        }
+        auto end = line.find(' ', PREFIX.size());
+        return parse_uint(line.substr(PREFIX.size(), end - PREFIX.size()));
+    }
+
+};
+
+TEST_CASE_FIXTURE(LoggerTest, "Log file sink") {
+    set_sink(LOG_FILE);
+    write(LogLevel::LOG_INFO, "one");
+    write(LogLevel::LOG_ERROR, "two");
+    flush();
+    Vec<Str> expected{"one", "two"};
+    CHECK_EQ(read_log(), expected);
+
+    // After restoring logging to the console, the file is closed and no
+    // longer written to.
+    write(LogLevel::LOG_DEBUG, "three");
+    set_sink("");
+    write(LogLevel::LOG_DEBUG, "four");
+    expected.push_back("three");
+    CHECK_EQ(read_log(), expected);
+}
+
+TEST_CASE_FIXTURE(LoggerTest, "Block policy keeps all messages") {
+    static const UInt NUM_THREADS = 4;
+    static const UInt NUM_MESSAGES = 1000;
+
+    // With a tiny buffer, the threads must frequently wait for the writer.
+    set_sink(LOG_FILE);
+    set_buffer_policy(BufferPolicy::BLOCK, 4);
+    Vec<std::thread> threads;
+    for (UInt t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([t]() {
+            for (UInt i = 0; i < NUM_MESSAGES; i++) {
+                write(LogLevel::LOG_INFO, to_string(t) + " " + to_string(i));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    flush();
+
+    // Every message must be written exactly once, and the messages of each
+    // thread must appear in the order in which they were logged.
+    auto lines = read_log();
+    CHECK_EQ(lines.size(), NUM_THREADS * NUM_MESSAGES);
+    Vec<UInt> next(NUM_THREADS, 0);
+    for (const auto &line : lines) {
+        CHECK_EQ(parse_dropped(line), 0);
+        auto space = line.find(' ');
+        REQUIRE_NE(space, Str::npos);
+        auto t = parse_uint(line.substr(0, space));
+        REQUIRE_LT(t, NUM_THREADS);
+        CHECK_EQ(parse_uint(line.substr(space + 1)), next[t]);
+        next[t]++;
+    }
+}
+
+TEST_CASE_FIXTURE(LoggerTest, "Drop policy reports dropped messages") {
+    static const UInt NUM_MESSAGES = 10000;
+
+    // Whether and how many messages are dropped depends on timing, but every
+    // message must either be written or be counted as dropped.
+    set_sink(LOG_FILE);
+    set_buffer_policy(BufferPolicy::DROP, 2);
+    for (UInt i = 0; i < NUM_MESSAGES; i++) {
+        write(LogLevel::LOG_INFO, to_string(i));
+    }
+    flush();
+
+    UInt written = 0;
+    UInt dropped = 0;
+    Int previous = -1;
+    for (const auto &line : read_log()) {
+        auto count = parse_dropped(line);
+        if (count) {
+            dropped += count;
+            continue;
+        }
+        auto value = (Int)parse_uint(line);
+        CHECK_GT(value, previous);
+        previous = value;
+        written++;
+    }
+    CHECK_EQ(written + dropped, NUM_MESSAGES);
+}
+
+#ifndef _WIN32
+TEST_CASE_FIXTURE(LoggerTest, "Flush on exit") {
+    static const UInt NUM_MESSAGES = 100;
+
+    // Log in a child process that exits without flushing, so the pending
+    // messages can only be written by the exit handler.
+    flush();
+    std::fflush(nullptr);
+    auto pid = fork();
+    REQUIRE_GE(pid, 0);
+    if (pid == 0) {
+        set_sink(LOG_FILE);
+        set_buffer_policy(BufferPolicy::BLOCK, 2 * NUM_MESSAGES);
+        for (UInt i = 0; i < NUM_MESSAGES; i++) {
+            write(LogLevel::LOG_INFO, to_string(i));
+        }
+        std::exit(0);
+    }
+    int status = 0;
+    REQUIRE_EQ(waitpid(pid, &status, 0), pid);
+    CHECK(WIFEXITED(status));
+    CHECK_EQ(WEXITSTATUS(status), 0);
+
+    auto lines = read_log();
+    REQUIRE_EQ(lines.size(), NUM_MESSAGES);
+    for (UInt i = 0; i < NUM_MESSAGES; i++) {
+        CHECK_EQ(lines[i], to_string(i));
+    }
+}
+#endif
+
+} // namespace logger
+} // namespace utils
+} // namespace ql
@@ -12,19 +12,37 @@
 #include "ql/utils/vcd.h"
 
 #include <iostream>
+#include "ql/utils/logger.h"
 
 namespace ql {
 namespace utils {
 
+// write buffer size used when streaming to file
+static const UInt WRITE_BUFFER_SIZE = 1024 * 1024;
+
+std::ostream &Vcd::out() {
+    if (file.has_value()) {
+        return file->unwrap();
+    }
+    return vcd;
+}
+
+
 void Vcd::start() {
-    vcd << "$date today $end" << std::endl;
-    vcd << "$timescale 1 ns $end" << std::endl;
+    out() << "$date today $end\n";
+    out() << "$timescale 1 ns $end\n";
+}
+
+
+void Vcd::start(const Str &filename) {
+    file = Ptr<OutFile>::make(filename, WRITE_BUFFER_SIZE);
+    start();
 }
 
 
 void Vcd::scope(Scope type, const Str &name) {
     // FIXME: handle type
-    vcd << "$scope " << "module" << " " << name << " $end" << std::endl;
+    out() << "$scope " << "module" << " " << name << " $end\n";
 }
 
 
@@ -32,19 +50,24 @@ int Vcd::registerVar(const Str &name, VarType type, Scope scope) {
     // FIXME: incomplete
     const Int width = 20;
 
-    vcd << "$var string " << width << " " << lastId << " " << name << " $end" << std::endl;
+    out() << "$var string " << width << " " << lastId << " " << name << " $end\n";
 
     return lastId++;
 }
 
 
 void Vcd::upscope() {
-    vcd << "$upscope $end" << std::endl;
+    out() << "$upscope $end\n";
 }
 
 
 void Vcd::change(Int var, Int timestamp, const Str &value)
 {
+    if (flushed && timestamp < flushedTimestamp) {
+        QL_WOUT("VCD: ignoring change of var " << var << " at " << timestamp << ", which was already written");
+        return;
+    }
+
     auto tsIt = timestampMap.find(timestamp);
     if (tsIt != timestampMap.end()) {    // timestamp found
         VarChangeMap &vcm = tsIt->second;
@@ -89,14 +112,45 @@ void Vcd::change(Int var, Int timestamp, Int value) {
 }
 
 
-void Vcd::finish() {
-    vcd << "$enddefinitions $end" << std::endl;
+void Vcd::endDefinitions() {
+    if (!definitionsDone) {
+        out() << "$enddefinitions $end\n";
+        definitionsDone = true;
+    }
+}
+
+
+void Vcd::flush(Int timestamp) {
+    endDefinitions();
 
-    for (auto &t: timestampMap) {
-        vcd << "#" << t.first << std::endl;      // timestamp
-        for (auto &v: t.second) {
-            vcd << "s" << v.second.strVal << " " << v.first << std::endl;
+    // write the timestamp batches in order, NB: timestampMap is sorted
+    std::ostream &os = out();
+    while (!timestampMap.empty() && timestampMap.begin()->first < timestamp) {
+        Int ts = timestampMap.begin()->first;
+        os << '#' << ts << '\n';              // timestamp
+        for (auto &v: timestampMap.begin()->second) {
+            os << 's' << v.second.strVal << ' ' << v.first << '\n';
         }
+        timestampMap.erase(ts);
+    }
+    if (file.has_value()) {
+        file->check();
+    }
+
+    if (!flushed || timestamp > flushedTimestamp) {
+        flushedTimestamp = timestamp;
+        flushed = true;
+    }
+}
+
+
+void Vcd::finish() {
+    endDefinitions();
+
+    flush(MAX);
+    if (file.has_value()) {
+        file->close();
+        file.reset();
     }
 }
 
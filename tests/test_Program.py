@@ -64,6 +64,27 @@ class Test_program(unittest.TestCase):
             'compile']
         self.assertTrue(set(program_methods).issubset(dir(p)))
 
+    def test_interaction_matrix_csv(self):
+        nqubits = 3
+        k = ql.Kernel('im_kernel', platf, nqubits)
+        k.gate('cnot', [0, 1])
+        k.gate('cnot', [0, 1])
+        k.gate('cz', [2, 1])
+        k.gate('x', [0])
+        p = ql.Program('im_program', platf, nqubits)
+        p.add_kernel(k)
+
+        p.write_interaction_matrix('csv')
+        with open(os.path.join(output_dir, 'im_kernelInteractionMatrix.csv')) as f:
+            self.assertEqual(f.read(), (
+                'instruction,qubit0,qubit1,count\n'
+                'cnot,0,1,2\n'
+                'cz,1,2,1\n'
+            ))
+
+        with self.assertRaisesRegex(RuntimeError, 'unknown interaction matrix format'):
+            p.write_interaction_matrix('xml')
+
     def test_simple_program(self):
         nqubits = 2
         k = ql.Kernel("kernel1", platf, nqubits)
@@ -173,6 +173,12 @@ Indices start from 0 in both cases.
   * `with_timing` *
     Must be `yes` or `no`, default `yes`. Whether to include scheduling/timing
     information via bundle-and-skip notation.
+
+  * `num_threads` *
+    Must be an integer less than or equal to 0, default `1`. The number of threads
+    to use for formatting the blocks of the program. When not 1, consecutive blocks
+    are formatted concurrently and written in program order. 0 means one thread per
+    hardware thread.
 """.strip())
         self.assertEqual(p.dump_options(False).strip(), """
 output_prefix: %N.%P
@@ -185,6 +191,7 @@ with_statistics: no
 with_metadata: yes
 with_barriers: extended
 with_timing: yes
+num_threads: 1
 """.strip())
         self.assertEqual(p.dump_options(True).strip(), 'no options to dump')
         with self.assertRaisesRegex(RuntimeError, 'unknown option: does not exist'):
@@ -402,6 +409,94 @@ with_timing: yes
    |- no options to dump
 """.strip())
 
+    def test_parallel_kernels(self):
+        # Scheduling the kernels of a program concurrently must give the same
+        # result as scheduling them one by one.
+        platform = ql.Platform('parallel_kernels', os.path.join(curdir, 'test_cfg_none_s7.json'))
+        for num_threads in ('1', '4'):
+            p = ql.Program('parallel_kernels_' + num_threads, platform, 7, 0)
+            edges = [[2, 0], [0, 3], [3, 1], [1, 4], [2, 5], [5, 3], [3, 6], [6, 4]]
+            for i in range(8):
+                k = ql.Kernel('kernel_{}'.format(i), platform, 7, 0)
+                for j in range(7):
+                    k.gate('x', [j])
+                    k.gate('cnot', edges[(i + j) % len(edges)])
+                k.gate('measure', [i % 7])
+                p.add_kernel(k)
+
+            c = ql.Compiler()
+            c.append_pass('sch.Schedule', 'scheduler', {
+                'parallel_kernels': num_threads,
+                'scheduler_target': 'alap'
+            })
+            c.append_pass('io.cqasm.Report', 'writer', {
+                'output_prefix': os.path.join(output_dir, '%N')
+            })
+            c.compile(p)
+
+        self.assertTrue(file_compare(
+            os.path.join(output_dir, 'parallel_kernels_1.cq'),
+            os.path.join(output_dir, 'parallel_kernels_4.cq')
+        ))
+
+    def test_compile_batch(self):
+        # Compiling a batch of programs concurrently must give the same result
+        # as compiling them one by one.
+        platform = ql.Platform('compile_batch', os.path.join(curdir, 'test_cfg_none_s7.json'))
+        edges = [[2, 0], [0, 3], [3, 1], [1, 4], [2, 5], [5, 3], [3, 6], [6, 4]]
+
+        def make_program(name, seed):
+            p = ql.Program(name, platform, 7, 0)
+            for i in range(3):
+                k = ql.Kernel('kernel_{}'.format(i), platform, 7, 0)
+                for j in range(5):
+                    k.gate('x', [(seed + j) % 7])
+                    k.gate('cnot', edges[(seed + i + j) % len(edges)])
+                k.gate('measure', [(seed + i) % 7])
+                p.add_kernel(k)
+            return p
+
+        def make_compiler(output_prefix):
+            c = ql.Compiler()
+            c.append_pass('sch.Schedule', 'scheduler', {
+                'scheduler_target': 'alap'
+            })
+            c.append_pass('io.cqasm.Report', 'writer', {
+                'output_prefix': os.path.join(output_dir, output_prefix)
+            })
+            return c
+
+        c = make_compiler('%N')
+        for i in range(4):
+            c.compile(make_program('compile_batch_sequential_{}'.format(i), i))
+
+        c = make_compiler('%N')
+        c.compile_batch([
+            make_program('compile_batch_concurrent_{}'.format(i), i)
+            for i in range(4)
+        ], 4)
+
+        for i in range(4):
+            self.assertTrue(file_compare(
+                os.path.join(output_dir, 'compile_batch_sequential_{}.cq'.format(i)),
+                os.path.join(output_dir, 'compile_batch_concurrent_{}.cq'.format(i))
+            ))
+
+        # Programs that would write to the same output files are rejected.
+        c = make_compiler('compile_batch_fixed')
+        with self.assertRaisesRegex(RuntimeError, 'distinct files'):
+            c.compile_batch([
+                make_program('compile_batch_fixed_a', 0),
+                make_program('compile_batch_fixed_b', 1)
+            ])
+        c = make_compiler('%n')
+        with self.assertRaisesRegex(RuntimeError, 'distinct files'):
+            c.compile_batch([
+                make_program('compile_batch_same', 0),
+                make_program('compile_batch_same', 1)
+            ])
+
+
 
 if __name__ == '__main__':
     # ql.set_option('log_level', 'LOG_DEBUG')